@@ -0,0 +1,84 @@
+// ==========================================================================
+//
+// bench-arena.cpp
+//
+// a request that allocates 64 small objects and then frees them all,
+// with malloc / free, a std::pmr::monotonic_buffer_resource,
+// an arena (mark / rewind), and an arena through an arena_resource
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory_resource>
+#include "torsor-arena.hpp"
+#include "benchmark.hpp"
+
+const int requests = 10'000;
+const int objects = 64;
+
+// the sizes of the objects of a request: 16 .. 256 bytes
+std::size_t sizes[ objects ];
+
+int main(){
+   uint64_t random = 12345;
+   for( auto & s : sizes ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      s = 16 + ( random >> 33 ) % 241;
+   }
+   void * p[ objects ];
+   const long long n = (long long) requests * objects;
+
+   benchmark( "malloc, free", n, [ & ]{
+      for( int r = 0; r < requests; ++r ){
+         for( int i = 0; i < objects; ++i ){
+            p[ i ] = std::malloc( sizes[ i ] );
+            do_not_optimize( p[ i ] );
+         }
+         for( int i = 0; i < objects; ++i ){
+            std::free( p[ i ] );
+         }
+      }
+   } );
+
+   static char buffer[ 64 * 1024 ];
+   std::pmr::monotonic_buffer_resource monotonic( buffer, sizeof( buffer ) );
+   benchmark( "monotonic_buffer_resource, release", n, [ & ]{
+      for( int r = 0; r < requests; ++r ){
+         for( int i = 0; i < objects; ++i ){
+            do_not_optimize( monotonic.allocate( sizes[ i ], 8 ) );
+         }
+         monotonic.release();
+      }
+   } );
+
+   arena a( buffer, sizeof( buffer ) );
+   benchmark( "arena, mark, rewind", n, [ & ]{
+      for( int r = 0; r < requests; ++r ){
+         const arena_mark start = a.mark();
+         for( int i = 0; i < objects; ++i ){
+            do_not_optimize( a.allocate( sizes[ i ], 8 ) );
+         }
+         a.rewind( start );
+      }
+   } );
+
+   arena_resource resource( a );
+   std::pmr::memory_resource & m = resource;
+   benchmark( "arena_resource, mark, rewind", n, [ & ]{
+      for( int r = 0; r < requests; ++r ){
+         const arena_mark start = a.mark();
+         for( int i = 0; i < objects; ++i ){
+            do_not_optimize( m.allocate( sizes[ i ], 8 ) );
+         }
+         a.rewind( start );
+      }
+   } );
+}
@@ -0,0 +1,97 @@
+// ==========================================================================
+//
+// bench-bucket.cpp
+//
+// bucket index and bucket start of torsors by a fixed width,
+// with plain / and with a bucket_divider, for 64-bit and 32-bit moments
+//
+// The number of timestamps is the (optional) argument, by default 2^24:
+// they are passes over the same 2^20 timestamps.
+// ./bench-bucket.exe 1000000000 buckets 10^9 timestamps.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "torsor-bucket.hpp"
+#include "benchmark.hpp"
+
+struct ns_tag {};
+
+const std::size_t n = 1 << 20;
+
+// the floor of d / width with the division instruction
+template< typename D >
+D floor_divide( D d, D width ){
+   return d / width - ( d % width < 0 );
+}
+
+template< typename T >
+void run( const char * name, std::size_t passes, T width ){
+   using moment = torsor< T, ns_tag >;
+   using divider = bucket_divider< T, ns_tag >;
+   using index_type = typename divider::index_type;
+
+   std::vector< moment > in( n ), out( n );
+   std::vector< index_type > indices( n );
+   uint64_t random = 12345;
+   moment t;
+   for( auto & x : in ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      t += static_cast< T >( ( random >> 33 ) % 1000 );
+      x = t;
+   }
+   const moment origin = in[ n / 2 ];
+   const divider d( width, origin );
+   const long long total = (long long) ( passes * n );
+
+   std::cout << name << "\n";
+   benchmark( "   index, /", total, [ & ]{
+      for( std::size_t p = 0; p < passes; ++p ){
+         for( std::size_t i = 0; i < n; ++i ){
+            indices[ i ] = floor_divide< index_type >( in[ i ] - origin, width );
+         }
+      }
+      do_not_optimize( indices[ n / 2 ] );
+   } );
+   benchmark( "   index, bucket_divider", total, [ & ]{
+      for( std::size_t p = 0; p < passes; ++p ){
+         d.index( in.data(), indices.data(), n );
+      }
+      do_not_optimize( indices[ n / 2 ] );
+   } );
+   benchmark( "   floor, /", total, [ & ]{
+      for( std::size_t p = 0; p < passes; ++p ){
+         for( std::size_t i = 0; i < n; ++i ){
+            out[ i ] = origin + static_cast< T >( width
+               * floor_divide< index_type >( in[ i ] - origin, width ) );
+         }
+      }
+      do_not_optimize( out[ n / 2 ] );
+   } );
+   benchmark( "   floor, bucket_divider", total, [ & ]{
+      for( std::size_t p = 0; p < passes; ++p ){
+         d.floor( in.data(), out.data(), n );
+      }
+      do_not_optimize( out[ n / 2 ] );
+   } );
+}
+
+int main( int argc, char ** argv ){
+   const std::size_t total = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : ( 1 << 24 );
+   const std::size_t passes = ( total + n - 1 ) / n;
+
+   // the width is not a compile-time constant
+   volatile int64_t width = 60'000;
+   run< int64_t >( "torsor< int64_t >", passes, width );
+   run< int32_t >( "torsor< int32_t >", passes, (int32_t) width );
+}
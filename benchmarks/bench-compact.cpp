@@ -0,0 +1,72 @@
+// ==========================================================================
+//
+// bench-compact.cpp
+//
+// scanning full torsor< int64_t > timestamps versus 
+// epoch-relative 32-bit compact storage
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <vector>
+#include "torsor-compact.hpp"
+#include "benchmark.hpp"
+
+struct ns_tag {};
+using stamp = torsor< int64_t, ns_tag >;
+
+// large enough to not fit in the caches
+const long long n = 1 << 24;
+
+int main(){
+   const stamp epoch = stamp() + 1'700'000'000'000'000'000;
+   std::vector< stamp > full( n );
+   std::vector< int32_t > offsets( n );
+   std::vector< stamp > out( 4096 );
+   for( long long i = 0; i < n; ++i ){
+      full[ i ] = epoch + i * 100;
+   }
+   compact_torsors< int32_t, int64_t, ns_tag > compact( 
+      epoch, offsets.data(), n );
+   compact.set( full.data() );
+
+   std::cout 
+      << "full " << n * sizeof( stamp ) / ( 1 << 20 ) << " MB, "
+      << "compact " << n * sizeof( int32_t ) / ( 1 << 20 ) << " MB\n";
+
+   const stamp limit = epoch + n * 50;
+
+   benchmark( "count < limit, full", n, [ & ]{
+      long long count = 0;
+      for( auto t : full ){
+         count += ( t < limit );
+      }
+      do_not_optimize( count );
+   } );
+
+   benchmark( "count < limit, compact", n, [ & ]{
+      long long count = 0;
+      for( auto t : compact ){
+         count += ( t < limit );
+      }
+      do_not_optimize( count );
+   } );
+
+   benchmark( "widen", n, [ & ]{
+      for( long long i = 0; i < n; i += 4096 ){
+         widen( epoch, offsets.data() + i, out.data(), 4096 );
+         do_not_optimize( out[ 0 ] );
+      }
+   } );
+
+   benchmark( "narrow", n, [ & ]{
+      do_not_optimize( narrow( epoch, full.data(), offsets.data(), n ) );
+   } );
+}
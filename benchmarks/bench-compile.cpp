@@ -0,0 +1,69 @@
+// ==========================================================================
+//
+// bench-compile.cpp
+//
+// generates a translation unit with N tags, each used with three
+// base types, for measuring the compile-time cost of torsors:
+//
+//    bench-compile.exe N types > file.cpp
+//       only declares the torsors (the cost of the class instantiations)
+//
+//    bench-compile.exe N operators > file.cpp
+//       also uses all torsor operators on them
+//
+// make bench-compile compiles such files with -ftime-report
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+int main( int argc, char ** argv ){
+   const int n = ( argc > 1 ) ? std::atoi( argv[ 1 ] ) : 100;
+   const bool types = ( argc > 2 ) && ( std::strcmp( argv[ 2 ], "types" ) == 0 );
+
+   std::cout << "#include \"torsor.hpp\"\n\n";
+   for( int i = 0; i < n; ++i ){
+      if( types ){
+         std::cout 
+            << "struct tag_" << i << " {};\n"
+            << "torsor< int, tag_" << i << " > a_" << i << ";\n"
+            << "torsor< short, tag_" << i << " > s_" << i << ";\n"
+            << "torsor< double, tag_" << i << " > d_" << i << ";\n\n";
+         continue;
+      }
+      std::cout 
+         << "struct tag_" << i << " {};\n"
+         << "int f_" << i << "( int x ){\n"
+         << "   using ti = torsor< int, tag_" << i << " >;\n"
+         << "   using ts = torsor< short, tag_" << i << " >;\n"
+         << "   using td = torsor< double, tag_" << i << " >;\n"
+         << "   ti a, b;\n"
+         << "   ts s;\n"
+         << "   s = s + 1;\n"
+         << "   td d;\n"
+         << "   a += x;\n"
+         << "   a -= 1;\n"
+         << "   b = a + x;\n"
+         << "   b = x + b;\n"
+         << "   b = + b;\n"
+         << "   b = b - 2;\n"
+         << "   s = s - 1;\n"
+         << "   d += 0.5;\n"
+         << "   d = d + 1.5;\n"
+         << "   a = s;\n"
+         << "   const bool c = ( a == b ) || ( a != b ) || ( a < b ) "
+            "|| ( a <= b ) || ( a > b ) || ( a >= b ) || ( a < s ) "
+            "|| ( d < d );\n"
+         << "   return ( a - b ) + ( s - a ) + (int) ( d - d ) + c;\n"
+         << "}\n\n";
+   }
+}
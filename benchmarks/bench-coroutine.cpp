@@ -0,0 +1,94 @@
+// ==========================================================================
+//
+// bench-coroutine.cpp
+//
+// 1M concurrently sleeping coroutines on the coroutine_executor:
+// wakeup throughput, wakeup latency, and heap allocations
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "torsor-coroutine.hpp"
+#include "benchmark.hpp"
+
+// count the heap allocations
+long long allocations = 0;
+
+void * operator new( std::size_t n ){
+   ++allocations;
+   if( void * p = std::malloc( n ) ){
+      return p;
+   }
+   throw std::bad_alloc();
+}
+
+void operator delete( void * p ) noexcept { std::free( p ); }
+void operator delete( void * p, std::size_t ) noexcept { std::free( p ); }
+
+// the steady clock, but keep track of the time spent waiting
+struct clock_source : steady_clock_source {
+   static inline duration waited{ 0 };
+
+   static void wait( moment t ){
+      auto start = now();
+      steady_clock_source::wait( t );
+      waited += now() - start;
+   }
+};
+
+using executor = coroutine_executor< clock_source >;
+using task = coroutine_task< clock_source >;
+using std::chrono::nanoseconds;
+
+const int coroutines = 1'000'000;
+const int rounds = 3;
+
+nanoseconds total_latency{ 0 };
+nanoseconds max_latency{ 0 };
+
+task sleeper( uint32_t seed ){
+   for( int i = 0; i < rounds; ++i ){
+      seed = seed * 1664525 + 1013904223;
+      // deadlines on a 100 us grid within the next 2 s, 
+      // so many of them coincide
+      auto deadline = clock_source::now() 
+         + nanoseconds( ( seed >> 8 ) % 20'000 * 100'000 );
+      co_await sleep_until( deadline );
+      auto late = clock_source::now() - deadline;
+      total_latency += late;
+      if( late > max_latency ){
+         max_latency = late;
+      }
+   }
+}
+
+int main(){
+   executor e;
+   e.reserve( coroutines );
+   for( int i = 0; i < coroutines; ++i ){
+      e.spawn( sleeper( i ) );
+   }
+   auto before = allocations;
+   auto d = time_to_run( [ & ]{ e.run(); } );
+   auto n = e.resumes();
+   auto busy = d - clock_source::waited;
+
+   std::cout 
+      << coroutines << " coroutines, " << n << " wakeups in "
+      << d.count() / 1'000'000 << " ms, "
+      << busy.count() / 1'000'000 << " ms not waiting\n"
+      << "   " << n * 1e3 / busy.count() << " M wakeups/s, "
+      << e.wakeups() << " batches\n"
+      << "   latency mean " << total_latency.count() / n << " ns, "
+      << "max " << max_latency.count() / 1000 << " us\n"
+      << "   heap allocations during run(): " << allocations - before << "\n";
+}
@@ -0,0 +1,167 @@
+// ==========================================================================
+//
+// bench-deadline.cpp
+//
+// tail latency and deadline misses under overload:
+// earliest-deadline-first pool versus a FIFO pool
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "torsor-deadline.hpp"
+#include "benchmark.hpp"
+
+using clock_source = steady_clock_source;
+using stamp = clock_source::moment;
+using std::chrono::nanoseconds;
+using std::chrono::microseconds;
+
+// a minimal FIFO pool, for comparison
+class fifo_pool {
+   std::mutex lock;
+   std::condition_variable available, done;
+   std::deque< std::function< void() > > jobs;
+   long long pending = 0;
+   bool stopping = false;
+   std::vector< std::thread > threads;
+
+public:
+   fifo_pool( unsigned n ){
+      for( unsigned i = 0; i < n; ++i ){
+         threads.emplace_back( [ this ]{
+            for(;;){
+               std::function< void() > j;
+               {
+                  std::unique_lock< std::mutex > guard( lock );
+                  available.wait( guard, [ & ]{ 
+                     return stopping || ! jobs.empty(); } );
+                  if( jobs.empty() ){
+                     return;
+                  }
+                  j = std::move( jobs.front() );
+                  jobs.pop_front();
+               }
+               j();
+               std::lock_guard< std::mutex > guard( lock );
+               if( --pending == 0 ){
+                  done.notify_all();
+               }
+            }
+         } );
+      }
+   }
+
+   ~fifo_pool(){
+      {
+         std::lock_guard< std::mutex > guard( lock );
+         stopping = true;
+      }
+      available.notify_all();
+      for( auto & t : threads ){
+         t.join();
+      }
+   }
+
+   void submit( stamp, std::function< void() > j ){
+      {
+         std::lock_guard< std::mutex > guard( lock );
+         jobs.push_back( std::move( j ) );
+         ++pending;
+      }
+      available.notify_one();
+   }
+
+   void wait_idle(){
+      std::unique_lock< std::mutex > guard( lock );
+      done.wait( guard, [ & ]{ return pending == 0; } );
+   }
+};
+
+void spin( nanoseconds d ){
+   const stamp end = clock_source::now() + d;
+   while( clock_source::now() < end ){}
+}
+
+const unsigned workers = std::max( 1u, std::thread::hardware_concurrency() );
+const nanoseconds work = microseconds( 20 );
+const int jobs = 50'000;
+
+// submit jobs at 1.5 times the capacity, with a deadline 
+// of 0.2 to 5 ms after the submit,
+// report the response times of the jobs that were run,
+// and how many of them missed their deadline
+template< typename POOL >
+void run( const char * name, POOL & pool ){
+   std::vector< stamp > arrival( jobs ), deadline( jobs ), finish( jobs );
+   std::vector< char > ran( jobs, 0 );
+   const nanoseconds interval = work / workers * 2 / 3;
+   uint32_t seed = 1;
+   stamp next = clock_source::now();
+   for( int i = 0; i < jobs; ++i ){
+      next += interval;
+      while( clock_source::now() < next ){}
+      seed = seed * 1664525 + 1013904223;
+      arrival[ i ] = clock_source::now();
+      deadline[ i ] = arrival[ i ] + microseconds( 200 + ( seed >> 8 ) % 4'800 );
+      pool.submit( deadline[ i ], [ &, i ]{
+         spin( work );
+         finish[ i ] = clock_source::now();
+         ran[ i ] = 1;
+      } );
+   }
+   pool.wait_idle();
+
+   std::vector< nanoseconds > response;
+   int missed = 0;
+   for( int i = 0; i < jobs; ++i ){
+      if( ran[ i ] ){
+         response.push_back( finish[ i ] - arrival[ i ] );
+         missed += deadline[ i ] < finish[ i ];
+      }
+   }
+   std::sort( response.begin(), response.end() );
+   auto p = [ & ]( double f ){
+      return response.empty() ? 0 : (long long) response[ 
+         (std::size_t)( f * ( response.size() - 1 ) ) ].count() / 1000;
+   };
+   std::cout 
+      << std::left << std::setw( 12 ) << name << std::right
+      << " run " << std::setw( 6 ) << response.size()
+      << " missed " << std::setw( 6 ) << missed
+      << " p50 " << std::setw( 7 ) << p( 0.5 ) << " us"
+      << " p99 " << std::setw( 7 ) << p( 0.99 ) << " us"
+      << " max " << std::setw( 7 ) << p( 1.0 ) << " us\n";
+}
+
+int main(){
+   std::cout << workers << " workers, " << jobs << " jobs of " 
+      << work.count() / 1000 << " us at 1.5x capacity\n";
+   {
+      fifo_pool pool( workers );
+      run( "fifo", pool );
+   }
+   {
+      deadline_pool< clock_source > pool( workers, false );
+      run( "edf", pool );
+      auto s = pool.stats();
+      std::cout << "   mean lateness " 
+         << ( s.late ? s.total_lateness.count() / s.late / 1000 : 0 ) << " us\n";
+   }
+   {
+      deadline_pool< clock_source > pool( workers, true );
+      run( "edf + shed", pool );
+      auto s = pool.stats();
+      std::cout << "   shed " << s.shed << ", mean lateness " 
+         << ( s.late ? s.total_lateness.count() / s.late / 1000 : 0 ) << " us\n";
+   }
+}
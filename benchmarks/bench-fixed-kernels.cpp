@@ -0,0 +1,60 @@
+// ==========================================================================
+//
+// bench-fixed-kernels.cpp
+//
+// the kernels of bench-fixed, in a file of their own, so they can 
+// also be compiled (with -Os, for a small target) to check their size
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include "bench-fixed.hpp"
+
+void integrate_fixed( position * p, const meters * v, meters dt, int n ){
+   for( int i = 0; i < n; ++i ){
+      p[ i ] += v[ i ] * dt;
+   }
+}
+
+// the same rounding (to nearest) as the fixed multiplication
+void integrate_raw( raw_meters * p, const raw_meters * v, raw_meters dt, int n ){
+   for( int i = 0; i < n; ++i ){
+      p[ i ] += (raw_meters) ( ( (int64_t) v[ i ] * dt + ( 1 << 15 ) ) >> 16 );
+   }
+}
+
+void integrate_float( float_position * p, const float * v, float dt, int n ){
+   for( int i = 0; i < n; ++i ){
+      p[ i ] += v[ i ] * dt;
+   }
+}
+
+int count_fixed( const position * p, position limit, int n ){
+   int count = 0;
+   for( int i = 0; i < n; ++i ){
+      count += ( p[ i ] < limit );
+   }
+   return count;
+}
+
+int count_raw( const raw_meters * p, raw_meters limit, int n ){
+   int count = 0;
+   for( int i = 0; i < n; ++i ){
+      count += ( p[ i ] < limit );
+   }
+   return count;
+}
+
+int count_float( const float_position * p, float_position limit, int n ){
+   int count = 0;
+   for( int i = 0; i < n; ++i ){
+      count += ( p[ i ] < limit );
+   }
+   return count;
+}
@@ -0,0 +1,59 @@
+// ==========================================================================
+//
+// bench-fixed.cpp
+//
+// torsors of fixed-point values versus raw (hand-scaled) integers
+// and torsors of floats, on the host
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <vector>
+#include "bench-fixed.hpp"
+#include "benchmark.hpp"
+
+// the kernels are in bench-fixed-kernels.cpp, so they are not 
+// inlined into (and optimized for) this benchmark
+const int n = 1 << 12;
+
+int main(){
+   std::vector< position > p( n );
+   std::vector< meters > v( n );
+   std::vector< raw_meters > raw_p( n ), raw_v( n );
+   std::vector< float_position > float_p( n );
+   std::vector< float > float_v( n );
+   for( int i = 0; i < n; ++i ){
+      v[ i ] = meters( i % 100 ) / 7;
+      raw_v[ i ] = v[ i ].raw();
+      float_v[ i ] = (float) (double) v[ i ];
+   }
+   const meters dt( 0.001 );
+
+   benchmark( "integrate, fixed torsor", n, [ & ]{
+      integrate_fixed( p.data(), v.data(), dt, n );
+   } );
+   benchmark( "integrate, raw integer", n, [ & ]{
+      integrate_raw( raw_p.data(), raw_v.data(), dt.raw(), n );
+   } );
+   benchmark( "integrate, float torsor", n, [ & ]{
+      integrate_float( float_p.data(), float_v.data(), (float) (double) dt, n );
+   } );
+
+   const position limit = position() + meters( 1000 );
+   benchmark( "count < limit, fixed torsor", n, [ & ]{
+      do_not_optimize( count_fixed( p.data(), limit, n ) );
+   } );
+   benchmark( "count < limit, raw integer", n, [ & ]{
+      do_not_optimize( count_raw( raw_p.data(), ( limit - position() ).raw(), n ) );
+   } );
+   benchmark( "count < limit, float torsor", n, [ & ]{
+      do_not_optimize( count_float( 
+         float_p.data(), float_position() + 1000.0f, n ) );
+   } );
+}
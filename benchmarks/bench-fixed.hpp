@@ -0,0 +1,45 @@
+// ==========================================================================
+//
+// bench-fixed.hpp
+//
+// the kernels of bench-fixed: the same work on torsors of fixed-point 
+// values, on raw (hand-scaled) integers, and on torsors of floats
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef bench_fixed_hpp
+#define bench_fixed_hpp
+
+#include <cstdint>
+#include "torsor-fixed.hpp"
+
+struct position_tag {};
+
+// Q16.16 meters
+using meters = fixed< 16, 16 >;
+using position = torsor< meters, position_tag >;
+
+// the same, as a raw integer
+using raw_meters = int32_t;
+
+// float meters
+using float_position = torsor< float, position_tag >;
+
+// p[ i ] += v[ i ] * dt
+void integrate_fixed( position * p, const meters * v, meters dt, int n );
+void integrate_raw( raw_meters * p, const raw_meters * v, raw_meters dt, int n );
+void integrate_float( float_position * p, const float * v, float dt, int n );
+
+// the number of p[ i ] that are less than limit
+int count_fixed( const position * p, position limit, int n );
+int count_raw( const raw_meters * p, raw_meters limit, int n );
+int count_float( const float_position * p, float_position limit, int n );
+
+#endif // ifndef bench_fixed_hpp
@@ -0,0 +1,147 @@
+// ==========================================================================
+//
+// bench-gcra.cpp
+//
+// admits per second of a gcra_table (lock-free) and of token buckets
+// in a map guarded by (64 sharded) mutexes, for 1, 2 and 4 threads,
+// with 2^20 keys and with one hot key
+//
+// The number of requests per thread is the (optional) argument,
+// by default 2^20.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "torsor-gcra.hpp"
+#include "benchmark.hpp"
+
+struct ns_tag {};
+using stamp = torsor< std::int64_t, ns_tag >;
+
+// 1000 requests per second, bursts of 100
+const gcra_limit< std::int64_t > limit( 1'000'000, 100 );
+
+// a token bucket for each key, refilled when it is used
+class mutex_limiter {
+private:
+
+   struct bucket {
+      double tokens;
+      stamp last;
+   };
+
+   struct alignas( 64 ) shard {
+      std::mutex m;
+      std::unordered_map< std::uint64_t, bucket > buckets;
+   };
+
+   std::unique_ptr< shard[] > shards{ new shard[ 64 ] };
+
+public:
+
+   bool admit( std::uint64_t key, const stamp & now ){
+      shard & s = shards[ ( key * 0x9e37'79b9'7f4a'7c15ULL ) >> 58 ];
+      std::lock_guard< std::mutex > lock( s.m );
+      bucket & b = s.buckets.try_emplace( key, bucket{ 100.0, now } )
+         .first->second;
+      const double t = b.tokens + ( now - b.last ) * 1e-6;
+      b.tokens = ( t < 100.0 ) ? t : 100.0;
+      b.last = now;
+      if( b.tokens >= 1.0 ){
+         b.tokens -= 1.0;
+         return true;
+      }
+      return false;
+   }
+};
+
+// run f( thread, i ) for requests i in each of the threads
+template< typename F >
+void in_threads( int threads, std::size_t requests, F f ){
+   std::vector< std::thread > t;
+   for( int n = 0; n < threads; ++n ){
+      t.emplace_back( [ & f, n, requests ]{
+         std::size_t admitted = 0;
+         for( std::size_t i = 0; i < requests; ++i ){
+            admitted += f( n, i );
+         }
+         do_not_optimize( admitted );
+      } );
+   }
+   for( auto & x : t ){
+      x.join();
+   }
+}
+
+int main( int argc, char ** argv ){
+   const std::size_t requests = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : ( 1 << 20 );
+   const std::size_t n_keys = 1 << 20;
+
+   // a random key for each request, a new moment each 10 ns
+   std::vector< std::uint64_t > keys( requests );
+   uint64_t random = 12345;
+   for( auto & k : keys ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      k = ( random >> 20 ) % n_keys;
+   }
+   auto now = []( std::size_t i ){
+      return stamp() + std::int64_t( 1'000'000'000 + 10 * i );
+   };
+
+   for( int threads : { 1, 2, 4 } ){
+      const long long total = (long long) ( threads * requests );
+      std::cout << threads << " threads\n";
+
+      gcra_table< std::int64_t, ns_tag > table( limit, 2 * n_keys );
+      mutex_limiter mutexes;
+      benchmark( "   gcra_table, 2^20 keys", total, [ & ]{
+         in_threads( threads, requests, [ & ]( int, std::size_t i ){
+            return table.admit( keys[ i ], now( i ) );
+         } );
+      } );
+      benchmark( "   gcra_table batch, 2^20 keys", total, [ & ]{
+         std::vector< std::thread > t;
+         for( int n = 0; n < threads; ++n ){
+            t.emplace_back( [ & ]{
+               bool admitted[ 256 ];
+               for( std::size_t i = 0; i + 256 <= requests; i += 256 ){
+                  do_not_optimize( table.admit(
+                     keys.data() + i, admitted, 256, now( i ) ) );
+               }
+            } );
+         }
+         for( auto & x : t ){
+            x.join();
+         }
+      } );
+      benchmark( "   mutex token buckets, 2^20 keys", total, [ & ]{
+         in_threads( threads, requests, [ & ]( int, std::size_t i ){
+            return mutexes.admit( keys[ i ], now( i ) );
+         } );
+      } );
+      benchmark( "   gcra_table, one key", total, [ & ]{
+         in_threads( threads, requests, [ & ]( int, std::size_t i ){
+            return table.admit( 42, now( i ) );
+         } );
+      } );
+      benchmark( "   mutex token buckets, one key", total, [ & ]{
+         in_threads( threads, requests, [ & ]( int, std::size_t i ){
+            return mutexes.admit( 42, now( i ) );
+         } );
+      } );
+   }
+}
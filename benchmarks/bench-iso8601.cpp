@@ -0,0 +1,116 @@
+// ==========================================================================
+//
+// bench-iso8601.cpp
+//
+// bulk parsing and formatting of RFC 3339 date-times,
+// with the torsor-iso8601 functions and with the C library
+//
+// The number of date-times is the (optional) argument, by default 2^20.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string_view>
+#include <vector>
+#include "torsor-iso8601.hpp"
+#include "benchmark.hpp"
+
+struct utc_tag {};
+using utc = torsor< std::chrono::nanoseconds, utc_tag >;
+
+// the C library way: sscanf, timegm
+utc c_parse( std::string_view s ){
+   std::tm tm = {};
+   long fraction = 0;
+   std::sscanf( s.data(), "%4d-%2d-%2dT%2d:%2d:%2d.%9ldZ",
+      &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+      &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &fraction );
+   tm.tm_year -= 1900;
+   tm.tm_mon -= 1;
+   return utc() + std::chrono::nanoseconds(
+      timegm( &tm ) * 1'000'000'000LL + fraction );
+}
+
+// the C library way: gmtime_r, strftime, snprintf
+void c_format( utc t, char * s ){
+   const int64_t ns = ( t - utc() ).count();
+   const std::time_t seconds = ns / 1'000'000'000 - ( ns % 1'000'000'000 < 0 );
+   const long fraction = ns - seconds * 1'000'000'000LL;
+   std::tm tm;
+   gmtime_r( &seconds, &tm );
+   std::strftime( s, 20, "%Y-%m-%dT%H:%M:%S", &tm );
+   std::snprintf( s + 19, 12, ".%09ldZ", fraction );
+}
+
+int main( int argc, char ** argv ){
+   const std::size_t n = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : ( 1 << 20 );
+   const std::size_t length = iso8601_length( 9 );
+
+   // random moments between 1970 and 2100
+   std::vector< utc > in( n ), out( n );
+   uint64_t random = 12345;
+   for( auto & t : in ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      t = utc() + std::chrono::nanoseconds( random % 4'102'444'800'000'000'000 );
+   }
+
+   // fixed-width records, and a view of each
+   // (with one extra character: sscanf needs a terminating 0)
+   std::vector< char > text( n * length + 1, 0 ), c_text( n * ( length + 1 ) );
+   iso8601_format( in.data(), text.data(), n, 9 );
+   std::vector< std::string_view > views( n );
+   for( std::size_t i = 0; i < n; ++i ){
+      views[ i ] = std::string_view( text.data() + i * length, length );
+   }
+   std::vector< iso8601_error > errors( n );
+   std::vector< char > records( n * length + 1, 0 );
+   for( std::size_t i = 0; i < n; ++i ){
+      std::copy( text.data() + i * length, text.data() + ( i + 1 ) * length,
+         c_text.data() + i * ( length + 1 ) );
+   }
+
+   std::cout << "parse (" << length << " characters)\n";
+   benchmark( "   sscanf, timegm", (long long) n, [ & ]{
+      for( std::size_t i = 0; i < n; ++i ){
+         out[ i ] = c_parse( c_text.data() + i * ( length + 1 ) );
+      }
+      do_not_optimize( out[ n / 2 ] );
+   } );
+   std::size_t count = 0;
+   const auto parse = benchmark( "   iso8601_parse", (long long) n, [ & ]{
+      count += iso8601_parse( views.data(), out.data(), errors.data(), n );
+      do_not_optimize( out[ n / 2 ] );
+   } );
+   std::cout << "      " << length / parse << " GB/s\n";
+
+   std::cout << "format\n";
+   benchmark( "   gmtime_r, strftime, snprintf", (long long) n, [ & ]{
+      for( std::size_t i = 0; i < n; ++i ){
+         c_format( in[ i ], c_text.data() + i * ( length + 1 ) );
+      }
+      do_not_optimize( c_text[ n / 2 ] );
+   } );
+   const auto format = benchmark( "   iso8601_format", (long long) n, [ & ]{
+      iso8601_format( in.data(), records.data(), n, 9 );
+      do_not_optimize( records[ n / 2 ] );
+   } );
+   std::cout << "      " << length / format << " GB/s\n";
+
+   // all the same
+   if( count != 0 || out != in || records != text ){
+      std::cout << "mismatch!\n";
+   }
+}
@@ -0,0 +1,90 @@
+// ==========================================================================
+//
+// bench-join.cpp
+//
+// as-of join (backward and nearest, with one and with all threads)
+// against a binary search per left row, and the window join
+//
+// The number of rows of each column is the (optional) argument,
+// by default 10^7: ./bench-join.exe 100000000 joins 10^8 rows
+// (that needs about 4 GB).
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "torsor-join.hpp"
+#include "benchmark.hpp"
+
+struct tick_tag {};
+using tick = torsor< int64_t, tick_tag >;
+
+int main( int argc, char ** argv ){
+   const std::size_t n = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : 10'000'000;
+   const unsigned threads = std::max( 1u, std::thread::hardware_concurrency() );
+   std::cout << n << " rows, " << threads << " threads\n";
+
+   // two streams with on average 10 ticks between the rows
+   std::vector< tick > left( n ), right( n );
+   uint64_t random = 12345;
+   tick a, b;
+   for( std::size_t i = 0; i < n; ++i ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      a += (int64_t) ( ( random >> 33 ) % 20 );
+      b += (int64_t) ( ( random >> 45 ) % 20 );
+      left[ i ] = a;
+      right[ i ] = b;
+   }
+   std::vector< std::size_t > match( n );
+
+   benchmark( "binary search per row", n, [ & ]{
+      for( std::size_t i = 0; i < n; ++i ){
+         const auto j = std::upper_bound(
+            right.begin(), right.end(), left[ i ] ) - right.begin();
+         match[ i ] = ( j > 0 && left[ i ] - right[ j - 1 ] <= 15 )
+            ? j - 1 : join_none;
+      }
+      do_not_optimize( match[ n / 2 ] );
+   } );
+
+   benchmark( "asof_join backward", n, [ & ]{
+      asof_join( left.data(), n, right.data(), n, match.data(),
+         join_direction::backward, int64_t( 15 ) );
+      do_not_optimize( match[ n / 2 ] );
+   } );
+
+   benchmark( "asof_join nearest", n, [ & ]{
+      asof_join( left.data(), n, right.data(), n, match.data(),
+         join_direction::nearest, int64_t( 15 ) );
+      do_not_optimize( match[ n / 2 ] );
+   } );
+
+   benchmark( "asof_join backward, all threads", n, [ & ]{
+      asof_join( left.data(), n, right.data(), n, match.data(),
+         join_direction::backward, int64_t( 15 ), threads );
+      do_not_optimize( match[ n / 2 ] );
+   } );
+
+   // about 1.05 pairs per row
+   match.clear();
+   match.shrink_to_fit();
+   std::vector< join_pair > pairs;
+   pairs.reserve( n + n / 4 );
+   benchmark( "window_join [ -5, 5 ]", n, [ & ]{
+      pairs.clear();
+      window_join( left.data(), n, right.data(), n,
+         int64_t( 5 ), int64_t( 5 ), pairs );
+      do_not_optimize( pairs.back() );
+   } );
+}
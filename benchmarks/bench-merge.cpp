@@ -0,0 +1,104 @@
+// ==========================================================================
+//
+// bench-merge.cpp
+//
+// k-way merge of k sorted torsor streams, for k from 2 to 4096:
+// std::priority_queue against the loser tree, with one and with
+// all threads
+//
+// The total number of records is the (optional) argument,
+// by default 2^21.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "torsor-merge.hpp"
+#include "benchmark.hpp"
+
+struct tick_tag {};
+using tick = torsor< int64_t, tick_tag >;
+
+// merge with a binary heap of ( next key, stream ) pairs
+std::size_t heap_merge(
+   const std::vector< merge_range< tick > > & ranges, tick * out
+){
+   using entry = std::pair< tick, std::size_t >;
+   std::priority_queue< entry, std::vector< entry >, std::greater< entry > > q;
+   std::vector< const tick * > heads( ranges.size() );
+   for( std::size_t r = 0; r < ranges.size(); ++r ){
+      heads[ r ] = ranges[ r ].first;
+      if( heads[ r ] != ranges[ r ].last ){
+         q.push( entry( *heads[ r ], r ) );
+      }
+   }
+   std::size_t n = 0;
+   while( ! q.empty() ){
+      const std::size_t r = q.top().second;
+      out[ n++ ] = q.top().first;
+      q.pop();
+      if( ++heads[ r ] != ranges[ r ].last ){
+         q.push( entry( *heads[ r ], r ) );
+      }
+   }
+   return n;
+}
+
+int main( int argc, char ** argv ){
+   const std::size_t total = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : ( 1 << 21 );
+   const unsigned threads = std::max( 1u, std::thread::hardware_concurrency() );
+   std::cout << total << " records, " << threads << " threads\n";
+
+   std::vector< tick > out( total );
+   for( std::size_t k : { 2, 8, 32, 128, 512, 4096 } ){
+
+      // k streams with on average 10 * k ticks between their records
+      const std::size_t n = total / k;
+      std::vector< std::vector< tick > > streams( k );
+      std::vector< merge_range< tick > > ranges;
+      uint64_t random = 12345;
+      for( auto & s : streams ){
+         tick t;
+         for( std::size_t i = 0; i < n; ++i ){
+            random = random * 6'364'136'223'846'793'005
+               + 1'442'695'040'888'963'407;
+            t += (int64_t) ( ( random >> 33 ) % ( 20 * k ) );
+            s.push_back( t );
+         }
+         ranges.push_back( { s.data(), s.data() + s.size() } );
+      }
+      const long long records = (long long) ( n * k );
+      std::cout << "k = " << k << "\n";
+
+      benchmark( "   std::priority_queue", records, [ & ]{
+         do_not_optimize( heap_merge( ranges, out.data() ) );
+      } );
+      benchmark( "   loser tree", records, [ & ]{
+         do_not_optimize( merge_sorted( ranges.data(), k, out.data() ) );
+      } );
+      const std::string name =
+         "   loser tree, " + std::to_string( threads ) + " threads";
+      benchmark( name.c_str(), records, [ & ]{
+         do_not_optimize(
+            merge_sorted( ranges.data(), k, out.data(), threads ) );
+      } );
+      if( ! std::is_sorted( out.begin(), out.begin() + records ) ){
+         std::cout << "not sorted!\n";
+      }
+   }
+}
@@ -0,0 +1,113 @@
+// ==========================================================================
+//
+// bench-offset.cpp
+//
+// cold start of a hash map: using an offset_hash_map in place,
+// versus deserializing the key-value pairs into a std::unordered_map,
+// and the lookups in both
+//
+// mapped: the region is already in memory (as after mmap, but
+// without the page faults of the first accesses), and used in place.
+// read: the region is first copied (as by reading it from a file).
+// deserialized: the key-value pairs are inserted into a new map.
+//
+// The number of keys is the (optional) argument, by default 10^6.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include "torsor-offset.hpp"
+#include "benchmark.hpp"
+
+using map = offset_hash_map< std::int64_t, std::int64_t >;
+
+struct record {
+   std::int64_t key;
+   std::int64_t value;
+};
+
+int main( int argc, char ** argv ){
+   const std::size_t n = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : 1'000'000;
+
+   // the keys and values, as they would be serialized
+   std::vector< record > pairs( n );
+   uint64_t random = 12345;
+   for( std::size_t i = 0; i < n; ++i ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      pairs[ i ] = { (std::int64_t) ( random >> 1 ), (std::int64_t) i };
+   }
+
+   // the region image, as it would be stored in a file
+   const std::size_t bytes = 256 + 2 * n * 8 + n * 32;
+   std::vector< std::uint64_t > image( bytes / 8 ), mapped( bytes / 8 );
+   {
+      offset_region r = offset_region::create( image.data(), bytes );
+      map * h = r.make< map >( r, n );
+      for( const auto & kv : pairs ){
+         h->insert( r, kv.key, kv.value );
+      }
+      r.set_root( h );
+   }
+
+   // the mapped region is at another address
+   std::memcpy( mapped.data(), image.data(), bytes );
+   std::vector< char > serialized( n * sizeof( pairs[ 0 ] ) );
+   std::memcpy( serialized.data(), pairs.data(), serialized.size() );
+
+   std::cout << "load " << n << " keys\n";
+   benchmark( "   offset_hash_map, mapped", (long long) n, [ & ]{
+      offset_region r( mapped.data(), bytes );
+      const map * h = r.root< map >();
+      do_not_optimize( h->find( pairs[ 0 ].key ) );
+   } );
+   benchmark( "   offset_hash_map, read", (long long) n, [ & ]{
+      std::memcpy( mapped.data(), image.data(), bytes );
+      offset_region r( mapped.data(), bytes );
+      const map * h = r.root< map >();
+      do_not_optimize( h->find( pairs[ 0 ].key ) );
+   } );
+   benchmark( "   std::unordered_map, deserialized", (long long) n, [ & ]{
+      std::unordered_map< std::int64_t, std::int64_t > h;
+      h.reserve( n );
+      const char * p = serialized.data();
+      for( std::size_t i = 0; i < n; ++i ){
+         record kv;
+         std::memcpy( & kv, p + i * sizeof( kv ), sizeof( kv ) );
+         h.emplace( kv.key, kv.value );
+      }
+      do_not_optimize( h.find( pairs[ 0 ].key )->second );
+   } );
+
+   std::unordered_map< std::int64_t, std::int64_t > u;
+   for( const auto & kv : pairs ){
+      u.emplace( kv.key, kv.value );
+   }
+   const map & h = *offset_region( mapped.data(), bytes ).root< map >();
+   std::cout << "find\n";
+   benchmark( "   offset_hash_map", (long long) n, [ & ]{
+      std::int64_t sum = 0;
+      for( const auto & kv : pairs ){
+         sum += *h.find( kv.key );
+      }
+      do_not_optimize( sum );
+   } );
+   benchmark( "   std::unordered_map", (long long) n, [ & ]{
+      std::int64_t sum = 0;
+      for( const auto & kv : pairs ){
+         sum += u.find( kv.key )->second;
+      }
+      do_not_optimize( sum );
+   } );
+}
@@ -0,0 +1,114 @@
+// ==========================================================================
+//
+// bench-operators.cpp
+//
+// the torsor operators versus the same operations on raw base values,
+// meant to be build at different optimization levels (make bench-levels)
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "benchmark.hpp"
+
+struct ns_tag {};
+using stamp = torsor< int64_t, ns_tag >;
+
+// small enough to fit in the L1 cache: this measures the
+// instructions, not the memory
+const long long n = 1 << 12;
+
+// an element with value v: a raw int64_t or a stamp
+template< typename E >
+E element( int64_t v ){
+   if constexpr ( std::is_same_v< E, stamp > ){
+      return stamp() + v;
+   } else {
+      return v;
+   }
+}
+
+// the same loops, on raw values or on stamps
+template< typename E >
+struct kernels {
+   std::vector< E > in, out;
+   E limit;
+
+   kernels(): in( n ), out( n ), limit( element< E >( n * 5 ) ){
+      for( long long i = 0; i < n; ++i ){
+         in[ i ] = element< E >( i * 10 );
+      }
+   }
+
+   double add( const char * name ){
+      return benchmark( name, n, [ & ]{
+         for( long long i = 0; i < n; ++i ){
+            out[ i ] = in[ i ] + 100;
+         }
+         do_not_optimize( out[ n / 2 ] );
+      } );
+   }
+
+   double difference( const char * name ){
+      return benchmark( name, n, [ & ]{
+         int64_t sum = 0;
+         for( long long i = 1; i < n; ++i ){
+            sum += in[ i ] - in[ i - 1 ];
+         }
+         do_not_optimize( sum );
+      } );
+   }
+
+   double compare( const char * name ){
+      return benchmark( name, n, [ & ]{
+         long long count = 0;
+         for( long long i = 0; i < n; ++i ){
+            count += ( in[ i ] < limit );
+         }
+         do_not_optimize( count );
+      } );
+   }
+
+   double update( const char * name ){
+      return benchmark( name, n, [ & ]{
+         E t = in[ 0 ];
+         for( long long i = 0; i < n; ++i ){
+            t += 3;
+            out[ i ] = t;
+         }
+         do_not_optimize( out[ n / 2 ] );
+      } );
+   }
+};
+
+void ratio( const char * name, double raw, double torsor ){
+   std::cout
+      << "   " << name << " torsor / raw: " 
+      << std::fixed << std::setprecision( 2 ) << torsor / raw << "\n";
+}
+
+int main(){
+   kernels< int64_t > raw;
+   kernels< stamp > torsors;
+   double r;
+
+   r = raw.add( "raw    t + d" );
+   ratio( "t + d", r, torsors.add( "torsor t + d" ) );
+
+   r = raw.difference( "raw    t - t" );
+   ratio( "t - t", r, torsors.difference( "torsor t - t" ) );
+
+   r = raw.compare( "raw    t < limit" );
+   ratio( "t < limit", r, torsors.compare( "torsor t < limit" ) );
+
+   r = raw.update( "raw    t += d" );
+   ratio( "t += d", r, torsors.update( "torsor t += d" ) );
+}
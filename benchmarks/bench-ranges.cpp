@@ -0,0 +1,127 @@
+// ==========================================================================
+//
+// bench-ranges.cpp
+//
+// fused torsor range pipelines (torsor_views::deltas,
+// torsor_views::anchor, torsor_views::offset, torsor_views::bucket)
+// against the same work done by first materializing each step
+// in a vector
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <vector>
+#include "torsor-ranges.hpp"
+#include "benchmark.hpp"
+
+struct tick_tag {};
+using tick = torsor< int64_t, tick_tag >;
+
+const std::size_t n = 1 << 16;
+const int64_t width = 1000;
+const std::size_t buckets = 64;
+
+int main(){
+   std::vector< tick > ticks( n );
+   uint32_t random = 12345;
+   tick t;
+   for( auto & x : ticks ){
+      random = random * 1'103'515'245 + 12'345;
+      t += ( random >> 16 ) % 2000;
+      x = t;
+   }
+   const tick t0 = ticks[ 0 ];
+
+   // the sum of the intervals
+   benchmark( "deltas, materialized", n, [ & ]{
+      std::vector< int64_t > ds;
+      ds.reserve( n );
+      for( std::size_t i = 0; i + 1 < n; ++i ){
+         ds.push_back( ticks[ i + 1 ] - ticks[ i ] );
+      }
+      int64_t sum = 0;
+      for( auto d : ds ){
+         sum += d;
+      }
+      do_not_optimize( sum );
+   } );
+
+   benchmark( "deltas, fused", n, [ & ]{
+      int64_t sum = 0;
+      for( auto d : ticks | torsor_views::deltas ){
+         sum += d;
+      }
+      do_not_optimize( sum );
+   } );
+
+   // the intervals, clipped, and re-anchored
+   benchmark( "deltas -> anchor, materialized", n, [ & ]{
+      std::vector< int64_t > ds;
+      ds.reserve( n );
+      for( std::size_t i = 0; i + 1 < n; ++i ){
+         ds.push_back( std::min< int64_t >( ticks[ i + 1 ] - ticks[ i ], 1000 ) );
+      }
+      std::vector< tick > ts;
+      ts.reserve( n );
+      tick sum = t0;
+      for( auto d : ds ){
+         sum += d;
+         ts.push_back( sum );
+      }
+      int64_t check = 0;
+      for( auto x : ts ){
+         check += x - t0;
+      }
+      do_not_optimize( check );
+   } );
+
+   benchmark( "deltas -> anchor, fused", n, [ & ]{
+      int64_t check = 0;
+      for( auto x : ticks
+         | torsor_views::deltas
+         | std::views::transform(
+            []( int64_t d ){ return std::min< int64_t >( d, 1000 ); } )
+         | torsor_views::anchor( t0 )
+      ){
+         check += x - t0;
+      }
+      do_not_optimize( check );
+   } );
+
+   // a histogram of the shifted moments
+   benchmark( "offset -> bucket, materialized", n, [ & ]{
+      std::vector< tick > shifted;
+      shifted.reserve( n );
+      for( auto x : ticks ){
+         shifted.push_back( x + 500 );
+      }
+      std::vector< int64_t > indices;
+      indices.reserve( n );
+      for( auto x : shifted ){
+         indices.push_back( ( x - t0 ) / width );
+      }
+      unsigned int histogram[ buckets ] = {};
+      for( auto i : indices ){
+         ++histogram[ i % buckets ];
+      }
+      do_not_optimize( histogram[ 0 ] );
+   } );
+
+   benchmark( "offset -> bucket, fused", n, [ & ]{
+      unsigned int histogram[ buckets ] = {};
+      for( auto i : ticks
+         | torsor_views::offset( 500 )
+         | torsor_views::bucket( width, t0 )
+      ){
+         ++histogram[ i % buckets ];
+      }
+      do_not_optimize( histogram[ 0 ] );
+   } );
+}
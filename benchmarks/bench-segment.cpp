@@ -0,0 +1,93 @@
+// ==========================================================================
+//
+// bench-segment.cpp
+//
+// writing torsor-keyed records to memory-mapped segment files
+// (a segment_store on posix_segment_files) with several flush
+// policies, and range-scanning them in place
+//
+// The number of records can be passed as argument, the default
+// is 10^7 (10^9 needs ~12 GB of free disk space in /tmp).
+// This benchmark needs the POSIX file mapping.
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include "torsor-segment.hpp"
+#include "benchmark.hpp"
+
+struct ns_tag {};
+using stamp = torsor< int64_t, ns_tag >;
+using store = segment_store< int32_t, ns_tag, posix_segment_files >;
+
+const std::size_t capacity = 1 << 22;
+
+// write n records with the flush policy, the time per record
+double write( posix_segment_files & files, long long n, segment_flush_policy p ){
+   files.remove();
+   auto t = time_to_run( [ & ]{
+      store s( files, capacity, p );
+      for( long long i = 0; i < n; ++i ){
+         s.append( stamp() + i * 1'000, (int32_t) i );
+      }
+   } );
+   return (double) t.count() / n;
+}
+
+int main( int argc, char ** argv ){
+   const long long n = ( argc > 1 ) ? std::atoll( argv[ 1 ] ) : 10'000'000;
+   posix_segment_files files( "/tmp/torsor-segment-" );
+
+   // write, with a durable flush per segment, and more often
+   std::cout << "write + msync per segment               "
+      << write( files, n, segment_flush_policy{} ) << " ns\n";
+   std::cout << "write + msync per 2^16 records          "
+      << write( files, n, segment_flush_policy{ 1 << 16, 0 } ) << " ns\n";
+   std::cout << "write + msync per 10 ms of keys         "
+      << write( files, n, segment_flush_policy{ 0, 10'000'000 } ) << " ns\n";
+
+   // re-open (map) all segments for reading
+   std::size_t segments = 0;
+   auto open_all = time_to_run( [ & ]{
+      store s( files, capacity );
+      segments = s.segments();
+   } );
+   std::cout << "open (map) " << segments << " segments                "
+      << open_all.count() / 1000 << " us\n";
+   store s( files, capacity );
+
+   // scan the middle half, using the headers as sparse index
+   const stamp from = stamp() + n / 4 * 1'000;
+   const stamp to   = stamp() + 3 * n / 4 * 1'000;
+   benchmark( "range scan (sum payloads)", n / 2, [ & ]{
+      long long sum = 0;
+      s.scan( from, to, [ & ]( const stamp *, const int32_t * p, std::size_t k ){
+         for( std::size_t i = 0; i < k; ++i ){
+            sum += p[ i ];
+         }
+      } );
+      do_not_optimize( sum );
+   } );
+
+   benchmark( "point lookups (1000)", 1000, [ & ]{
+      long long found = 0;
+      for( long long i = 0; i < 1000; ++i ){
+         auto t = stamp() + ( i * 7919 % n ) * 1'000;
+         s.scan( t, t + 1, [ & ]( const stamp *, const int32_t *, std::size_t k ){
+            found += k;
+         } );
+      }
+      do_not_optimize( found );
+   } );
+
+   files.remove();
+}
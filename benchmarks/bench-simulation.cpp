@@ -0,0 +1,120 @@
+// ==========================================================================
+//
+// bench-simulation.cpp
+//
+// events per second of the simulator (a calendar queue) against
+// a simulator with a std::priority_queue, in the 'hold' model:
+// each event schedules one new event after a random delay,
+// with 10, 1000 and 10^5 pending events
+//
+// The number of events is the (optional) argument, by default 2^22.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+#include "torsor-simulation.hpp"
+#include "benchmark.hpp"
+
+struct tick_tag {};
+using sim = simulator< std::int64_t, tick_tag >;
+using stamp = sim::moment;
+
+// the same simulator, with a binary heap of events
+class heap_simulator {
+private:
+
+   struct event {
+      stamp at;
+      std::uint64_t sequence;
+      std::function< void() > work;
+      bool operator<( const event & e ) const {
+         return ( e.at < at ) || ( e.at == at && e.sequence < sequence );
+      }
+   };
+
+   std::priority_queue< event > events;
+   std::uint64_t sequence = 0;
+   stamp now_;
+
+public:
+
+   stamp now() const { return now_; }
+
+   template< typename F >
+   void schedule( std::int64_t d, F && work ){
+      events.push( event{ now_ + d, sequence++, std::forward< F >( work ) } );
+   }
+
+   std::uint64_t run(){
+      std::uint64_t n = 0;
+      while( ! events.empty() ){
+         std::function< void() > work = std::move(
+            const_cast< event & >( events.top() ).work );
+         now_ = events.top().at;
+         events.pop();
+         work();
+         ++n;
+      }
+      return n;
+   }
+};
+
+// the hold model on simulator S: n_pending events, each schedules
+// a next one after a random delay of 0 .. 999 ticks, until
+// n_events events have been scheduled
+template< typename S >
+struct hold {
+   S s;
+   std::uint64_t random = 12345;
+   std::size_t left;
+
+   std::int64_t delay(){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      return std::int64_t( ( random >> 33 ) % 1'000 );
+   }
+
+   // the action captures only a pointer, so (in the common
+   // std::function implementations) it is not allocated
+   void next(){
+      if( left > 0 ){
+         --left;
+         s.schedule( delay(), [ this ]{ next(); } );
+      }
+   }
+
+   hold( std::size_t n_pending, std::size_t n_events ): left( n_events ){
+      for( std::size_t i = 0; i < n_pending && left > 0; ++i ){
+         next();
+      }
+   }
+};
+
+int main( int argc, char ** argv ){
+   const std::size_t n = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : ( 1 << 22 );
+
+   for( std::size_t pending : { 10, 1'000, 100'000 } ){
+      std::cout << pending << " pending events\n";
+      benchmark( "   std::priority_queue", (long long) n, [ & ]{
+         hold< heap_simulator > h( pending, n );
+         do_not_optimize( h.s.run() );
+      } );
+      const double ns = benchmark( "   calendar queue", (long long) n, [ & ]{
+         hold< sim > h( pending, n );
+         do_not_optimize( h.s.run() );
+      } );
+      std::cout << "   " << 1'000.0 / ns << " M events / s\n";
+   }
+}
@@ -0,0 +1,119 @@
+// ==========================================================================
+//
+// bench-split.cpp
+//
+// the intervals between nanosecond timestamps since 1970, with
+// sub-nanosecond fractions, as torsor< double >, torsor< long double >,
+// split torsors, and float offset lanes: time and largest error
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "torsor-split.hpp"
+#include "benchmark.hpp"
+
+struct ns_tag {};
+using stamp = torsor< split< int64_t, float >, ns_tag >;
+
+const std::size_t n = 1 << 20;
+
+// the float offsets are kept below the limit (65 us) by
+// using an anchor for each chunk of 64 timestamps
+const std::size_t chunk = 64;
+
+const int64_t since_1970 = 1'700'000'000'000'000'000;
+
+// the exact interval: 256037 / 256 ns
+const double interval = 1000.14453125;
+
+template< typename T >
+double largest_error( const std::vector< T > & intervals ){
+   double e = 0.0;
+   for( const auto & x : intervals ){
+      e = std::fmax( e, std::fabs( (double) x - interval ) );
+   }
+   return e;
+}
+
+void error( double e ){
+   std::cout << "   largest error " << e << " ns\n";
+}
+
+int main(){
+   std::vector< torsor< double, ns_tag > > doubles( n );
+   std::vector< torsor< long double, ns_tag > > long_doubles( n );
+   std::vector< stamp > stamps( n );
+   for( std::size_t i = 0; i < n; ++i ){
+      const int64_t f = (int64_t) i * 256'037;
+      doubles[ i ] = torsor< double, ns_tag >()
+         + ( (double) since_1970 + i * interval );
+      long_doubles[ i ] = torsor< long double, ns_tag >()
+         + ( (long double) since_1970 + i * (long double) interval );
+      stamps[ i ] = stamp() + ( since_1970 + ( f >> 8 ) )
+         + ( f & 255 ) / 256.0f;
+   }
+
+   std::vector< double > d_out( n - 1 );
+   benchmark( "torsor< double >", n, [ & ]{
+      for( std::size_t i = 0; i + 1 < n; ++i ){
+         d_out[ i ] = doubles[ i + 1 ] - doubles[ i ];
+      }
+      do_not_optimize( d_out[ n / 2 ] );
+   } );
+   error( largest_error( d_out ) );
+
+   std::vector< long double > ld_out( n - 1 );
+   benchmark( "torsor< long double >", n, [ & ]{
+      for( std::size_t i = 0; i + 1 < n; ++i ){
+         ld_out[ i ] = long_doubles[ i + 1 ] - long_doubles[ i ];
+      }
+      do_not_optimize( ld_out[ n / 2 ] );
+   } );
+   error( largest_error( ld_out ) );
+
+   std::vector< float > f_out( n - 1 );
+   benchmark( "torsor< split< int64_t, float > >", n, [ & ]{
+      for( std::size_t i = 0; i + 1 < n; ++i ){
+         f_out[ i ] = (float) (double) ( stamps[ i + 1 ] - stamps[ i ] );
+      }
+      do_not_optimize( f_out[ n / 2 ] );
+   } );
+   error( largest_error( f_out ) );
+
+   // per chunk: narrow to float offsets, then the float deltas
+   std::vector< float > offsets( n ), lane_out( n );
+   const torsor< int64_t, ns_tag > zero;
+   auto anchor = [ & ]( std::size_t i ){
+      return zero + ( stamps[ i ] - stamp() ).anchor();
+   };
+   benchmark( "float lanes (narrow + deltas)", n, [ & ]{
+      for( std::size_t i = 0; i < n; i += chunk ){
+         split_narrow( anchor( i ), stamps.data() + i, offsets.data() + i, chunk );
+         split_deltas( offsets.data() + i, lane_out.data() + i, chunk );
+      }
+      do_not_optimize( lane_out[ n / 2 ] );
+   } );
+
+   benchmark( "float lanes (deltas only)", n, [ & ]{
+      for( std::size_t i = 0; i < n; i += chunk ){
+         split_deltas( offsets.data() + i, lane_out.data() + i, chunk );
+      }
+      do_not_optimize( lane_out[ n / 2 ] );
+   } );
+   std::vector< float > lanes;
+   for( std::size_t i = 0; i < n; ++i ){
+      if( ( i % chunk ) != chunk - 1 ){
+         lanes.push_back( lane_out[ i ] );
+      }
+   }
+   error( largest_error( lanes ) );
+}
@@ -0,0 +1,53 @@
+// ==========================================================================
+//
+// bench-storage.cpp
+//
+// array throughput of small-base-type torsors, with the default 
+// (widening) arithmetic and with storage preserving arithmetic
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <vector>
+#include "benchmark.hpp"
+
+struct widening {};
+struct preserving {};
+
+template<>
+constexpr bool torsor_preserves_storage< preserving > = true;
+
+const long long n = 1 << 22;
+
+// the result array has the element type that auto would give
+template< typename T, typename M >
+void run( const char * name ){
+   using t = torsor< T, M >;
+   using r = decltype( t() + 1 );
+   std::vector< t > in( n );
+   std::vector< r > out( n );
+   for( long long i = 0; i < n; ++i ){
+      in[ i ] += (T) i;
+   }
+   std::cout << name << ": result is " << sizeof( r ) << " bytes\n";
+   benchmark( "   t + 1", n, [ & ]{
+      for( long long i = 0; i < n; ++i ){
+         out[ i ] = in[ i ] + 1;
+      }
+      do_not_optimize( out[ n / 2 ] );
+   } );
+}
+
+int main(){
+   run< uint8_t,  widening   >( "uint8_t  widening"   );
+   run< uint8_t,  preserving >( "uint8_t  preserving" );
+   run< uint16_t, widening   >( "uint16_t widening"   );
+   run< uint16_t, preserving >( "uint16_t preserving" );
+}
@@ -0,0 +1,65 @@
+// ==========================================================================
+//
+// bench-sync.cpp
+//
+// mapping 10^8 device timestamps to host time:
+// one by one, in batches, and a plain copy for comparison
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "torsor-sync.hpp"
+#include "benchmark.hpp"
+
+struct device_tag {};
+struct host_tag {};
+using device = torsor< int64_t, device_tag >;
+using host = torsor< int64_t, host_tag >;
+
+// 10^8 stamps, converted in chunks that fit in the cache
+const std::size_t chunk = 1 << 16;
+const std::size_t chunks = 100'000'000 / chunk;
+const long long n = chunk * chunks;
+
+int main(){
+   std::vector< device > in( chunk );
+   std::vector< host > out( chunk );
+   for( std::size_t i = 0; i < chunk; ++i ){
+      in[ i ] = device() + ( 1'700'000'000'000'000'000 + i * 997 );
+   }
+   const clock_mapping< int64_t, device_tag, host_tag > m(
+      in[ 0 ], host() + 42, 37e-6 );
+
+   benchmark( "copy (no mapping)", n, [ & ]{
+      for( std::size_t c = 0; c < chunks; ++c ){
+         std::memcpy( (void*) out.data(), (void*) in.data(), 
+            chunk * sizeof( device ) );
+         clobber_memory();
+      }
+   } );
+
+   benchmark( "one by one", n, [ & ]{
+      for( std::size_t c = 0; c < chunks; ++c ){
+         for( std::size_t i = 0; i < chunk; ++i ){
+            out[ i ] = m( in[ i ] );
+         }
+         clobber_memory();
+      }
+   } );
+
+   benchmark( "convert()", n, [ & ]{
+      for( std::size_t c = 0; c < chunks; ++c ){
+         m.convert( in.data(), out.data(), chunk );
+         clobber_memory();
+      }
+   } );
+}
@@ -0,0 +1,115 @@
+// ==========================================================================
+//
+// bench-trace.cpp
+//
+// cost per trace event: the per-thread tracer versus
+// a single mutex-protected vector
+//
+// build with -DTORSOR_TRACE_DISABLED to see the cost when disabled
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "torsor-trace.hpp"
+#include "benchmark.hpp"
+
+const long long n = 20'000;
+
+using trace = tracer< steady_clock_source, 1 << 16 >;
+using event = trace::event;
+
+// the straightforward alternative: one shared, locked vector
+struct locked_recorder {
+   std::mutex lock;
+   std::vector< event > events;
+
+   void record( std::uint32_t name, event::kinds kind ){
+      const auto t = steady_clock_source::now();
+      std::lock_guard< std::mutex > guard( lock );
+      events.push_back( event{ t, name, 0, kind } );
+   }
+};
+
+int main(){
+   std::cout << "cost per event (each includes reading the clock)\n";
+
+   benchmark( "steady_clock_source::now()", n, [](){
+      for( long long i = 0; i < n; ++i ){
+         do_not_optimize( steady_clock_source::now() );
+      }
+   } );
+
+   const auto name = trace::id( "work" );
+   std::vector< event > events;
+   events.reserve( 2 * n );
+
+   // the collect is part of the timed work, to empty the buffer
+   benchmark( "tracer begin + end, collect", 2 * n, [ & ](){
+      for( long long i = 0; i < n; ++i ){
+         trace::begin( name );
+         trace::end( name );
+      }
+      events.clear();
+      trace::collect( events );
+      do_not_optimize( events.size() );
+   } );
+
+   locked_recorder locked;
+   locked.events.reserve( 2 * n );
+   benchmark( "locked vector begin + end", 2 * n, [ & ](){
+      for( long long i = 0; i < n; ++i ){
+         locked.record( name, event::kinds::begin );
+         locked.record( name, event::kinds::end );
+      }
+      locked.events.clear();
+      do_not_optimize( locked.events.size() );
+   } );
+
+   // contention: 4 threads that record concurrently
+   const int threads = 4;
+   benchmark( "tracer, 4 threads", 2 * n * threads, [ & ](){
+      std::vector< std::thread > t;
+      for( int j = 0; j < threads; ++j ){
+         t.emplace_back( [ & ]{
+            for( long long i = 0; i < n; ++i ){
+               trace::begin( name );
+               trace::end( name );
+            }
+         } );
+      }
+      for( auto & x : t ){
+         x.join();
+      }
+      events.clear();
+      trace::collect( events );
+      do_not_optimize( events.size() );
+   } );
+
+   benchmark( "locked vector, 4 threads", 2 * n * threads, [ & ](){
+      std::vector< std::thread > t;
+      for( int j = 0; j < threads; ++j ){
+         t.emplace_back( [ & ]{
+            for( long long i = 0; i < n; ++i ){
+               locked.record( name, event::kinds::begin );
+               locked.record( name, event::kinds::end );
+            }
+         } );
+      }
+      for( auto & x : t ){
+         x.join();
+      }
+      locked.events.clear();
+      do_not_optimize( locked.events.size() );
+   } );
+
+   std::cout << "dropped events: " << trace::dropped() << "\n";
+}
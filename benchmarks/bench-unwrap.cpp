@@ -0,0 +1,69 @@
+// ==========================================================================
+//
+// bench-unwrap.cpp
+//
+// extending 32-bit capture timestamps to 64-bit torsors:
+// one at a time, in a batch, and with the atomic unwrapper
+//
+// The number of timestamps is the (optional) argument, by default 2^24.
+// That is limited by the memory bandwidth (12 bytes per timestamp):
+// ./bench-unwrap.exe 16384 shows the speed for data in the cache.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "torsor-unwrap.hpp"
+#include "benchmark.hpp"
+
+struct tick_tag {};
+using stamp = torsor< std::int64_t, tick_tag >;
+
+int main( int argc, char ** argv ){
+   const std::size_t n = ( argc > 1 )
+      ? std::strtoull( argv[ 1 ], nullptr, 10 ) : ( 1 << 24 );
+
+   // captures with steps of 0 .. 1000 ticks: a wrap each ~ 8.6e6 captures
+   std::vector< std::uint32_t > in( n );
+   std::vector< stamp > out( n );
+   uint64_t random = 12345;
+   std::int64_t t = 0;
+   for( auto & x : in ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      t += ( random >> 33 ) % 1001;
+      x = static_cast< std::uint32_t >( t );
+   }
+
+   benchmark( "one at a time", (long long) n, [ & ]{
+      counter_unwrapper< std::uint32_t, tick_tag > u;
+      for( std::size_t i = 0; i < n; ++i ){
+         out[ i ] = u.update( in[ i ] );
+      }
+      do_not_optimize( out[ n / 2 ] );
+   } );
+   const double ns = benchmark( "batch", (long long) n, [ & ]{
+      counter_unwrapper< std::uint32_t, tick_tag > u;
+      u.update( in.data(), out.data(), n );
+      do_not_optimize( out[ n / 2 ] );
+   } );
+   std::cout << "   " << 1.0 / ns << " G timestamps / s\n";
+   benchmark( "atomic, one thread", (long long) n, [ & ]{
+      atomic_counter_unwrapper< std::uint32_t, tick_tag > u;
+      for( std::size_t i = 0; i < n; ++i ){
+         out[ i ] = u.update( in[ i ] );
+      }
+      do_not_optimize( out[ n / 2 ] );
+   } );
+
+   if( out[ n - 1 ] - stamp() != t ){
+      std::cout << "mismatch!\n";
+   }
+}
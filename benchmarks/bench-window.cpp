@@ -0,0 +1,56 @@
+// ==========================================================================
+//
+// bench-window.cpp
+//
+// sliding window event throughput, exact and bucketed
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <memory>
+#include "torsor-window.hpp"
+#include "benchmark.hpp"
+
+struct ns_tag {};
+using stamp = torsor< int64_t, ns_tag >;
+
+const long long n = 100'000'000;
+
+// an event every 10 ns, with pseudo-random values, 
+// over a window of 10 us (1000 events)
+int main(){
+   auto exact = std::make_unique< 
+      sliding_window< int32_t, 1024, int64_t, ns_tag > >( 10'000 );
+   double ns = benchmark( "exact add + count", n, [ & ]{
+      uint32_t v = 1;
+      long long c = 0;
+      for( long long i = 0; i < n; ++i ){
+         v = v * 1664525 + 1013904223;
+         exact->add( stamp() + i * 10, v >> 16 );
+         c += exact->count();
+      }
+      do_not_optimize( c );
+   } );
+   std::cout << "   " << 1'000 / ns << " M events/s\n";
+
+   auto bucketed = std::make_unique< 
+      bucketed_window< int32_t, 64, int64_t, ns_tag > >( 10'000 );
+   ns = benchmark( "bucketed add + count", n, [ & ]{
+      uint32_t v = 1;
+      long long c = 0;
+      for( long long i = 0; i < n; ++i ){
+         v = v * 1664525 + 1013904223;
+         bucketed->add( stamp() + i * 10, v >> 16 );
+         c += bucketed->count();
+      }
+      do_not_optimize( c );
+   } );
+   std::cout << "   " << 1'000 / ns << " M events/s\n";
+}
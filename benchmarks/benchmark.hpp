@@ -0,0 +1,118 @@
+// ==========================================================================
+//
+// benchmark.hpp
+//
+// timing support for the torsor benchmarks, on torsor-benchmark.hpp
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef benchmark_hpp
+#define benchmark_hpp
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include "torsor.hpp"
+#include "torsor-benchmark.hpp"
+
+
+// ==========================================================================
+//
+// time: moments are torsors of durations, like in the readme
+//
+// ==========================================================================
+
+using duration = std::chrono::nanoseconds;
+struct benchmark_clock_tag {};
+using moment = torsor< duration, benchmark_clock_tag >;
+
+moment now(){
+   static const auto epoch = std::chrono::steady_clock::now();
+   return moment() + std::chrono::duration_cast< duration >( 
+      std::chrono::steady_clock::now() - epoch );
+}
+
+template< typename F >
+duration time_to_run( F work ){
+   auto start = now();
+   work();
+   auto stop = now();
+   return stop - start;
+}
+
+
+// ==========================================================================
+//
+// the harness for the benchmarks, with settings that keep
+// the benchmarks short
+//
+// Before the first benchmark, the hints about the environment
+// are written.
+// When the environment variable TORSOR_BENCHMARK_CSV or 
+// TORSOR_BENCHMARK_JSON is set, the results are (also) written
+// to that file when the benchmark program ends.
+//
+// ==========================================================================
+
+struct benchmark_clock {
+   using duration = ::duration;
+   using moment = ::moment;
+   static moment now(){ return ::now(); }
+};
+
+struct benchmark_results {
+   benchmark_harness< benchmark_clock > harness{ { 
+      duration( 20'000'000 ), duration( 5'000'000 ), 11, 3.0 } };
+
+   benchmark_results(){
+      benchmark_hints( std::cout );
+   }
+
+   ~benchmark_results(){
+      if( const char * csv = std::getenv( "TORSOR_BENCHMARK_CSV" ) ){
+         std::ofstream f( csv );
+         harness.write_csv( f );
+      }
+      if( const char * json = std::getenv( "TORSOR_BENCHMARK_JSON" ) ){
+         std::ofstream f( json );
+         harness.write_json( f );
+      }
+   }
+};
+
+benchmark_results & benchmark_harness_instance(){
+   static benchmark_results r;
+   return r;
+}
+
+
+// ==========================================================================
+//
+// run work (which handles n elements), 
+// report the median time per element and its spread
+//
+// ==========================================================================
+
+template< typename F >
+double benchmark( const char * name, long long n, F work ){
+   const auto & r = benchmark_harness_instance().harness.run( name, n, work );
+   const double ns = r.ns_per_element();
+   const double spread = (double) r.statistics.stddev.count() / n;
+   std::cout 
+      << std::left << std::setw( 40 ) << name 
+      << std::right << std::fixed << std::setprecision( 3 )
+      << std::setw( 10 ) << ns << " ns"
+      << " +- " << std::setprecision( 3 ) << spread << "\n";
+   return ns;
+}
+
+#endif // ifndef benchmark_hpp
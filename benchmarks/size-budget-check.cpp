@@ -0,0 +1,106 @@
+// ==========================================================================
+//
+// size-budget-check.cpp
+//
+// reads the output of size -A for the object file of size-budget.cpp,
+// prints the .text and .rodata sizes of each torsor_xxx function and
+// its raw_xxx counterpart, and fails (exit code 1) when a torsor 
+// function is larger than its raw counterpart
+//
+//    size -A size-budget.o | size-budget-check.exe
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+
+// the sizes of a torsor function [ 0 ] and its raw counterpart [ 1 ]
+struct sizes {
+   unsigned long text[ 2 ] = { 0, 0 };
+   unsigned long rodata[ 2 ] = { 0, 0 };
+   bool found[ 2 ] = { false, false };
+};
+
+// the function of a section, and whether it is a raw one:
+// the first torsor_xxx or raw_xxx in the section name
+// (a .rodata name is mangled, so the function name is followed by 
+// something that is not a lower case letter or an underscore)
+bool function_of( const std::string & section, std::string & name, int & raw ){
+   const auto t = section.find( "torsor_" );
+   const auto r = section.find( "raw_" );
+   if( ( t == std::string::npos ) && ( r == std::string::npos ) ){
+      return false;
+   }
+   raw = ( r < t ) ? 1 : 0;
+   std::size_t i = raw ? r + 4 : t + 7;
+   name.clear();
+   while( ( i < section.size() )
+      && ( ( ( section[ i ] >= 'a' ) && ( section[ i ] <= 'z' ) ) 
+         || ( section[ i ] == '_' ) ) 
+   ){
+      name += section[ i++ ];
+   }
+   return true;
+}
+
+int main(){
+   std::map< std::string, sizes > functions;
+   std::string line;
+   while( std::getline( std::cin, line ) ){
+      std::istringstream s( line );
+      std::string section, name;
+      unsigned long size;
+      int raw;
+      if( !( s >> section >> size ) || !function_of( section, name, raw ) ){
+         continue;
+      }
+      auto & f = functions[ name ];
+      f.found[ raw ] = true;
+      if( section.rfind( ".text", 0 ) == 0 ){
+         f.text[ raw ] += size;
+      } else if( section.rfind( ".rodata", 0 ) == 0 ){
+         f.rodata[ raw ] += size;
+      }
+   }
+
+   std::cout 
+      << std::left << std::setw( 30 ) << "function" << std::right
+      << "  torsor .text .rodata     raw .text .rodata\n";
+   int failures = 0;
+   for( const auto & [ name, f ] : functions ){
+      std::cout 
+         << std::left << std::setw( 30 ) << name << std::right
+         << std::setw( 14 ) << f.text[ 0 ] << std::setw( 8 ) << f.rodata[ 0 ]
+         << std::setw( 14 ) << f.text[ 1 ] << std::setw( 8 ) << f.rodata[ 1 ];
+      if( !f.found[ 0 ] || !f.found[ 1 ] ){
+         std::cout << "   no counterpart";
+         ++failures;
+      } else if( f.text[ 0 ] + f.rodata[ 0 ] > f.text[ 1 ] + f.rodata[ 1 ] ){
+         std::cout << "   OVER BUDGET";
+         ++failures;
+      }
+      std::cout << "\n";
+   }
+
+   if( functions.empty() ){
+      std::cout << "no torsor_xxx or raw_xxx sections found\n";
+      return 1;
+   }
+   if( failures > 0 ){
+      std::cout << "\nSIZE BUDGET FAILURE: " << failures << " function(s)\n";
+      return 1;
+   }
+   std::cout << "\nSize budget success: " << functions.size() 
+      << " torsor function(s) are not larger than their raw counterparts\n";
+   return 0;
+}
@@ -0,0 +1,292 @@
+// ==========================================================================
+//
+// size-budget.cpp
+//
+// representative embedded uses of torsors (timers, locations,
+// ring indices), each next to the same code on raw integers,
+// for comparing their code size
+//
+// Each torsor_xxx function has a raw_xxx counterpart.
+// The functions are extern "C", so with -ffunction-sections and
+// -fdata-sections their code is in section .text.torsor_xxx
+// (or .text.raw_xxx), and their tables are in a .rodata section
+// that has the function name in it.
+// make size-budget compiles this file with -Os, and checks (with
+// size-budget-check.cpp) that no torsor_xxx is larger than raw_xxx.
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include "torsor.hpp"
+
+extern "C" {
+
+
+// ==========================================================================
+//
+// timers on a wrapping 32-bit tick counter
+//
+// ==========================================================================
+
+struct tick_tag {};
+using tick = torsor< uint32_t, tick_tag >;
+
+struct timer {
+   tick deadline;
+   uint32_t period;
+};
+
+struct raw_timer {
+   uint32_t deadline;
+   uint32_t period;
+};
+
+void torsor_timer_start( timer * t, tick now ){
+   t->deadline = now + t->period;
+}
+
+void raw_timer_start( raw_timer * t, uint32_t now ){
+   t->deadline = now + t->period;
+}
+
+bool torsor_timer_expired( const timer * t, tick now ){
+   return (int32_t) ( now - t->deadline ) >= 0;
+}
+
+bool raw_timer_expired( const raw_timer * t, uint32_t now ){
+   return (int32_t) ( now - t->deadline ) >= 0;
+}
+
+// the next period, without drift
+void torsor_timer_restart( timer * t ){
+   t->deadline += t->period;
+}
+
+void raw_timer_restart( raw_timer * t ){
+   t->deadline += t->period;
+}
+
+int32_t torsor_timer_remaining( const timer * t, tick now ){
+   return (int32_t) ( t->deadline - now );
+}
+
+int32_t raw_timer_remaining( const raw_timer * t, uint32_t now ){
+   return (int32_t) ( t->deadline - now );
+}
+
+// the index of the timer that expires first
+int torsor_timers_first( const timer * timers, int n, tick now ){
+   int first = 0;
+   for( int i = 1; i < n; ++i ){
+      if( (int32_t) ( timers[ i ].deadline - now )
+         < (int32_t) ( timers[ first ].deadline - now )
+      ){
+         first = i;
+      }
+   }
+   return first;
+}
+
+int raw_timers_first( const raw_timer * timers, int n, uint32_t now ){
+   int first = 0;
+   for( int i = 1; i < n; ++i ){
+      if( (int32_t) ( timers[ i ].deadline - now )
+         < (int32_t) ( timers[ first ].deadline - now )
+      ){
+         first = i;
+      }
+   }
+   return first;
+}
+
+// the moment of step i of a fixed schedule
+tick torsor_schedule_at( tick start, unsigned int i ){
+   static constexpr uint32_t offsets[] = { 0, 10, 25, 40, 100, 250, 400, 1000 };
+   return start + offsets[ i % 8 ];
+}
+
+uint32_t raw_schedule_at( uint32_t start, unsigned int i ){
+   static constexpr uint32_t offsets[] = { 0, 10, 25, 40, 100, 250, 400, 1000 };
+   return start + offsets[ i % 8 ];
+}
+
+
+// ==========================================================================
+//
+// locations on a 2D grid
+//
+// ==========================================================================
+
+struct x_tag {};
+struct y_tag {};
+
+struct location {
+   torsor< int32_t, x_tag > x;
+   torsor< int32_t, y_tag > y;
+};
+
+struct raw_location {
+   int32_t x;
+   int32_t y;
+};
+
+void torsor_location_move( location * p, int32_t dx, int32_t dy ){
+   p->x += dx;
+   p->y += dy;
+}
+
+void raw_location_move( raw_location * p, int32_t dx, int32_t dy ){
+   p->x += dx;
+   p->y += dy;
+}
+
+int64_t torsor_location_distance_squared(
+   const location * a, const location * b
+){
+   const int64_t dx = a->x - b->x;
+   const int64_t dy = a->y - b->y;
+   return dx * dx + dy * dy;
+}
+
+int64_t raw_location_distance_squared(
+   const raw_location * a, const raw_location * b
+){
+   const int64_t dx = a->x - b->x;
+   const int64_t dy = a->y - b->y;
+   return dx * dx + dy * dy;
+}
+
+bool torsor_location_inside(
+   const location * p, const location * low, const location * high
+){
+   return ( p->x >= low->x ) && ( p->x < high->x )
+      && ( p->y >= low->y ) && ( p->y < high->y );
+}
+
+bool raw_location_inside(
+   const raw_location * p, const raw_location * low, const raw_location * high
+){
+   return ( p->x >= low->x ) && ( p->x < high->x )
+      && ( p->y >= low->y ) && ( p->y < high->y );
+}
+
+// the center of n > 0 locations, relative to the first one
+void torsor_locations_center( const location * p, int n, location * center ){
+   int64_t sx = 0, sy = 0;
+   for( int i = 0; i < n; ++i ){
+      sx += p[ i ].x - p[ 0 ].x;
+      sy += p[ i ].y - p[ 0 ].y;
+   }
+   center->x = p[ 0 ].x + (int32_t) ( sx / n );
+   center->y = p[ 0 ].y + (int32_t) ( sy / n );
+}
+
+void raw_locations_center( const raw_location * p, int n, raw_location * center ){
+   int64_t sx = 0, sy = 0;
+   for( int i = 0; i < n; ++i ){
+      sx += p[ i ].x - p[ 0 ].x;
+      sy += p[ i ].y - p[ 0 ].y;
+   }
+   center->x = p[ 0 ].x + (int32_t) ( sx / n );
+   center->y = p[ 0 ].y + (int32_t) ( sy / n );
+}
+
+
+// ==========================================================================
+//
+// a ring buffer with wrapping 8-bit indices
+//
+// ==========================================================================
+
+} // extern "C"
+
+struct ring_tag {};
+
+template<>
+constexpr bool torsor_preserves_storage< ring_tag > = true;
+
+extern "C" {
+
+using ring_index = torsor< uint8_t, ring_tag >;
+
+struct ring {
+   ring_index head, tail;
+   uint8_t data[ 256 ];
+};
+
+// the index in the data array
+//
+// This is an unsigned int: when the (int) difference is first
+// stored in an uint8_t, GCC 12 -Os for x86-64 sign-extends it
+// for the indexing, which makes torsor_ring_push 6 bytes larger.
+static inline unsigned int ring_slot( ring_index i ){
+   return (unsigned int) ( i - ring_index() );
+}
+
+struct raw_ring {
+   uint8_t head, tail;
+   uint8_t data[ 256 ];
+};
+
+unsigned int torsor_ring_count( const ring * r ){
+   return (uint8_t) ( r->head - r->tail );
+}
+
+unsigned int raw_ring_count( const raw_ring * r ){
+   return (uint8_t) ( r->head - r->tail );
+}
+
+bool torsor_ring_push( ring * r, uint8_t v ){
+   if( (uint8_t) ( r->head - r->tail ) == 255 ){
+      return false;
+   }
+   r->data[ ring_slot( r->head ) ] = v;
+   r->head += 1;
+   return true;
+}
+
+bool raw_ring_push( raw_ring * r, uint8_t v ){
+   if( (uint8_t) ( r->head - r->tail ) == 255 ){
+      return false;
+   }
+   r->data[ r->head ] = v;
+   r->head += 1;
+   return true;
+}
+
+bool torsor_ring_pop( ring * r, uint8_t * v ){
+   if( r->head == r->tail ){
+      return false;
+   }
+   *v = r->data[ ring_slot( r->tail ) ];
+   r->tail += 1;
+   return true;
+}
+
+bool raw_ring_pop( raw_ring * r, uint8_t * v ){
+   if( r->head == r->tail ){
+      return false;
+   }
+   *v = r->data[ r->tail ];
+   r->tail += 1;
+   return true;
+}
+
+// the element that is age elements older than the newest one
+uint8_t torsor_ring_back( const ring * r, uint8_t age ){
+   return r->data[ ring_slot( r->head + ( - 1 - age ) ) ];
+}
+
+uint8_t raw_ring_back( const raw_ring * r, uint8_t age ){
+   const uint8_t i = (uint8_t) ( r->head - 1 - age );
+   return r->data[ i ];
+}
+
+} // extern "C"
@@ -0,0 +1,323 @@
+// ==========================================================================
+//
+// torsor-arena.hpp
+//
+// bump-pointer arena allocator, with torsor marks to rewind to,
+// a thread-local arena, and a std::pmr::memory_resource adapter
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_arena_hpp
+#define torsor_arena_hpp
+
+/// @file
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include "torsor.hpp"
+
+// An arena hands out memory by moving a cursor (bumping a pointer),
+// and frees it all at once by moving the cursor back. That suits
+// for instance a request handler that allocates many small objects,
+// and frees them all when the request is done:
+//
+//    arena a;
+//
+//    const arena_mark start = a.mark();
+//    auto p = a.make< item >( ... );
+//    ...
+//    std::size_t n = a.used() ...
+//    a.rewind( start );
+//
+// The position of the cursor is a torsor: an arena_mark is a byte
+// offset from the start of the arena, and the difference of two marks
+// is a size (the bytes allocated in between). A size can't be passed
+// to rewind(), and a mark can't be passed where a size is expected.
+//
+// The memory is a chain of blocks: the buffer passed to the
+// constructor (if any), and blocks allocated with operator new when
+// more memory is needed. The marks count through the blocks, as if
+// they were one, so the part of a block that was too small for an
+// allocation is counted as used. Rewinding keeps the blocks,
+// to be re-used: only the destructor (or release()) frees them.
+//
+// An arena only hands out memory: it doesn't run destructors.
+// Objects that need their destructor to be run must not be
+// allocated in an arena (or the destructor must be called explicitly).
+//
+// An arena is not thread safe. Each thread can use its own
+// thread_arena(). An arena_resource makes an arena a
+// std::pmr::memory_resource, for the std::pmr containers.
+
+
+// ==========================================================================
+//
+// marks
+//
+// ==========================================================================
+
+/// the tag of arena marks
+struct arena_tag {};
+
+/// a position in an arena
+using arena_mark = torsor< std::size_t, arena_tag >;
+
+
+// ==========================================================================
+//
+// arena
+//
+// ==========================================================================
+
+/// bump-pointer allocator, with marks to rewind to
+class arena final {
+private:
+
+   struct block {
+      block * previous;
+      block * next;
+      char * data;
+      std::size_t size;
+      arena_mark start;
+   };
+
+   // the buffer passed to the constructor (maybe an empty one)
+   block first;
+
+   // the current block, and the free part of it
+   block * current;
+   char * cursor;
+   char * end;
+
+   std::size_t block_size;
+
+   void enter( block * b ){
+      current = b;
+      cursor = b->data;
+      end = b->data + b->size;
+   }
+
+   // free the blocks after b
+   void free_after( block * b ){
+      block * n = b->next;
+      b->next = nullptr;
+      while( n != nullptr ){
+         block * next = n->next;
+         ::operator delete( n );
+         n = next;
+      }
+   }
+
+   // go to a next block that has room for bytes at alignment
+   void * allocate_in_next_block( std::size_t bytes, std::size_t alignment ){
+      const arena_mark start = current->start + current->size;
+      const std::size_t need = bytes + alignment;
+      if( ( current->next != nullptr ) && ( current->next->size < need ) ){
+         free_after( current );
+      }
+      if( current->next == nullptr ){
+         const std::size_t size = ( need > block_size ) ? need : block_size;
+         block * b = static_cast< block * >(
+            ::operator new( sizeof( block ) + size ) );
+         *b = block{ current, nullptr,
+            reinterpret_cast< char * >( b + 1 ), size, start };
+         current->next = b;
+      }
+      current->next->start = start;
+      enter( current->next );
+      return allocate( bytes, alignment );
+   }
+
+public:
+
+   /// an arena that allocates blocks of (at least) block_size bytes
+   explicit arena( std::size_t block_size = 64 * 1024 ):
+      arena( nullptr, 0, block_size )
+   {}
+
+   /// an arena that first uses the size bytes at buffer,
+   /// and then allocates blocks of (at least) block_size bytes
+   arena( void * buffer, std::size_t size, std::size_t block_size = 64 * 1024 ):
+      first{ nullptr, nullptr, static_cast< char * >( buffer ), size,
+         arena_mark() },
+      block_size( block_size )
+   {
+      // without a buffer, an allocation of 0 bytes still gets
+      // a (non-null) address
+      if( buffer == nullptr ){
+         first.data = reinterpret_cast< char * >( & first );
+         first.size = 0;
+      }
+      enter( & first );
+   }
+
+   arena( const arena & ) = delete;
+   arena & operator=( const arena & ) = delete;
+
+   ~arena(){
+      free_after( & first );
+   }
+
+   /// bytes of memory aligned to alignment (a power of 2)
+   void * allocate( std::size_t bytes,
+      std::size_t alignment = alignof( std::max_align_t )
+   ){
+      const std::uintptr_t c = reinterpret_cast< std::uintptr_t >( cursor );
+      char * p = cursor + ( ( alignment - ( c & ( alignment - 1 ) ) )
+         & ( alignment - 1 ) );
+      if( ( p <= end ) && ( bytes <= std::size_t( end - p ) ) ){
+         cursor = p + bytes;
+         return p;
+      }
+      return allocate_in_next_block( bytes, alignment );
+   }
+
+   /// a T constructed from args in the arena
+   template< typename T, typename... Args >
+   T * make( Args &&... args ){
+      return new( allocate( sizeof( T ), alignof( T ) ) )
+         T( std::forward< Args >( args )... );
+   }
+
+   /// an array of n default-initialized T's in the arena
+   template< typename T >
+   T * make_array( std::size_t n ){
+      T * p = static_cast< T * >( allocate( n * sizeof( T ), alignof( T ) ) );
+      for( std::size_t i = 0; i < n; ++i ){
+         new( p + i ) T;
+      }
+      return p;
+   }
+
+   /// the current position
+   arena_mark mark() const {
+      return current->start + std::size_t( cursor - current->data );
+   }
+
+   /// go back to the position m, which must be an earlier mark()
+   ///
+   /// All memory allocated after m is freed
+   /// (the blocks are kept, to be re-used).
+   void rewind( const arena_mark & m ){
+      while( m < current->start ){
+         current = current->previous;
+      }
+      enter( current );
+      cursor = current->data + ( m - current->start );
+   }
+
+   /// go back to the start
+   void reset(){
+      rewind( arena_mark() );
+   }
+
+   /// go back to the start, and free all allocated blocks
+   void release(){
+      reset();
+      free_after( & first );
+   }
+
+   /// the bytes used since the start
+   ///
+   /// This includes the padding for alignment, and the unused
+   /// ends of the blocks before the current one.
+   std::size_t used() const {
+      return mark() - arena_mark();
+   }
+
+}; // class arena
+
+
+// ==========================================================================
+//
+// scope
+//
+// ==========================================================================
+
+/// rewinds an arena (at the end of its lifetime)
+/// to its mark() at the start of its lifetime
+class arena_scope final {
+private:
+
+   arena & a;
+   arena_mark start;
+
+public:
+
+   /// rewind a at the end of the scope
+   explicit arena_scope( arena & a ): a( a ), start( a.mark() ){}
+
+   arena_scope( const arena_scope & ) = delete;
+   arena_scope & operator=( const arena_scope & ) = delete;
+
+   ~arena_scope(){
+      a.rewind( start );
+   }
+
+}; // class arena_scope
+
+
+// ==========================================================================
+//
+// thread-local arena
+//
+// ==========================================================================
+
+/// the arena of the calling thread
+///
+/// It is created on the first call in a thread,
+/// and destroyed (with its blocks) when the thread ends.
+inline arena & thread_arena(){
+   thread_local arena a;
+   return a;
+}
+
+
+// ==========================================================================
+//
+// std::pmr adapter
+//
+// ==========================================================================
+
+/// a std::pmr::memory_resource that allocates from an arena
+///
+/// Deallocation does nothing: the memory is freed
+/// by rewinding (or destroying) the arena.
+class arena_resource final : public std::pmr::memory_resource {
+private:
+
+   arena & a;
+
+   void * do_allocate( std::size_t bytes, std::size_t alignment ) override {
+      return a.allocate( bytes, alignment );
+   }
+
+   void do_deallocate( void *, std::size_t, std::size_t ) override {}
+
+   bool do_is_equal(
+      const std::pmr::memory_resource & other
+   ) const noexcept override {
+      return this == & other;
+   }
+
+public:
+
+   /// a resource that allocates from a
+   explicit arena_resource( arena & a ): a( a ){}
+
+   /// the arena
+   arena & get_arena() const { return a; }
+
+}; // class arena_resource
+
+#endif // ifndef torsor_arena_hpp
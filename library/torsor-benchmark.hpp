@@ -0,0 +1,488 @@
+// ==========================================================================
+//
+// torsor-benchmark.hpp
+//
+// statistical benchmark harness, with torsor moments and
+// base-type durations
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_benchmark_hpp
+#define torsor_benchmark_hpp
+
+/// @file
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "torsor.hpp"
+#include "torsor-clock.hpp"
+
+#if !( defined( __GNUC__ ) || defined( __clang__ ) ) && defined( _MSC_VER )
+   #include <intrin.h>
+#endif
+
+// This is the time_to_run() example of the readme, grown up:
+//
+// - the work is first run (untimed) for a warmup time
+// - the number of runs per sample is doubled until a sample
+//   takes at least the sample time, so short work is not
+//   dominated by the resolution and cost of C::now()
+// - a number of samples is taken, the samples that are more than
+//   outlier_limit (scaled) median absolute deviations from the
+//   median are rejected
+// - the median, mean, standard deviation, percentiles, min and max
+//   of the remaining samples are reported
+//
+// All timing is done with C::moment values (from a clock C,
+// see torsor-clock.hpp), all results are C::duration values
+// (the time of one run of the work).
+//
+// The results can be written as text, CSV or JSON,
+// for comparing runs.
+
+
+// ==========================================================================
+//
+// keep the optimizer from removing the benchmarked work
+//
+// GCC and clang get an empty asm statement that uses the value
+// and clobbers memory. Other compilers (MSVC has no inline asm
+// for x64) get the address of the value in a volatile sink,
+// followed by a compiler barrier: _ReadWriteBarrier() for MSVC,
+// std::atomic_signal_fence() for the rest.
+//
+// ==========================================================================
+
+///@cond INTERNAL
+
+#if !( defined( __GNUC__ ) || defined( __clang__ ) )
+
+// the address of the last value passed to do_not_optimize
+inline const void * volatile benchmark_sink = nullptr;
+
+// the compiler barrier
+inline void benchmark_barrier(){
+   #if defined( _MSC_VER )
+      _ReadWriteBarrier();
+   #else
+      std::atomic_signal_fence( std::memory_order_seq_cst );
+   #endif
+}
+
+#endif
+
+///@endcond
+
+/// make the optimizer assume that value is used
+template< typename T >
+void do_not_optimize( const T & value ){
+   #if defined( __GNUC__ ) || defined( __clang__ )
+      asm volatile( "" : : "r,m"( value ) : "memory" );
+   #else
+      benchmark_sink = std::addressof( value );
+      benchmark_barrier();
+   #endif
+}
+
+/// make the optimizer assume that all memory is read and written
+inline void clobber_memory(){
+   #if defined( __GNUC__ ) || defined( __clang__ )
+      asm volatile( "" : : : "memory" );
+   #else
+      benchmark_barrier();
+   #endif
+}
+
+
+// ==========================================================================
+//
+// statistics
+//
+// ==========================================================================
+
+/// the statistics of a set of samples
+template< typename D >
+struct benchmark_statistics {
+
+   /// the number of samples that were used
+   std::size_t samples;
+
+   /// the number of samples that were rejected as outliers
+   std::size_t outliers;
+
+   /// the smallest sample
+   D min;
+
+   /// the median sample
+   D median;
+
+   /// the mean of the samples
+   D mean;
+
+   /// the standard deviation of the samples
+   D stddev;
+
+   /// the 90th percentile
+   D p90;
+
+   /// the 99th percentile
+   D p99;
+
+   /// the largest sample
+   D max;
+};
+
+///@cond INTERNAL
+// s as the contents of a JSON string
+inline std::string benchmark_json_escaped( const std::string & s ){
+   static const char hex[] = "0123456789abcdef";
+   std::string r;
+   for( char c : s ){
+      const unsigned char u = (unsigned char) c;
+      if( ( c == '"' ) || ( c == '\\' ) ){
+         r += '\\';
+         r += c;
+      } else if( u < 0x20 ){
+         r += "\\u00";
+         r += hex[ u >> 4 ];
+         r += hex[ u & 0x0F ];
+      } else {
+         r += c;
+      }
+   }
+   return r;
+}
+
+// s as the contents of a CSV field (between double quotes)
+inline std::string benchmark_csv_escaped( const std::string & s ){
+   std::string r;
+   for( char c : s ){
+      if( c == '"' ){
+         r += '"';
+      }
+      r += c;
+   }
+   return r;
+}
+
+// p-th percentile (0..100) of sorted values, interpolated
+inline double benchmark_percentile( const std::vector< double > & sorted, double p ){
+   if( sorted.empty() ){
+      return 0.0;
+   }
+   const double rank = p / 100.0 * ( sorted.size() - 1 );
+   const std::size_t low = (std::size_t) rank;
+   const std::size_t high = std::min( low + 1, sorted.size() - 1 );
+   return sorted[ low ] + ( rank - low ) * ( sorted[ high ] - sorted[ low ] );
+}
+///@endcond
+
+/// the statistics of the samples
+///
+/// Samples that are more than outlier_limit times the
+/// (normal-scaled) median absolute deviation away from the median
+/// are rejected. An outlier_limit of 0 rejects nothing, and neither
+/// does a median absolute deviation of 0 (when more than half of
+/// the samples are equal to the median).
+/// For a D with a floating point rep the statistics are not rounded.
+template< typename D >
+benchmark_statistics< D > benchmark_summary(
+   const std::vector< D > & samples, double outlier_limit = 3.0
+){
+   std::vector< double > all;
+   for( const auto & s : samples ){
+      all.push_back( (double) s.count() );
+   }
+   std::sort( all.begin(), all.end() );
+   const double median = benchmark_percentile( all, 50.0 );
+
+   std::vector< double > kept = all;
+   if( outlier_limit > 0.0 ){
+      std::vector< double > deviations;
+      for( double v : all ){
+         deviations.push_back( std::fabs( v - median ) );
+      }
+      std::sort( deviations.begin(), deviations.end() );
+      const double mad = 1.4826 * benchmark_percentile( deviations, 50.0 );
+      if( mad > 0.0 ){
+         kept.clear();
+         for( double v : all ){
+            if( std::fabs( v - median ) <= outlier_limit * mad ){
+               kept.push_back( v );
+            }
+         }
+      }
+   }
+
+   double sum = 0.0;
+   for( double v : kept ){
+      sum += v;
+   }
+   const double mean = kept.empty() ? 0.0 : sum / kept.size();
+   double squares = 0.0;
+   for( double v : kept ){
+      squares += ( v - mean ) * ( v - mean );
+   }
+   const double stddev = ( kept.size() < 2 )
+      ? 0.0 : std::sqrt( squares / ( kept.size() - 1 ) );
+
+   auto d = []( double v ){
+      if constexpr ( std::is_floating_point_v< typename D::rep > ){
+         return D( v );
+      } else {
+         return D( (typename D::rep) std::llround( v ) );
+      }
+   };
+   return benchmark_statistics< D >{
+      kept.size(),
+      all.size() - kept.size(),
+      d( kept.empty() ? 0.0 : kept.front() ),
+      d( benchmark_percentile( kept, 50.0 ) ),
+      d( mean ),
+      d( stddev ),
+      d( benchmark_percentile( kept, 90.0 ) ),
+      d( benchmark_percentile( kept, 99.0 ) ),
+      d( kept.empty() ? 0.0 : kept.back() )
+   };
+}
+
+
+// ==========================================================================
+//
+// the harness
+//
+// ==========================================================================
+
+/// statistical benchmark harness
+//
+/// The harness is a template on a clock C (see torsor-clock.hpp).
+/// It times work with C::moment values, and reports C::duration
+/// values. For the CSV and JSON output, the duration of the
+/// clock must be a std::chrono::duration.
+template< typename C = steady_clock_source >
+class benchmark_harness final {
+public:
+
+   /// the moments of the clock
+   using moment = typename C::moment;
+
+   /// the durations of the clock
+   using duration = typename C::duration;
+
+   /// the time of one run: a duration of the clock,
+   /// with a floating point count
+   using run_duration = std::chrono::duration<
+      double, typename duration::period >;
+
+   /// the settings of the harness
+   struct options {
+
+      /// how long the work is run before it is timed
+      duration warmup;
+
+      /// the minimum time of a sample
+      duration sample_time;
+
+      /// the number of samples
+      unsigned samples;
+
+      /// the outlier limit, in median absolute deviations (0: none)
+      double outlier_limit;
+   };
+
+   /// the result of a benchmark
+   struct result {
+
+      /// the name of the benchmark
+      std::string name;
+
+      /// the number of elements handled by one run of the work
+      long long elements;
+
+      /// the number of runs of the work in each sample
+      std::uint64_t runs;
+
+      /// the statistics of the time of one run
+      ///
+      /// A sample is the time of runs runs, divided by runs as a
+      /// floating point value, so a run that takes less than the
+      /// resolution of the clock is not truncated.
+      benchmark_statistics< run_duration > statistics;
+
+      /// the median time per element, in nanoseconds
+      double ns_per_element() const {
+         return (double) std::chrono::duration_cast<
+            std::chrono::duration< double, std::nano > >(
+               statistics.median ).count() / elements;
+      }
+   };
+
+private:
+
+   options settings;
+   std::vector< result > all;
+
+   template< typename F >
+   static duration time_runs( F & work, std::uint64_t runs ){
+      const moment start = C::now();
+      for( std::uint64_t i = 0; i < runs; ++i ){
+         work();
+         clobber_memory();
+      }
+      return C::now() - start;
+   }
+
+   static double ns( const run_duration & d ){
+      return std::chrono::duration_cast<
+         std::chrono::duration< double, std::nano > >( d ).count();
+   }
+
+public:
+
+   /// create a harness with the specified settings
+   benchmark_harness( const options & settings ):
+      settings( settings )
+   {}
+
+   /// run work, which handles n elements, and return its result
+   ///
+   /// The result is also kept, for the write functions.
+   template< typename F >
+   const result & run( const std::string & name, long long n, F work ){
+
+      // warmup, which also finds the number of runs per sample
+      std::uint64_t runs = 1;
+      const moment warm = C::now() + settings.warmup;
+      for(;;){
+         const duration d = time_runs( work, runs );
+         if( ( d >= settings.sample_time ) && !( C::now() < warm ) ){
+            break;
+         }
+         if( d < settings.sample_time ){
+            runs *= 2;
+         }
+      }
+
+      std::vector< run_duration > samples;
+      for( unsigned i = 0; i < settings.samples; ++i ){
+         samples.push_back(
+            run_duration( time_runs( work, runs ) ) / (double) runs );
+      }
+
+      all.push_back( result{ name, n, runs,
+         benchmark_summary( samples, settings.outlier_limit ) } );
+      return all.back();
+   }
+
+   /// the results of all benchmarks run so far
+   const std::vector< result > & results() const { return all; }
+
+   /// write a result as one line of text, per element
+   static void write_text( std::ostream & s, const result & r ){
+      const auto & t = r.statistics;
+      const double n = (double) r.elements;
+      const auto flags = s.flags();
+      const auto precision = s.precision();
+      s.setf( std::ios::fixed, std::ios::floatfield );
+      s.precision( 3 );
+      s << r.name << ": "
+        << ns( t.median ) / n << " ns median, "
+        << ns( t.stddev ) / n << " stddev, "
+        << ns( t.p90 ) / n << " p90 ("
+        << t.samples << " samples of " << r.runs << " runs, "
+        << t.outliers << " outliers)\n";
+      s.flags( flags );
+      s.precision( precision );
+   }
+
+   /// write all results as CSV, times in ns per run
+   void write_csv( std::ostream & s ) const {
+      const auto precision = s.precision( 12 );
+      s << "name,elements,runs,samples,outliers,"
+           "min,median,mean,stddev,p90,p99,max,ns_per_element\n";
+      for( const auto & r : all ){
+         const auto & t = r.statistics;
+         s << '"' << benchmark_csv_escaped( r.name ) << "\","
+           << r.elements << ',' << r.runs << ','
+           << t.samples << ',' << t.outliers << ','
+           << ns( t.min ) << ',' << ns( t.median ) << ','
+           << ns( t.mean ) << ',' << ns( t.stddev ) << ','
+           << ns( t.p90 ) << ',' << ns( t.p99 ) << ','
+           << ns( t.max ) << ',' << r.ns_per_element() << '\n';
+      }
+      s.precision( precision );
+   }
+
+   /// write all results as JSON, times in ns per run
+   void write_json( std::ostream & s ) const {
+      const auto precision = s.precision( 12 );
+      s << "[";
+      const char * separator = "\n";
+      for( const auto & r : all ){
+         const auto & t = r.statistics;
+         s << separator
+           << "{\"name\":\"" << benchmark_json_escaped( r.name )
+           << "\",\"elements\":" << r.elements
+           << ",\"runs\":" << r.runs
+           << ",\"samples\":" << t.samples
+           << ",\"outliers\":" << t.outliers
+           << ",\"min\":" << ns( t.min )
+           << ",\"median\":" << ns( t.median )
+           << ",\"mean\":" << ns( t.mean )
+           << ",\"stddev\":" << ns( t.stddev )
+           << ",\"p90\":" << ns( t.p90 )
+           << ",\"p99\":" << ns( t.p99 )
+           << ",\"max\":" << ns( t.max )
+           << ",\"ns_per_element\":" << r.ns_per_element() << "}";
+         separator = ",\n";
+      }
+      s << "\n]\n";
+      s.precision( precision );
+   }
+
+}; // template class benchmark_harness
+
+
+// ==========================================================================
+//
+// hints
+//
+// ==========================================================================
+
+/// write hints about the environment that affect the benchmarks
+///
+/// This reports the number of cores and (on Linux) the CPU frequency
+/// governor, and suggests pinning the benchmark to one core.
+/// This library doesn't pin or change the governor itself.
+inline void benchmark_hints( std::ostream & s ){
+   s << "cores: " << std::thread::hardware_concurrency() << "\n";
+   std::ifstream governor(
+      "/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor" );
+   std::string g;
+   if( governor >> g ){
+      s << "cpu frequency governor: " << g << "\n";
+      if( g != "performance" ){
+         s << "   hint: use the performance governor for stable results\n";
+      }
+   }
+   s << "   hint: pin the benchmark to one core (for instance with taskset -c 1)\n";
+}
+
+#endif // ifndef torsor_benchmark_hpp
@@ -0,0 +1,228 @@
+// ==========================================================================
+//
+// torsor-bucket.hpp
+//
+// bucketing of integer torsors (bucket index, floor, ceil)
+// by a fixed width, with a precomputed multiply-shift divisor
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_bucket_hpp
+#define torsor_bucket_hpp
+
+/// @file
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include "torsor.hpp"
+
+// A group-by-time query maps each moment t to its bucket:
+// the index floor( ( t - origin ) / width ), or the start of
+// the bucket origin + index * width (which is a torsor again).
+// An integer division for each moment is slow (tens of cycles),
+// so a bucket_divider replaces it by a multiplication and a shift,
+// with a magic number that is computed once for the width
+// (like libdivide, or a compiler does for a constant divisor):
+//
+//    struct ns_tag {};
+//    using moment = torsor< int64_t, ns_tag >;
+//
+//    const bucket_divider< int64_t, ns_tag > minutes( 60'000'000'000, start );
+//    int64_t i = minutes.index( t );
+//    moment m = minutes.floor( t );
+//
+// The base type must be an integer of at most 64 bits. The
+// difference t - origin is handled as a signed value of 32 bits
+// (for base types of at most 32 bits) or 64 bits.
+// The index is the floor (towards minus infinity),
+// also for moments before the origin.
+// The width must be in 1 .. max_width, the largest value of the
+// index type that fits in the base type: for an unsigned base type
+// of 32 or 64 bits a wider width isn't a (positive) signed difference.
+//
+// For a signed difference d of N bits, the sign s (0 or -1) is
+// folded into the numerator u = d ^ s, which has at most N - 1 bits.
+// For such numerators the magic number m = ceil( 2^( N - 1 + l ) / w ),
+// with l = ceil( log2( w ) ), fits in N bits, and
+// floor( u / w ) = high_half( 2u * m ) >> l  (exact, for all w >= 1).
+// The floor of d / w is then that quotient ^ s.
+// So there are no branches, also not for powers of two.
+//
+// The batch functions are plain loops with such bodies.
+// For 32-bit differences the multiplication is a 32 x 32 -> 64 bit one,
+// for which SIMD instructions exist, so the compiler can vectorize
+// those loops. For 64-bit differences the high half of a 64 x 64 bit
+// product is needed, for which (on x86-64, even with AVX-512)
+// there is no SIMD instruction: those loops stay scalar,
+// but still without a division.
+
+
+// ==========================================================================
+//
+// bucket divider
+//
+// ==========================================================================
+
+/// bucketing of torsor< T, M > moments by a fixed width
+template< typename T, typename M = void >
+class bucket_divider final {
+public:
+
+   static_assert( std::is_integral_v< T > && sizeof( T ) <= 8,
+      "the base type of a bucket_divider must be an integer "
+      "of at most 64 bits" );
+
+   /// the moments
+   using moment = torsor< T, M >;
+
+   /// the (signed) bucket index
+   using index_type = std::conditional_t<
+      ( sizeof( T ) <= 4 ), std::int32_t, std::int64_t >;
+
+   /// the largest width
+   static constexpr T max_width =
+      ( std::uintmax_t( std::numeric_limits< T >::max() )
+         < std::uintmax_t( std::numeric_limits< index_type >::max() ) )
+      ? std::numeric_limits< T >::max()
+      : static_cast< T >( std::numeric_limits< index_type >::max() );
+
+private:
+
+   using U = std::make_unsigned_t< index_type >;
+   static constexpr int bits = 8 * sizeof( U );
+
+   moment origin_;
+   T width_;
+   U magic;
+   int shift;
+
+   // the high half of a * b
+   static constexpr U high_half( U a, U b ){
+      if constexpr ( bits == 32 ){
+         return static_cast< U >( ( std::uint64_t( a ) * b ) >> 32 );
+      } else {
+         #ifdef __SIZEOF_INT128__
+            return static_cast< U >(
+               ( static_cast< unsigned __int128 >( a ) * b ) >> 64 );
+         #else
+            const std::uint64_t a0 = a & 0xFFFF'FFFF, a1 = a >> 32;
+            const std::uint64_t b0 = b & 0xFFFF'FFFF, b1 = b >> 32;
+            const std::uint64_t p00 = a0 * b0, p01 = a0 * b1;
+            const std::uint64_t p10 = a1 * b0, p11 = a1 * b1;
+            const std::uint64_t middle =
+               ( p00 >> 32 ) + ( p01 & 0xFFFF'FFFF ) + ( p10 & 0xFFFF'FFFF );
+            return p11 + ( p01 >> 32 ) + ( p10 >> 32 ) + ( middle >> 32 );
+         #endif
+      }
+   }
+
+   // ceil( 2^( bits - 1 + l ) / w ), by long division one bit at a time
+   static constexpr U magic_for( U w, int l ){
+      U q = 0, r = 0;
+      for( int i = bits - 1 + l; i >= 0; --i ){
+         r = 2 * r + ( i == bits - 1 + l );
+         q = 2 * q + ( r >= w );
+         if( r >= w ){
+            r -= w;
+         }
+      }
+      return q + ( r != 0 );
+   }
+
+   // bounded at bits - 1, which is enough for each width
+   // up to max_width (and doesn't shift out for a wider one)
+   static constexpr int log2_ceil( U w ){
+      int l = 0;
+      while( ( l < bits - 1 ) && ( ( U( 1 ) << l ) < w ) ){
+         ++l;
+      }
+      return l;
+   }
+
+public:
+
+   /// buckets of width (which must be in 1 .. max_width),
+   /// from the origin
+   constexpr bucket_divider( T width, const moment & origin = moment() ):
+      origin_( origin ), width_( width ),
+      magic( magic_for( static_cast< U >( width ),
+         log2_ceil( static_cast< U >( width ) ) ) ),
+      shift( log2_ceil( static_cast< U >( width ) ) )
+   {
+      assert( ( width > 0 ) && ( width <= max_width ) );
+   }
+
+   /// the width of the buckets
+   constexpr T width() const { return width_; }
+
+   /// the origin: the start of bucket 0
+   constexpr moment origin() const { return origin_; }
+
+   /// the index of the bucket of t: floor( ( t - origin ) / width )
+   constexpr index_type index( const moment & t ) const {
+      const index_type d = static_cast< index_type >( t - origin_ );
+      const index_type s = d < 0 ? -1 : 0;
+      const U u = static_cast< U >( d ^ s );
+      const U q = high_half( u << 1, magic ) >> shift;
+      return static_cast< index_type >( q ) ^ s;
+   }
+
+   /// the start of bucket i
+   constexpr moment start( index_type i ) const {
+      return origin_ + static_cast< T >( static_cast< T >( i ) * width_ );
+   }
+
+   /// the start of the bucket of t: the last boundary at or before t
+   constexpr moment floor( const moment & t ) const {
+      return start( index( t ) );
+   }
+
+   /// the first bucket boundary at or after t
+   constexpr moment ceil( const moment & t ) const {
+      const moment f = floor( t );
+      return f + static_cast< T >( width_ * T( f != t ) );
+   }
+
+   /// the bucket indices of n moments
+   void index( const moment * in, index_type * out, std::size_t n ) const {
+      const bucket_divider d = *this;
+      for( std::size_t i = 0; i < n; ++i ){
+         out[ i ] = d.index( in[ i ] );
+      }
+   }
+
+   /// the bucket starts of n moments
+   ///
+   /// The in and out ranges may be the same, but must not
+   /// otherwise overlap.
+   void floor( const moment * in, moment * out, std::size_t n ) const {
+      const bucket_divider d = *this;
+      for( std::size_t i = 0; i < n; ++i ){
+         out[ i ] = d.floor( in[ i ] );
+      }
+   }
+
+   /// the first bucket boundaries at or after n moments
+   ///
+   /// The in and out ranges may be the same, but must not
+   /// otherwise overlap.
+   void ceil( const moment * in, moment * out, std::size_t n ) const {
+      const bucket_divider d = *this;
+      for( std::size_t i = 0; i < n; ++i ){
+         out[ i ] = d.ceil( in[ i ] );
+      }
+   }
+
+}; // template class bucket_divider
+
+#endif // ifndef torsor_bucket_hpp
@@ -0,0 +1,74 @@
+// ==========================================================================
+//
+// torsor-clock.hpp
+//
+// clock (now() and wait()) with torsor moments,
+// based on std::chrono::steady_clock
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_clock_hpp
+#define torsor_clock_hpp
+
+/// @file
+
+#include <chrono>
+#include <thread>
+#include "torsor.hpp"
+
+// A clock is the now() / wait() pair from the timing example 
+// in the readme, wrapped in a struct:
+//
+//    struct C {
+//       using duration = ...;
+//       using moment = torsor< duration, some_tag >;
+//       static moment now();
+//       static void wait( moment ); // wait until the moment
+//    };
+//
+// The schedulers and executors in the other torsor-*.hpp files
+// are templates on such a clock, so they can run on real time
+// or on a simulated time.
+
+
+// ==========================================================================
+//
+// a clock based on std::chrono::steady_clock
+//
+// ==========================================================================
+
+/// clock based on std::chrono::steady_clock
+struct steady_clock_source {
+
+   /// the duration
+   using duration = std::chrono::nanoseconds;
+
+   /// tag for the moments
+   struct tag {};
+
+   /// the moments
+   using moment = torsor< duration, tag >;
+
+   /// the current moment
+   static moment now(){
+      return moment() + std::chrono::duration_cast< duration >(
+         std::chrono::steady_clock::now().time_since_epoch() );
+   }
+
+   /// wait until the moment t
+   static void wait( moment t ){
+      std::this_thread::sleep_until(
+         std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<
+               std::chrono::steady_clock::duration >( t - moment() )));
+   }
+};
+
+#endif // ifndef torsor_clock_hpp
@@ -0,0 +1,484 @@
+// ==========================================================================
+//
+// torsor-compact.hpp
+//
+// compact (epoch-relative) storage of torsors:
+// a narrow stored offset, wide torsors on access
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_compact_hpp
+#define torsor_compact_hpp
+
+/// @file
+
+#include <cstddef>
+#include <limits>
+#include <iterator>
+#include <vector>
+#include "torsor.hpp"
+
+
+// ==========================================================================
+//
+// batch kernels
+//
+// These are plain loops without branches or calls in the loop body,
+// which the compiler vectorizes at -O2 / -O3 for the target at hand.
+//
+// ==========================================================================
+
+/// widen n offsets to torsors
+///
+/// Each out[ i ] is set to the epoch plus the offset in[ i ].
+template< typename O, typename T, typename M >
+void widen(
+   const torsor< T, M > & epoch,
+   const O * in, torsor< T, M > * out, std::size_t n
+){
+   for( std::size_t i = 0; i < n; ++i ){
+      out[ i ] = epoch + static_cast< T >( in[ i ] );
+   }
+}
+
+/// narrow n torsors to offsets
+///
+/// Each out[ i ] is set to ( in[ i ] - epoch ), narrowed to O.
+/// The result is whether all distances fitted in O.
+/// All elements are stored regardless of the result,
+/// those that didn't fit are wrapped or truncated.
+template< typename O, typename T, typename M >
+bool narrow(
+   const torsor< T, M > & epoch,
+   const torsor< T, M > * in, O * out, std::size_t n
+){
+   const T low  = static_cast< T >( std::numeric_limits< O >::min() );
+   const T high = static_cast< T >( std::numeric_limits< O >::max() );
+   bool bad = false;
+   for( std::size_t i = 0; i < n; ++i ){
+      const T d = in[ i ] - epoch;
+      bad |= ( d < low ) | ( d > high );
+      out[ i ] = static_cast< O >( d );
+   }
+   return ! bad;
+}
+
+
+// ==========================================================================
+//
+// compact torsors
+//
+// ==========================================================================
+
+/// epoch-relative compact view on an array of offsets
+//
+/// A compact_torsors< O, T, M > is a view on (caller-provided)
+/// storage of n offsets of type O (for instance int32_t)
+/// from an epoch torsor< T, M > (for instance torsor< int64_t >).
+/// Elements are read and written as full torsor< T, M > values,
+/// so the narrow offsets never leak to the user.
+///
+/// The view doesn't own or allocate its storage: it can be a plain array,
+/// the data of a std::vector, or a memory-mapped file.
+template< typename O, typename T, typename M = void >
+class compact_torsors final {
+public:
+
+   /// the type of the elements as seen by the user
+   using value_type = torsor< T, M >;
+
+private:
+
+   value_type epoch_;
+   O * data_;
+   std::size_t size_;
+
+public:
+
+   /// writeable reference to an element
+   class reference final {
+   private:
+      const compact_torsors & owner;
+      O & offset;
+
+   public:
+      reference( const compact_torsors & owner, O & offset ):
+         owner( owner ), offset( offset )
+      {}
+
+      /// the element as a torsor
+      operator value_type() const {
+         return owner.epoch_ + static_cast< T >( offset );
+      }
+
+      /// store a torsor into the element
+      reference & operator=( const value_type & right ){
+         offset = static_cast< O >( right - owner.epoch_ );
+         return *this;
+      }
+
+      /// store the torsor of another element into the element
+      reference & operator=( const reference & right ){
+         return *this = static_cast< value_type >( right );
+      }
+   };
+
+   /// read-only random access iterator,
+   /// which hands out full torsor values
+   ///
+   /// It returns a value instead of a reference, so for the
+   /// C++17 iterator categories it is only an input iterator;
+   /// for the C++20 iterator concepts it is a random access iterator.
+   class const_iterator final {
+   public:
+      using iterator_category = std::input_iterator_tag;
+      using iterator_concept  = std::random_access_iterator_tag;
+      using value_type        = torsor< T, M >;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = void;
+      using reference         = value_type;
+
+   private:
+      value_type epoch;
+      const O * p;
+
+   public:
+      const_iterator(): epoch(), p( nullptr ){}
+
+      const_iterator( const value_type & epoch, const O * p ):
+         epoch( epoch ), p( p )
+      {}
+
+      value_type operator*() const {
+         return epoch + static_cast< T >( *p );
+      }
+
+      value_type operator[]( difference_type n ) const {
+         return epoch + static_cast< T >( p[ n ] );
+      }
+
+      const_iterator & operator++(){ ++p; return *this; }
+      const_iterator & operator--(){ --p; return *this; }
+      const_iterator operator++( int ){ auto t = *this; ++p; return t; }
+      const_iterator operator--( int ){ auto t = *this; --p; return t; }
+
+      const_iterator & operator+=( difference_type n ){ p += n; return *this; }
+      const_iterator & operator-=( difference_type n ){ p -= n; return *this; }
+
+      const_iterator operator+( difference_type n ) const {
+         return const_iterator( epoch, p + n );
+      }
+
+      friend const_iterator operator+(
+         difference_type n, const const_iterator & i
+      ){
+         return i + n;
+      }
+
+      const_iterator operator-( difference_type n ) const {
+         return const_iterator( epoch, p - n );
+      }
+
+      difference_type operator-( const const_iterator & right ) const {
+         return p - right.p;
+      }
+
+      bool operator==( const const_iterator & r ) const { return p == r.p; }
+      bool operator!=( const const_iterator & r ) const { return p != r.p; }
+      bool operator< ( const const_iterator & r ) const { return p <  r.p; }
+      bool operator<=( const const_iterator & r ) const { return p <= r.p; }
+      bool operator> ( const const_iterator & r ) const { return p >  r.p; }
+      bool operator>=( const const_iterator & r ) const { return p >= r.p; }
+   };
+
+   /// create a view on n offsets from the epoch
+   compact_torsors( const value_type & epoch, O * data, std::size_t n ):
+      epoch_( epoch ), data_( data ), size_( n )
+   {}
+
+   /// the epoch
+   value_type epoch() const { return epoch_; }
+
+   /// the number of elements
+   std::size_t size() const { return size_; }
+
+   /// the stored offsets
+   O * data() const { return data_; }
+
+   /// read element i
+   value_type operator[]( std::size_t i ) const {
+      return epoch_ + static_cast< T >( data_[ i ] );
+   }
+
+   /// read or write element i
+   reference operator[]( std::size_t i ){
+      return reference( *this, data_[ i ] );
+   }
+
+   /// whether a torsor can be stored without loss
+   bool fits( const value_type & t ) const {
+      const T d = t - epoch_;
+      return
+         ( d >= static_cast< T >( std::numeric_limits< O >::min() ))
+         && ( d <= static_cast< T >( std::numeric_limits< O >::max() ));
+   }
+
+   /// the first element
+   const_iterator begin() const {
+      return const_iterator( epoch_, data_ );
+   }
+
+   /// past the last element
+   const_iterator end() const {
+      return const_iterator( epoch_, data_ + size_ );
+   }
+
+   /// widen all elements into out[ 0 .. size() )
+   void get( value_type * out ) const {
+      widen( epoch_, data_, out, size_ );
+   }
+
+   /// narrow in[ 0 .. size() ) into the elements,
+   /// return whether they all fitted
+   bool set( const value_type * in ){
+      return narrow( epoch_, in, data_, size_ );
+   }
+
+}; // template class compact_torsors
+
+
+// ==========================================================================
+//
+// compact vector
+//
+// ==========================================================================
+
+/// epoch-relative compact container of torsors
+//
+/// A compact_vector< O, T, M > owns its offsets (in a std::vector< O >)
+/// from an epoch torsor< T, M >, and grows like a std::vector.
+/// A torsor is encoded against the epoch when it is stored:
+/// push_back() and assign() store only torsors that fit in O,
+/// and return whether they did. An element that is written through
+/// a reference (c[ i ] = t, *it = t) is narrowed without a check,
+/// like in a compact_torsors: use fits() first when needed.
+/// view() gives a compact_torsors on the elements.
+template< typename O, typename T, typename M = void >
+class compact_vector final {
+public:
+
+   /// the type of the elements as seen by the user
+   using value_type = torsor< T, M >;
+
+   /// the view on the elements
+   using view_type = compact_torsors< O, T, M >;
+
+   /// read-only random access iterator
+   using const_iterator = typename view_type::const_iterator;
+
+private:
+
+   value_type epoch_;
+   std::vector< O > offsets;
+
+public:
+
+   /// writeable reference to an element
+   class reference final {
+   private:
+      value_type epoch;
+      O * offset;
+
+   public:
+      reference( const value_type & epoch, O * offset ):
+         epoch( epoch ), offset( offset )
+      {}
+
+      /// the element as a torsor
+      operator value_type() const {
+         return epoch + static_cast< T >( *offset );
+      }
+
+      /// store a torsor into the element
+      reference & operator=( const value_type & right ){
+         *offset = static_cast< O >( right - epoch );
+         return *this;
+      }
+
+      /// store the torsor of another element into the element
+      reference & operator=( const reference & right ){
+         return *this = static_cast< value_type >( right );
+      }
+   };
+
+   /// random access iterator, which hands out writeable references
+   ///
+   /// Those references are proxies, so (like the const_iterator)
+   /// it is an input iterator for the C++17 iterator categories.
+   class iterator final {
+   public:
+      using iterator_category = std::input_iterator_tag;
+      using iterator_concept  = std::random_access_iterator_tag;
+      using value_type        = torsor< T, M >;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = void;
+      using reference         = typename compact_vector::reference;
+
+   private:
+      value_type epoch;
+      O * p;
+
+   public:
+      iterator(): epoch(), p( nullptr ){}
+
+      iterator( const value_type & epoch, O * p ):
+         epoch( epoch ), p( p )
+      {}
+
+      /// the same position, read-only
+      operator const_iterator() const { return const_iterator( epoch, p ); }
+
+      reference operator*() const { return reference( epoch, p ); }
+
+      reference operator[]( difference_type n ) const {
+         return reference( epoch, p + n );
+      }
+
+      iterator & operator++(){ ++p; return *this; }
+      iterator & operator--(){ --p; return *this; }
+      iterator operator++( int ){ auto t = *this; ++p; return t; }
+      iterator operator--( int ){ auto t = *this; --p; return t; }
+
+      iterator & operator+=( difference_type n ){ p += n; return *this; }
+      iterator & operator-=( difference_type n ){ p -= n; return *this; }
+
+      iterator operator+( difference_type n ) const {
+         return iterator( epoch, p + n );
+      }
+
+      friend iterator operator+( difference_type n, const iterator & i ){
+         return i + n;
+      }
+
+      iterator operator-( difference_type n ) const {
+         return iterator( epoch, p - n );
+      }
+
+      difference_type operator-( const iterator & right ) const {
+         return p - right.p;
+      }
+
+      bool operator==( const iterator & r ) const { return p == r.p; }
+      bool operator!=( const iterator & r ) const { return p != r.p; }
+      bool operator< ( const iterator & r ) const { return p <  r.p; }
+      bool operator<=( const iterator & r ) const { return p <= r.p; }
+      bool operator> ( const iterator & r ) const { return p >  r.p; }
+      bool operator>=( const iterator & r ) const { return p >= r.p; }
+   };
+
+   /// an empty container with the epoch
+   explicit compact_vector( const value_type & epoch = value_type() ):
+      epoch_( epoch )
+   {}
+
+   /// the epoch
+   value_type epoch() const { return epoch_; }
+
+   /// the number of elements
+   std::size_t size() const { return offsets.size(); }
+
+   /// whether there are no elements
+   bool empty() const { return offsets.empty(); }
+
+   /// the stored offsets
+   const O * data() const { return offsets.data(); }
+
+   /// reserve room for n elements
+   void reserve( std::size_t n ){ offsets.reserve( n ); }
+
+   /// remove all elements
+   void clear(){ offsets.clear(); }
+
+   /// resize to n elements, new elements are the epoch
+   void resize( std::size_t n ){ offsets.resize( n, O( 0 ) ); }
+
+   /// whether a torsor can be stored without loss
+   bool fits( const value_type & t ) const {
+      const T d = t - epoch_;
+      return
+         ( d >= static_cast< T >( std::numeric_limits< O >::min() ))
+         && ( d <= static_cast< T >( std::numeric_limits< O >::max() ));
+   }
+
+   /// append a torsor, when it fits
+   ///
+   /// The result is whether it fitted (and was appended).
+   bool push_back( const value_type & t ){
+      if( ! fits( t ) ){
+         return false;
+      }
+      offsets.push_back( static_cast< O >( t - epoch_ ) );
+      return true;
+   }
+
+   /// replace the elements by the n torsors in[ 0 .. n ), when they fit
+   ///
+   /// The result is whether they all fitted. 
+   /// When they didn't, the container is empty.
+   bool assign( const value_type * in, std::size_t n ){
+      offsets.resize( n );
+      if( ! narrow( epoch_, in, offsets.data(), n ) ){
+         offsets.clear();
+         return false;
+      }
+      return true;
+   }
+
+   /// read element i
+   value_type operator[]( std::size_t i ) const {
+      return epoch_ + static_cast< T >( offsets[ i ] );
+   }
+
+   /// read or write element i
+   reference operator[]( std::size_t i ){
+      return reference( epoch_, & offsets[ i ] );
+   }
+
+   /// the first element
+   iterator begin(){ return iterator( epoch_, offsets.data() ); }
+
+   /// past the last element
+   iterator end(){ return iterator( epoch_, offsets.data() + offsets.size() ); }
+
+   /// the first element, read-only
+   const_iterator begin() const {
+      return const_iterator( epoch_, offsets.data() );
+   }
+
+   /// past the last element, read-only
+   const_iterator end() const {
+      return const_iterator( epoch_, offsets.data() + offsets.size() );
+   }
+
+   /// a view on the elements
+   ///
+   /// It is valid until the number of elements changes.
+   view_type view(){
+      return view_type( epoch_, offsets.data(), offsets.size() );
+   }
+
+   /// widen all elements into out[ 0 .. size() )
+   void get( value_type * out ) const {
+      widen( epoch_, offsets.data(), out, offsets.size() );
+   }
+
+}; // template class compact_vector
+
+#endif // ifndef torsor_compact_hpp
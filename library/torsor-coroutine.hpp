@@ -0,0 +1,324 @@
+// ==========================================================================
+//
+// torsor-coroutine.hpp
+//
+// single-threaded C++20 coroutine executor,
+// with co_await on torsor deadlines
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_coroutine_hpp
+#define torsor_coroutine_hpp
+
+/// @file
+
+#include <cstdint>
+#include <exception>
+#include <type_traits>
+#include <coroutine>
+#include <vector>
+#include "torsor.hpp"
+#include "torsor-clock.hpp"
+
+// The executor is driven by a clock C (see torsor-clock.hpp),
+// for instance the steady_clock_source.
+//
+// Within a coroutine_task< C >, co_await sleep_until( moment ) and
+// co_await sleep_for( duration ) suspend the task.
+// A coroutine frame is allocated once, when the task is created.
+// The sleeping tasks are kept in a binary heap of 
+// ( deadline, sequence, handle ) entries in one contiguous array,
+// so the heap operations don't touch the (scattered) frames.
+// That array grows only when more tasks sleep than ever before
+// (or than reserve()'d), so an await doesn't allocate.
+//
+// The executor destroys the frames of the tasks that are still
+// sleeping when it is destroyed.
+//
+// The executor waits (by calling C::wait) only when no task is due.
+// All tasks that are due when it wakes up are resumed as one batch,
+// in deadline order, and in the order they went to sleep when
+// the deadlines coincide.
+
+
+template< typename C > class coroutine_executor;
+
+
+// ==========================================================================
+//
+// task
+//
+// ==========================================================================
+
+/// a coroutine that runs on a coroutine_executor< C >
+///
+/// A task starts when it is spawned on an executor, and
+/// frees its frame when it returns.
+template< typename C >
+class coroutine_task final {
+public:
+
+   /// the promise of a task
+   struct promise_type {
+      coroutine_executor< C > * executor = nullptr;
+
+      coroutine_task get_return_object(){
+         return coroutine_task( std::coroutine_handle< promise_type >
+            ::from_promise( *this ) );
+      }
+
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void(){}
+      void unhandled_exception(){ std::terminate(); }
+   };
+
+private:
+
+   friend class coroutine_executor< C >;
+   std::coroutine_handle< promise_type > handle;
+
+   explicit coroutine_task( std::coroutine_handle< promise_type > handle ):
+      handle( handle )
+   {}
+
+public:
+
+   coroutine_task( const coroutine_task & ) = delete;
+   coroutine_task & operator=( const coroutine_task & ) = delete;
+
+   coroutine_task( coroutine_task && right ): handle( right.handle ){
+      right.handle = nullptr;
+   }
+
+   ~coroutine_task(){
+      // a task that was never spawned is destroyed
+      if( handle ){
+         handle.destroy();
+      }
+   }
+};
+
+
+// ==========================================================================
+//
+// awaiters
+//
+// ==========================================================================
+
+///@cond INTERNAL
+template< typename D, typename M >
+struct sleep_until_awaiter {
+   torsor< D, M > deadline;
+
+   bool await_ready() const noexcept { return false; }
+
+   template< typename P >
+   void await_suspend( std::coroutine_handle< P > h ){
+      auto & executor = * h.promise().executor;
+      static_assert( std::is_same_v< torsor< D, M >,
+         typename std::remove_reference_t< decltype( executor ) >::moment >,
+         "the deadline must be a moment of the clock of the executor" );
+      executor.schedule( deadline, h );
+   }
+
+   void await_resume() const noexcept {}
+};
+
+template< typename D >
+struct sleep_for_awaiter {
+   D delay;
+
+   bool await_ready() const noexcept { return false; }
+
+   template< typename P >
+   void await_suspend( std::coroutine_handle< P > h ){
+      auto & executor = * h.promise().executor;
+      static_assert( std::is_same_v< D,
+         typename std::remove_reference_t< decltype( executor ) >::duration >,
+         "the delay must be a duration of the clock of the executor" );
+      executor.schedule( executor.now() + delay, h );
+   }
+
+   void await_resume() const noexcept {}
+};
+///@endcond
+
+/// suspend the task until the moment t
+///
+/// The moment must be a moment of the clock of the executor.
+template< typename D, typename M >
+sleep_until_awaiter< D, M > sleep_until( const torsor< D, M > & t ){
+   return sleep_until_awaiter< D, M >{ t };
+}
+
+/// suspend the task for the duration d
+///
+/// The duration must be the duration of the clock of the executor.
+template< typename D >
+sleep_for_awaiter< D > sleep_for( const D & d ){
+   return sleep_for_awaiter< D >{ d };
+}
+
+
+// ==========================================================================
+//
+// executor
+//
+// ==========================================================================
+
+/// single-threaded executor of coroutine_task< C > coroutines
+template< typename C >
+class coroutine_executor final {
+public:
+
+   /// the clock
+   using clock = C;
+
+   /// the moments of the clock
+   using moment = typename C::moment;
+
+   /// the durations of the clock
+   using duration = typename C::duration;
+
+private:
+
+   struct entry {
+      moment deadline;
+      std::uint64_t sequence;
+      std::coroutine_handle<> handle;
+
+      // the deadline, or when equal, the sequence
+      bool before( const entry & right ) const {
+         return ( deadline < right.deadline )
+            || ( ( deadline == right.deadline )
+               && ( sequence < right.sequence ) );
+      }
+   };
+
+   // the sleeping tasks: a binary heap with the first deadline on top
+   std::vector< entry > heap;
+
+   // the tasks that are resumed by the current wakeup
+   std::vector< std::coroutine_handle<> > batch;
+
+   std::uint64_t sequence = 0;
+   std::uint64_t resumed = 0;
+   std::uint64_t batches = 0;
+
+   void pop(){
+      const entry last = heap.back();
+      heap.pop_back();
+      const std::size_t n = heap.size();
+      if( n == 0 ){
+         return;
+      }
+      std::size_t i = 0;
+      for(;;){
+         std::size_t c = 2 * i + 1;
+         if( c >= n ){
+            break;
+         }
+         if( ( c + 1 < n ) && heap[ c + 1 ].before( heap[ c ] ) ){
+            ++c;
+         }
+         if( ! heap[ c ].before( last ) ){
+            break;
+         }
+         heap[ i ] = heap[ c ];
+         i = c;
+      }
+      heap[ i ] = last;
+   }
+
+public:
+
+   coroutine_executor() = default;
+
+   coroutine_executor( const coroutine_executor & ) = delete;
+   coroutine_executor & operator=( const coroutine_executor & ) = delete;
+
+   /// destroy the frames of the tasks that are still sleeping
+   ~coroutine_executor(){
+      for( auto & e : heap ){
+         e.handle.destroy();
+      }
+   }
+
+   /// the current moment
+   moment now() const { return C::now(); }
+
+   /// make room for n sleeping tasks
+   void reserve( std::size_t n ){
+      heap.reserve( n );
+      batch.reserve( n );
+   }
+
+   /// schedule a resume of h at the deadline (used by the awaiters)
+   void schedule( const moment & deadline, std::coroutine_handle<> h ){
+      const entry e{ deadline, sequence++, h };
+      std::size_t i = heap.size();
+      heap.push_back( e );
+      while( i > 0 ){
+         const std::size_t p = ( i - 1 ) / 2;
+         if( ! e.before( heap[ p ] ) ){
+            break;
+         }
+         heap[ i ] = heap[ p ];
+         i = p;
+      }
+      heap[ i ] = e;
+   }
+
+   /// start a task: run it until its first co_await
+   void spawn( coroutine_task< C > && t ){
+      auto h = t.handle;
+      t.handle = nullptr;
+      h.promise().executor = this;
+      h.resume();
+   }
+
+   /// run the tasks until none is sleeping
+   void run(){
+      while( ! heap.empty() ){
+         moment t = C::now();
+         if( t < heap.front().deadline ){
+            C::wait( heap.front().deadline );
+            t = C::now();
+         }
+
+         // take all due tasks, in deadline order
+         batch.clear();
+         while( ( ! heap.empty() ) && !( t < heap.front().deadline ) ){
+            batch.push_back( heap.front().handle );
+            pop();
+         }
+         ++batches;
+
+         for( auto h : batch ){
+            ++resumed;
+            h.resume();
+         }
+
+         // the resumed tasks have returned (and freed their frames)
+         // or are in the heap again
+         batch.clear();
+      }
+   }
+
+   /// the number of resumes from a sleep
+   std::uint64_t resumes() const { return resumed; }
+
+   /// the number of times run() woke up to resume a batch
+   std::uint64_t wakeups() const { return batches; }
+
+}; // template class coroutine_executor
+
+#endif // ifndef torsor_coroutine_hpp
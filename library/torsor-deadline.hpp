@@ -0,0 +1,376 @@
+// ==========================================================================
+//
+// torsor-deadline.hpp
+//
+// earliest-deadline-first thread pool,
+// with torsor moments as deadlines
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_deadline_hpp
+#define torsor_deadline_hpp
+
+/// @file
+
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "torsor.hpp"
+#include "torsor-clock.hpp"
+
+// Each worker has its own heap of jobs, ordered by deadline,
+// that only the worker itself touches, so it needs no lock.
+// A submitted job goes to the inboxes of the workers in turn:
+// an inbox is a lock-free stack, a submit pushes a job with a
+// compare-and-swap, the worker takes all jobs at once with an
+// exchange, and puts them in its heap.
+//
+// A worker runs the most urgent job of its heap, and offers the
+// next one in an atomic slot, from which another worker can
+// take it with an exchange. A worker that has no jobs of its own
+// steals the most urgent offered job, or else (when the workers
+// are busy with long jobs) all jobs of the inbox of another worker.
+// An idle worker sleeps until a job is submitted or offered,
+// so it doesn't spin while all jobs are in the heaps of busy workers.
+//
+// Only an idle worker ever takes a lock (to sleep), and a worker
+// or a submit only takes it to wake an idle worker.
+//
+// A job that is popped after its deadline is shed (not run),
+// unless shedding was disabled.
+
+
+/// earliest-deadline-first thread pool
+//
+/// The pool is a template on a clock C (see torsor-clock.hpp).
+/// Deadlines are C::moment values, lateness is a C::duration.
+template< typename C = steady_clock_source >
+class deadline_pool final {
+public:
+
+   /// the moments of the clock
+   using moment = typename C::moment;
+
+   /// the durations of the clock
+   using duration = typename C::duration;
+
+   /// the statistics of a worker
+   struct statistics {
+
+      /// the number of jobs that were run
+      std::uint64_t done;
+
+      /// the number of jobs that were shed
+      std::uint64_t shed;
+
+      /// the number of jobs that finished after their deadline
+      std::uint64_t late;
+
+      /// the sum of how late those jobs finished
+      duration total_lateness;
+
+      /// the largest lateness
+      duration max_lateness;
+   };
+
+private:
+
+   struct job {
+      moment deadline;
+      std::uint64_t sequence;
+      std::function< void() > work;
+      job * next;
+
+      // the deadline, or when equal, the sequence
+      bool before( const job & right ) const {
+         return ( deadline < right.deadline )
+            || ( ( deadline == right.deadline )
+               && ( sequence < right.sequence ) );
+      }
+   };
+
+   // one per worker, on its own cache line
+   struct alignas( 64 ) worker {
+      std::atomic< job * > inbox{ nullptr };
+      std::atomic< job * > offer{ nullptr };
+      std::atomic< moment > offered{ moment() };
+      std::vector< job * > heap;
+      statistics stats{ 0, 0, 0, duration( 0 ), duration( 0 ) };
+      std::thread thread;
+   };
+
+   const bool shed_late;
+   std::unique_ptr< worker[] > workers;
+   const unsigned n;
+
+   std::atomic< std::uint64_t > sequence{ 0 };
+   std::atomic< long long > pending{ 0 };
+   std::atomic< std::uint64_t > events{ 0 };
+   std::atomic< unsigned > sleeping{ 0 };
+   std::atomic< bool > stopping{ false };
+
+   std::mutex idle_lock;
+   std::condition_variable work_available;
+   std::condition_variable all_done;
+
+   static void push_heap( std::vector< job * > & heap, job * j ){
+      std::size_t i = heap.size();
+      heap.push_back( j );
+      while( i > 0 ){
+         const std::size_t p = ( i - 1 ) / 2;
+         if( ! heap[ i ]->before( *heap[ p ] ) ){
+            break;
+         }
+         std::swap( heap[ i ], heap[ p ] );
+         i = p;
+      }
+   }
+
+   static job * pop_heap( std::vector< job * > & heap ){
+      job * top = heap.front();
+      heap.front() = heap.back();
+      heap.pop_back();
+      const std::size_t size = heap.size();
+      std::size_t i = 0;
+      for(;;){
+         std::size_t c = 2 * i + 1;
+         if( c >= size ){
+            break;
+         }
+         if( ( c + 1 < size ) && heap[ c + 1 ]->before( *heap[ c ] ) ){
+            ++c;
+         }
+         if( ! heap[ c ]->before( *heap[ i ] ) ){
+            break;
+         }
+         std::swap( heap[ i ], heap[ c ] );
+         i = c;
+      }
+      return top;
+   }
+
+   // a job was submitted (all: only its owner can take it
+   // from the inbox when no worker is idle) or offered (one)
+   void signal( bool all ){
+      events.fetch_add( 1 );
+      if( sleeping.load() > 0 ){
+         std::lock_guard< std::mutex > guard( idle_lock );
+         if( all ){
+            work_available.notify_all();
+         } else {
+            work_available.notify_one();
+         }
+      }
+   }
+
+   // move the jobs of a list to the heap of w
+   static void take_list( worker & w, job * list ){
+      while( list != nullptr ){
+         job * next = list->next;
+         push_heap( w.heap, list );
+         list = next;
+      }
+   }
+
+   // pop the most urgent job of worker w (if it has one),
+   // and offer the next one
+   job * take_own( worker & w ){
+      take_list( w, w.inbox.exchange( nullptr, std::memory_order_acquire ) );
+      job * o = w.offer.exchange( nullptr, std::memory_order_acquire );
+      if( o != nullptr ){
+         push_heap( w.heap, o );
+      }
+      if( w.heap.empty() ){
+         return nullptr;
+      }
+      job * j = pop_heap( w.heap );
+      if( ! w.heap.empty() ){
+         job * next = pop_heap( w.heap );
+         w.offered.store( next->deadline, std::memory_order_relaxed );
+         w.offer.store( next, std::memory_order_release );
+         signal( false );
+      }
+      return j;
+   }
+
+   // steal the most urgent offered job of the other workers,
+   // or else the jobs in the inbox of another worker
+   //
+   // The deadlines of the offers only select the victim: the job
+   // is claimed by the exchange, so it is never taken twice.
+   job * try_steal( unsigned self ){
+      worker * victim = nullptr;
+      moment first;
+      for( unsigned i = 1; i < n; ++i ){
+         worker & w = workers[ ( self + i ) % n ];
+         if( w.offer.load( std::memory_order_relaxed ) != nullptr ){
+            const moment d = w.offered.load( std::memory_order_relaxed );
+            if( ( victim == nullptr ) || ( d < first ) ){
+               victim = & w;
+               first = d;
+            }
+         }
+      }
+      if( victim != nullptr ){
+         job * j = victim->offer.exchange( nullptr, std::memory_order_acquire );
+         if( j != nullptr ){
+            return j;
+         }
+      }
+      for( unsigned i = 1; i < n; ++i ){
+         worker & w = workers[ ( self + i ) % n ];
+         if( w.inbox.load( std::memory_order_relaxed ) != nullptr ){
+            job * list = w.inbox.exchange( nullptr, std::memory_order_acquire );
+            if( list != nullptr ){
+               take_list( workers[ self ], list );
+               return take_own( workers[ self ] );
+            }
+         }
+      }
+      return nullptr;
+   }
+
+   void execute( worker & w, job * j ){
+      if( shed_late && ( j->deadline < C::now() ) ){
+         ++w.stats.shed;
+      } else {
+         j->work();
+         const duration lateness = C::now() - j->deadline;
+         ++w.stats.done;
+         if( lateness > duration( 0 ) ){
+            ++w.stats.late;
+            w.stats.total_lateness += lateness;
+            if( lateness > w.stats.max_lateness ){
+               w.stats.max_lateness = lateness;
+            }
+         }
+      }
+      delete j;
+      if( pending.fetch_sub( 1 ) == 1 ){
+         std::lock_guard< std::mutex > guard( idle_lock );
+         all_done.notify_all();
+      }
+   }
+
+   void run( unsigned self ){
+      worker & w = workers[ self ];
+      for(;;){
+         const std::uint64_t seen = events.load();
+         job * j = take_own( w );
+         if( j == nullptr ){
+            j = try_steal( self );
+         }
+         if( j != nullptr ){
+            execute( w, j );
+            continue;
+         }
+
+         // the other workers run the jobs in their own heaps
+         if( stopping.load() ){
+            return;
+         }
+         std::unique_lock< std::mutex > guard( idle_lock );
+         sleeping.fetch_add( 1 );
+         work_available.wait( guard, [ & ]{
+            return stopping.load() || ( events.load() != seen ); } );
+         sleeping.fetch_sub( 1 );
+      }
+   }
+
+public:
+
+   /// create a pool with the specified number of workers
+   ///
+   /// When shed_late is true, jobs that are started after their
+   /// deadline are not run, but counted as shed.
+   deadline_pool(
+      unsigned n_workers = std::thread::hardware_concurrency(),
+      bool shed_late = true
+   ):
+      shed_late( shed_late ),
+      workers( new worker[ n_workers > 0 ? n_workers : 1 ] ),
+      n( n_workers > 0 ? n_workers : 1 )
+   {
+      for( unsigned i = 0; i < n; ++i ){
+         workers[ i ].thread = std::thread( [ this, i ]{ run( i ); } );
+      }
+   }
+
+   deadline_pool( const deadline_pool & ) = delete;
+   deadline_pool & operator=( const deadline_pool & ) = delete;
+
+   /// finish the submitted jobs, and stop the workers
+   ~deadline_pool(){
+      {
+         std::lock_guard< std::mutex > guard( idle_lock );
+         stopping = true;
+      }
+      work_available.notify_all();
+      for( unsigned i = 0; i < n; ++i ){
+         workers[ i ].thread.join();
+      }
+   }
+
+   /// the number of workers
+   unsigned size() const { return n; }
+
+   /// submit a job that must be done before the deadline
+   template< typename F >
+   void submit( const moment & deadline, F && work ){
+      const auto s = sequence.fetch_add( 1, std::memory_order_relaxed );
+      worker & w = workers[ s % n ];
+      pending.fetch_add( 1 );
+      job * j = new job{ deadline, s, std::forward< F >( work ), nullptr };
+      j->next = w.inbox.load( std::memory_order_relaxed );
+      while( ! w.inbox.compare_exchange_weak( j->next, j,
+         std::memory_order_release, std::memory_order_relaxed ) ){}
+      signal( true );
+   }
+
+   /// wait until all submitted jobs are done or shed
+   void wait_idle(){
+      std::unique_lock< std::mutex > guard( idle_lock );
+      all_done.wait( guard, [ & ]{ return pending.load() == 0; } );
+   }
+
+   /// the statistics of worker i
+   ///
+   /// Call this only when the pool is idle (after wait_idle()).
+   statistics stats( unsigned i ) const {
+      return workers[ i ].stats;
+   }
+
+   /// the statistics of all workers together
+   ///
+   /// Call this only when the pool is idle (after wait_idle()).
+   statistics stats() const {
+      statistics r{ 0, 0, 0, duration( 0 ), duration( 0 ) };
+      for( unsigned i = 0; i < n; ++i ){
+         const statistics & s = workers[ i ].stats;
+         r.done += s.done;
+         r.shed += s.shed;
+         r.late += s.late;
+         r.total_lateness += s.total_lateness;
+         if( s.max_lateness > r.max_lateness ){
+            r.max_lateness = s.max_lateness;
+         }
+      }
+      return r;
+   }
+
+}; // template class deadline_pool
+
+#endif // ifndef torsor_deadline_hpp
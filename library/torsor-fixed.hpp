@@ -0,0 +1,356 @@
+// ==========================================================================
+//
+// torsor-fixed.hpp
+//
+// fixed-point numbers, as base type for torsors on targets
+// without a floating point unit
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_fixed_hpp
+#define torsor_fixed_hpp
+
+/// @file
+
+#include <cstdint>
+#include <type_traits>
+#include "torsor.hpp"
+
+// A fixed< I, F > is a signed number with I integer bits (including
+// the sign bit) and F fraction bits. It is stored as a raw integer
+// in the smallest signed integer type that has I + F bits,
+// its value is raw / 2^F. All operations are integer operations,
+// and constexpr, so a floating point value like fixed< 16, 16 >( 0.25 )
+// is converted by the compiler, not by a floating point library.
+//
+//    using meters = fixed< 16, 16 >;
+//    struct position_tag {};
+//    using position = torsor< meters, position_tag >;
+//
+//    position p = position() + meters( 3 );
+//    p += meters( 0.25 );
+//    meters d = p - position();
+//
+// + and - are exact.
+// Like for the raw integer, an overflow wraps for the 8 and 16 bit
+// storage types, and is undefined for the 32 and 64 bit types.
+//
+// A * of two fixed values drops F fraction bits. The rounding mode R
+// (fixed_rounding::nearest by default) specifies how those are
+// rounded. The product is first calculated in an integer type that
+// is twice as wide: for a fixed< 16, 16 > that is a single
+// 32 x 32 -> 64 bit multiplication, which most 32-bit cores have.
+// widening_multiply() returns the exact product, in a format
+// with the sum of the integer bits and of the fraction bits.
+//
+// A / truncates towards zero, like integer division.
+//
+// A fixed can be (explicitly) constructed from a fixed of
+// another format, which rounds as specified by the R of the
+// new format when fraction bits are dropped.
+
+
+// ==========================================================================
+//
+// rounding
+//
+// ==========================================================================
+
+/// how the fraction bits that are dropped are rounded
+enum class fixed_rounding {
+
+   /// towards minus infinity: an arithmetic shift, the cheapest
+   floor,
+
+   /// towards zero, like integer division
+   truncate,
+
+   /// to the nearest, halfway values upwards
+   nearest
+};
+
+///@cond INTERNAL
+
+// the widest signed integer type
+#ifdef __SIZEOF_INT128__
+   __extension__ typedef __int128 fixed_widest;
+#else
+   typedef std::int64_t fixed_widest;
+#endif
+
+// the smallest signed integer type that has (at least) N bits
+template< int N >
+using fixed_storage =
+   std::conditional_t< ( N <= 8 ),  std::int8_t,
+   std::conditional_t< ( N <= 16 ), std::int16_t,
+   std::conditional_t< ( N <= 32 ), std::int32_t,
+   std::conditional_t< ( N <= 64 ), std::int64_t,
+      fixed_widest > > > >;
+
+// v * 2^-S, rounded as specified by R
+template< fixed_rounding R, int S, typename W >
+constexpr W fixed_shift( W v ){
+   if constexpr ( S <= 0 ){
+      return v * ( W( 1 ) << -S );
+   } else if constexpr ( R == fixed_rounding::floor ){
+      return v >> S;
+   } else if constexpr ( R == fixed_rounding::nearest ){
+      return ( v + ( W( 1 ) << ( S - 1 ) ) ) >> S;
+   } else {
+      return v / ( W( 1 ) << S );
+   }
+}
+
+///@endcond
+
+
+// ==========================================================================
+//
+// fixed-point number
+//
+// ==========================================================================
+
+/// signed fixed-point number with I integer and F fraction bits
+template< int I, int F, fixed_rounding R = fixed_rounding::nearest >
+class fixed final {
+public:
+
+   static_assert( ( I >= 1 ) && ( F >= 0 ) && ( I + F <= 64 ),
+      "a fixed has at least the sign bit, and at most 64 bits" );
+
+   /// the type that stores the raw value
+   using storage = fixed_storage< I + F >;
+
+   /// the number of integer bits (including the sign bit)
+   static constexpr int integer_bits = I;
+
+   /// the number of fraction bits
+   static constexpr int fraction_bits = F;
+
+   /// the rounding mode
+   static constexpr fixed_rounding rounding = R;
+
+private:
+
+   // twice as wide as the storage: a product of two raw values
+   using wide = fixed_storage< 2 * ( I + F ) >;
+
+   // the raw value of 1
+   static constexpr wide one = wide( 1 ) << F;
+
+   storage raw_value;
+
+   struct raw_tag {};
+
+   constexpr fixed( storage raw, raw_tag ):
+      raw_value( raw )
+   {}
+
+public:
+
+   /// zero
+   constexpr fixed(): raw_value( 0 ){}
+
+   /// an integer value
+   ///
+   /// This conversion is implicit, because it is exact
+   /// (when the value is in range).
+   template< typename N >
+   ///@cond INTERNAL
+   requires std::is_integral_v< N >
+   ///@endcond
+   constexpr fixed( N n ):
+      raw_value( static_cast< storage >( n * one ) )
+   {}
+
+   /// a floating point value, rounded as specified by R
+   ///
+   /// A constexpr fixed is converted by the compiler,
+   /// so this doesn't need floating point support at run time.
+   constexpr explicit fixed( double d ):
+      raw_value( round( d * (double) one ) )
+   {}
+
+   /// the value in another format
+   ///
+   /// When fraction bits are dropped they are rounded
+   /// as specified by our R.
+   template< int I2, int F2, fixed_rounding R2 >
+   constexpr explicit fixed( const fixed< I2, F2, R2 > & x ):
+      raw_value( static_cast< storage >(
+         fixed_shift< R, F2 - F >(
+            static_cast< fixed_storage<
+               ( I > I2 ? I : I2 ) + ( F > F2 ? F : F2 ) > >( x.raw() ) ) ) )
+   {}
+
+   /// the fixed with the specified raw value
+   static constexpr fixed from_raw( storage raw ){
+      return fixed( raw, raw_tag() );
+   }
+
+   /// the raw value: the value * 2^F
+   constexpr storage raw() const {
+      return raw_value;
+   }
+
+   /// the value, rounded to an integer as specified by R
+   constexpr storage integer() const {
+      return static_cast< storage >(
+         fixed_shift< R, F >( static_cast< wide >( raw_value ) ) );
+   }
+
+   /// the value as floating point value
+   constexpr explicit operator double() const {
+      return raw_value / (double) one;
+   }
+
+   /// update add
+   constexpr fixed & operator+=( const fixed & right ){
+      raw_value = static_cast< storage >( raw_value + right.raw_value );
+      return *this;
+   }
+
+   /// update subtract
+   constexpr fixed & operator-=( const fixed & right ){
+      raw_value = static_cast< storage >( raw_value - right.raw_value );
+      return *this;
+   }
+
+   /// plus
+   friend constexpr fixed operator+( const fixed & x ){
+      return x;
+   }
+
+   /// negate
+   friend constexpr fixed operator-( const fixed & x ){
+      return from_raw( static_cast< storage >( - x.raw_value ) );
+   }
+
+   /// add
+   friend constexpr fixed operator+( fixed left, const fixed & right ){
+      return left += right;
+   }
+
+   /// subtract
+   friend constexpr fixed operator-( fixed left, const fixed & right ){
+      return left -= right;
+   }
+
+   /// multiply, rounded as specified by R
+   friend constexpr fixed operator*( const fixed & left, const fixed & right ){
+      return from_raw( static_cast< storage >( fixed_shift< R, F >(
+         static_cast< wide >( left.raw_value ) * right.raw_value ) ) );
+   }
+
+   /// multiply by an integer (which is exact)
+   template< typename N >
+   ///@cond INTERNAL
+   requires std::is_integral_v< N >
+   ///@endcond
+   friend constexpr fixed operator*( const fixed & left, N right ){
+      return from_raw( static_cast< storage >( left.raw_value * right ) );
+   }
+
+   /// multiply an integer (which is exact)
+   template< typename N >
+   ///@cond INTERNAL
+   requires std::is_integral_v< N >
+   ///@endcond
+   friend constexpr fixed operator*( N left, const fixed & right ){
+      return right * left;
+   }
+
+   /// divide, truncated towards zero
+   friend constexpr fixed operator/( const fixed & left, const fixed & right ){
+      return from_raw( static_cast< storage >(
+         ( left.raw_value * one ) / right.raw_value ) );
+   }
+
+   /// divide by an integer, truncated towards zero
+   template< typename N >
+   ///@cond INTERNAL
+   requires std::is_integral_v< N >
+   ///@endcond
+   friend constexpr fixed operator/( const fixed & left, N right ){
+      return from_raw( static_cast< storage >( left.raw_value / right ) );
+   }
+
+   /// compare equal
+   friend constexpr bool operator==( const fixed & left, const fixed & right ){
+      return left.raw_value == right.raw_value;
+   }
+
+   /// compare unequal
+   friend constexpr bool operator!=( const fixed & left, const fixed & right ){
+      return left.raw_value != right.raw_value;
+   }
+
+   /// compare smaller
+   friend constexpr bool operator<( const fixed & left, const fixed & right ){
+      return left.raw_value < right.raw_value;
+   }
+
+   /// compare smaller or equal
+   friend constexpr bool operator<=( const fixed & left, const fixed & right ){
+      return left.raw_value <= right.raw_value;
+   }
+
+   /// compare larger
+   friend constexpr bool operator>( const fixed & left, const fixed & right ){
+      return left.raw_value > right.raw_value;
+   }
+
+   /// compare larger or equal
+   friend constexpr bool operator>=( const fixed & left, const fixed & right ){
+      return left.raw_value >= right.raw_value;
+   }
+
+private:
+
+   // d (the raw value as floating point value) rounded as specified
+   static constexpr storage round( double d ){
+      if constexpr ( R == fixed_rounding::nearest ){
+         d += 0.5;
+      }
+
+      // the conversion truncates, which is too high for a negative d
+      const fixed_widest t = static_cast< fixed_widest >( d );
+      if constexpr ( R == fixed_rounding::truncate ){
+         return static_cast< storage >( t );
+      } else {
+         return static_cast< storage >( ( t > d ) ? t - 1 : t );
+      }
+   }
+
+}; // template class fixed
+
+
+// ==========================================================================
+//
+// widening multiply
+//
+// ==========================================================================
+
+/// the exact product of two fixed values
+///
+/// The product has the sum of the integer bits and of the
+/// fraction bits of the operands, and the rounding mode of the
+/// left operand. This is a single multiplication, in the
+/// storage type of the product.
+template< int I1, int F1, fixed_rounding R1, int I2, int F2, fixed_rounding R2 >
+constexpr fixed< I1 + I2, F1 + F2, R1 > widening_multiply(
+   const fixed< I1, F1, R1 > & left, const fixed< I2, F2, R2 > & right
+){
+   using product = fixed< I1 + I2, F1 + F2, R1 >;
+   return product::from_raw(
+      static_cast< typename product::storage >( left.raw() ) * right.raw() );
+}
+
+#endif // ifndef torsor_fixed_hpp
@@ -0,0 +1,333 @@
+// ==========================================================================
+//
+// torsor-gcra.hpp
+//
+// lock-free rate limiting with the Generic Cell Rate Algorithm:
+// a per-key torsor (the theoretical arrival time), updated with a CAS
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_gcra_hpp
+#define torsor_gcra_hpp
+
+/// @file
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "torsor.hpp"
+
+// The Generic Cell Rate Algorithm (GCRA, the 'virtual scheduling'
+// form of a leaky bucket) limits the rate of requests for a key to one
+// per emission interval, with bursts of up to a number of requests.
+// Its only state is the theoretical arrival time (TAT): the moment
+// at which the next request would be exactly on schedule.
+// A request at now is admitted when
+//
+//    max( TAT, now ) + interval - now <= tolerance + interval
+//
+// and then the TAT becomes max( TAT, now ) + interval.
+// (For a request of n cells, interval is n * interval in the left
+// hand side and the update.) The tolerance is ( burst - 1 ) * interval.
+// There are no tokens to refill, so no background thread is needed:
+// the TAT of an idle key simply falls behind now.
+//
+// The TAT is a torsor (a moment), the interval and the tolerance are
+// its base type (durations):
+//
+//    struct ns_tag {};
+//    using moment = torsor< std::int64_t, ns_tag >;
+//
+//    gcra_limit< std::int64_t > limit( 1'000'000, 10 ); // 1000/s, burst 10
+//    gcra_cell< std::int64_t, ns_tag > cell;
+//
+//    if( cell.admit( limit, now ) ){ ... }
+//
+// A gcra_cell holds the TAT in a std::atomic< torsor< T, M > >,
+// and admit() is a load and a compare-and-swap (retried when another
+// thread changed the TAT in between): lock-free, no mutex.
+//
+// A gcra_table holds the cells of many keys (64-bit key values, for
+// instance a hash of a user name or an address), all with the
+// same limit. It is split into shards: a key is hashed to a shard,
+// and to a slot in that shard, and probes the next slots (up to
+// max_probe) for its key or a free slot. A free slot is claimed with
+// a compare-and-swap of the key, so the table is lock-free too.
+// Slots are never freed (the TAT of an idle key is harmless):
+// when no slot is found, the key shares an overflow cell with the
+// other keys that overflowed in that shard, which limits them
+// together (so more strictly than each by itself). The table should
+// be made large enough for the number of active keys, and can be
+// cleared (when no other thread uses it) to drop the idle keys.
+
+
+// ==========================================================================
+//
+// limit
+//
+// ==========================================================================
+
+/// the parameters of a GCRA limit with intervals of type T
+template< typename T >
+struct gcra_limit {
+
+   /// the emission interval: one request per interval
+   T interval;
+
+   /// the burst tolerance: ( burst - 1 ) * interval
+   T tolerance;
+
+   /// one request per interval, with bursts of up to burst requests
+   constexpr gcra_limit( const T & interval, unsigned int burst = 1 ):
+      interval( interval ),
+      tolerance( interval * static_cast< int >( burst > 0 ? burst - 1 : 0 ) )
+   {}
+};
+
+
+// ==========================================================================
+//
+// cell
+//
+// ==========================================================================
+
+/// the GCRA state of one key: its theoretical arrival time
+template< typename T, typename M = void >
+class gcra_cell final {
+public:
+
+   /// the moments
+   using moment = torsor< T, M >;
+
+private:
+
+   std::atomic< moment > tat;
+
+public:
+
+   /// a cell with the TAT at start (a new key has no history)
+   explicit gcra_cell( const moment & start = moment() ): tat( start ){}
+
+   gcra_cell( const gcra_cell & ) = delete;
+   gcra_cell & operator=( const gcra_cell & ) = delete;
+
+   /// whether a request of n cells at now is admitted
+   ///
+   /// When it is, the TAT is advanced by n intervals.
+   bool admit(
+      const gcra_limit< T > & limit, const moment & now, unsigned int n = 1
+   ){
+      const T cost = limit.interval * static_cast< int >( n );
+      const T allowed = limit.tolerance + limit.interval;
+      moment t = tat.load( std::memory_order_relaxed );
+      for(;;){
+         const moment next = ( ( t < now ) ? now : t ) + cost;
+         if( next - now > allowed ){
+            return false;
+         }
+         if( tat.compare_exchange_weak( t, next, std::memory_order_relaxed ) ){
+            return true;
+         }
+      }
+   }
+
+   /// the time until a request of n cells will be admitted
+   /// (zero when it would be admitted now)
+   ///
+   /// This doesn't change the TAT.
+   T delay(
+      const gcra_limit< T > & limit, const moment & now, unsigned int n = 1
+   ) const {
+      const moment t = tat.load( std::memory_order_relaxed );
+      const moment next = ( ( t < now ) ? now : t )
+         + limit.interval * static_cast< int >( n );
+      const T d = ( next - now ) - ( limit.tolerance + limit.interval );
+      return ( d > T() ) ? d : T();
+   }
+
+   /// the theoretical arrival time
+   moment arrival() const { return tat.load( std::memory_order_relaxed ); }
+
+   /// set the TAT (for instance to forget the history)
+   void reset( const moment & t = moment() ){
+      tat.store( t, std::memory_order_relaxed );
+   }
+
+}; // template class gcra_cell
+
+
+// ==========================================================================
+//
+// table
+//
+// ==========================================================================
+
+/// GCRA cells for many 64-bit keys, with the same limit
+///
+/// The key value ~0 (all ones) is reserved: it marks a free slot.
+template< typename T, typename M = void >
+class gcra_table final {
+public:
+
+   /// the moments
+   using moment = torsor< T, M >;
+
+   /// the longest probe sequence for a key
+   static constexpr std::size_t max_probe = 16;
+
+private:
+
+   static constexpr std::uint64_t free_key = ~std::uint64_t( 0 );
+
+   struct slot {
+      std::atomic< std::uint64_t > key{ free_key };
+      gcra_cell< T, M > cell;
+   };
+
+   gcra_limit< T > limit_;
+   std::size_t shard_bits;
+   std::size_t slot_bits;
+   std::unique_ptr< slot[] > slots;
+   std::unique_ptr< gcra_cell< T, M >[] > overflow;
+
+   // a (bijective) mix of the bits of a key
+   static std::uint64_t hash( std::uint64_t x ){
+      x ^= x >> 30;
+      x *= 0xbf58'476d'1ce4'e5b9ULL;
+      x ^= x >> 27;
+      x *= 0x94d0'49bb'1331'11ebULL;
+      return x ^ ( x >> 31 );
+   }
+
+   static std::size_t log2_ceil( std::size_t n ){
+      std::size_t b = 0;
+      while( ( std::size_t( 1 ) << b ) < n ){
+         ++b;
+      }
+      return b;
+   }
+
+   // the first slot to probe for a key with hash h
+   std::size_t first_slot( std::uint64_t h ) const {
+      const std::size_t shard = ( shard_bits == 0 ) ? 0 : h >> ( 64 - shard_bits );
+      return ( shard << slot_bits ) | ( h & ( ( std::size_t( 1 ) << slot_bits ) - 1 ) );
+   }
+
+   // the cell of key, probing from slot s
+   gcra_cell< T, M > & cell( std::uint64_t key, std::size_t s ){
+      const std::size_t shard = s >> slot_bits;
+      const std::size_t mask = ( std::size_t( 1 ) << slot_bits ) - 1;
+      const std::size_t probes =
+         ( max_probe < mask + 1 ) ? max_probe : mask + 1;
+      for( std::size_t i = 0; i < probes; ++i ){
+         slot & x = slots[ ( shard << slot_bits ) | ( ( s + i ) & mask ) ];
+         std::uint64_t k = x.key.load( std::memory_order_acquire );
+         if( k == free_key ){
+            // claim it, unless another thread claimed it first
+            if( x.key.compare_exchange_strong( k, key,
+               std::memory_order_acq_rel, std::memory_order_acquire )
+            ){
+               return x.cell;
+            }
+         }
+         if( k == key ){
+            return x.cell;
+         }
+      }
+      return overflow[ shard ];
+   }
+
+public:
+
+   /// a table with room for (at least) capacity keys, in shards
+   ///
+   /// The capacity and the number of shards are rounded up
+   /// to powers of 2. Keep the capacity well above the number
+   /// of active keys (for instance twice as many), so the
+   /// probe sequences stay short.
+   gcra_table(
+      const gcra_limit< T > & limit,
+      std::size_t capacity, std::size_t shards = 64
+   ):
+      limit_( limit ),
+      shard_bits( log2_ceil( shards ) ),
+      slot_bits( 0 )
+   {
+      const std::size_t total_bits = log2_ceil( capacity );
+      slot_bits = ( total_bits > shard_bits ) ? total_bits - shard_bits : 0;
+      slots.reset( new slot[ std::size_t( 1 ) << ( shard_bits + slot_bits ) ] );
+      overflow.reset( new gcra_cell< T, M >[ std::size_t( 1 ) << shard_bits ] );
+   }
+
+   /// the limit
+   const gcra_limit< T > & limit() const { return limit_; }
+
+   /// the number of slots
+   std::size_t capacity() const {
+      return std::size_t( 1 ) << ( shard_bits + slot_bits );
+   }
+
+   /// the cell of a key
+   gcra_cell< T, M > & cell( std::uint64_t key ){
+      return cell( key, first_slot( hash( key ) ) );
+   }
+
+   /// whether a request of n cells for key at now is admitted
+   bool admit( std::uint64_t key, const moment & now, unsigned int n = 1 ){
+      return cell( key ).admit( limit_, now, n );
+   }
+
+   /// admit requests (of one cell) for n keys at now
+   ///
+   /// Each admitted[ i ] is set to whether the request for keys[ i ]
+   /// is admitted, the result is the number of admitted requests.
+   /// The slots of a group of keys are prefetched before they
+   /// are used, so the cache misses of the group overlap.
+   std::size_t admit(
+      const std::uint64_t * keys, bool * admitted, std::size_t n,
+      const moment & now
+   ){
+      constexpr std::size_t group = 16;
+      std::size_t first[ group ];
+      std::size_t count = 0;
+      for( std::size_t i = 0; i < n; i += group ){
+         const std::size_t size = ( n - i < group ) ? n - i : group;
+         for( std::size_t j = 0; j < size; ++j ){
+            first[ j ] = first_slot( hash( keys[ i + j ] ) );
+            #if defined( __GNUC__ )
+               __builtin_prefetch( & slots[ first[ j ] ], 1 );
+            #endif
+         }
+         for( std::size_t j = 0; j < size; ++j ){
+            const bool a = cell( keys[ i + j ], first[ j ] ).admit( limit_, now );
+            admitted[ i + j ] = a;
+            count += a;
+         }
+      }
+      return count;
+   }
+
+   /// forget all keys
+   ///
+   /// No other thread may use the table during a clear().
+   void clear(){
+      for( std::size_t i = 0; i < capacity(); ++i ){
+         slots[ i ].key.store( free_key, std::memory_order_relaxed );
+         slots[ i ].cell.reset();
+      }
+      for( std::size_t i = 0; i < ( std::size_t( 1 ) << shard_bits ); ++i ){
+         overflow[ i ].reset();
+      }
+   }
+
+}; // template class gcra_table
+
+#endif // ifndef torsor_gcra_hpp
@@ -0,0 +1,429 @@
+// ==========================================================================
+//
+// torsor-iso8601.hpp
+//
+// bulk parsing and formatting between ISO-8601 / RFC-3339 text
+// and torsors of nanoseconds since 1970-01-01T00:00:00Z
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_iso8601_hpp
+#define torsor_iso8601_hpp
+
+/// @file
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include "torsor.hpp"
+
+// The moments are torsor< T, M >, where T is std::chrono::nanoseconds
+// or an integer count of nanoseconds, since 1970-01-01T00:00:00Z:
+//
+//    struct utc_tag {};
+//    using utc = torsor< std::chrono::nanoseconds, utc_tag >;
+//
+//    utc t;
+//    if( iso8601_parse( "2026-10-19T12:34:56.123456789Z", t )
+//       == iso8601_error::none ){ ... }
+//
+//    char s[ 30 ];
+//    iso8601_format( t, s );  // 2026-10-19T12:34:56.123456789Z
+//
+// The accepted text is the RFC 3339 date-time:
+//
+//    YYYY-MM-DD T hh:mm:ss [ .f... ] ( Z | +hh:mm | -hh:mm )
+//
+// with 1 .. 9 fraction digits, T, t or a space between the date and
+// the time, and Z or z. Second 60 (a leap second) is accepted,
+// and is the same moment as second 0 of the next minute.
+// The moment must fit in an int64_t count of nanoseconds
+// (from 1677-09-21 to 2262-04-11).
+//
+// The bulk functions allocate nothing, and report an error for each
+// element. The fixed positions (the first 19 characters, and 8 of
+// the fraction digits) are checked and converted 8 characters at a
+// time in an uint64_t (SWAR: SIMD within a register): one check
+// for all digits and separators, a few multiplications for
+// the 8 fraction digits. The checks are combined into one result
+// per element, without a branch for each check.
+// Days are converted to and from civil dates with the branchless
+// algorithms of Howard Hinnant (chrono-Compatible Low-Level
+// Date Algorithms).
+// Formatting writes two digits at a time from a table.
+
+
+// ==========================================================================
+//
+// errors
+//
+// ==========================================================================
+
+/// the result of parsing a date-time
+enum class iso8601_error : std::uint8_t {
+
+   /// no error
+   none,
+
+   /// not the RFC 3339 date-time syntax
+   syntax,
+
+   /// a field is out of its range (for instance month 13 or
+   /// February 30), or the moment doesn't fit in an int64_t
+   /// count of nanoseconds
+   range
+};
+
+
+// ==========================================================================
+//
+// helpers
+//
+// ==========================================================================
+
+///@cond INTERNAL
+
+namespace iso8601_detail {
+
+// the 8 characters at p, the first one in the lowest byte
+inline std::uint64_t load8( const char * p ){
+   std::uint64_t v = 0;
+   for( int i = 0; i < 8; ++i ){
+      v |= std::uint64_t( static_cast< unsigned char >( p[ i ] ) ) << ( 8 * i );
+   }
+   return v;
+}
+
+// the bytes of x selected by mask that are not a decimal digit,
+// and the bytes selected by separators that differ from pattern
+constexpr std::uint64_t check8(
+   std::uint64_t x, std::uint64_t digits,
+   std::uint64_t separators, std::uint64_t pattern
+){
+   const std::uint64_t high = 0xF0F0'F0F0'F0F0'F0F0;
+   const std::uint64_t threes = 0x3030'3030'3030'3030;
+   return ( ( ( x & high ) ^ threes ) & digits )
+      | ( ( ( ( x + 0x0606'0606'0606'0606 ) & high ) ^ threes ) & digits )
+      | ( ( x ^ pattern ) & separators );
+}
+
+// the value of 8 decimal digits, the first one in the lowest byte
+constexpr std::uint32_t value8( std::uint64_t x ){
+   x -= 0x3030'3030'3030'3030;
+   x = ( x * 10 ) + ( x >> 8 );
+   x = ( ( ( x & 0x0000'00FF'0000'00FF ) * ( 100 + ( 1'000'000ULL << 32 ) ) )
+      + ( ( ( x >> 16 ) & 0x0000'00FF'0000'00FF ) * ( 1 + ( 10'000ULL << 32 ) ) ) )
+      >> 32;
+   return static_cast< std::uint32_t >( x );
+}
+
+constexpr int digit( char c ){
+   return c - '0';
+}
+
+constexpr int two( const char * p ){
+   return 10 * digit( p[ 0 ] ) + digit( p[ 1 ] );
+}
+
+constexpr bool is_digit( char c ){
+   return static_cast< unsigned char >( c - '0' ) < 10;
+}
+
+// days since 1970-01-01 of a date
+constexpr std::int64_t days_from_civil( int y, int m, int d ){
+   y -= m <= 2;
+   const int era = ( y >= 0 ? y : y - 399 ) / 400;
+   const int yoe = y - era * 400;
+   const int doy = ( 153 * ( m + ( m > 2 ? -3 : 9 ) ) + 2 ) / 5 + d - 1;
+   const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+   return std::int64_t( era ) * 146'097 + doe - 719'468;
+}
+
+struct civil {
+   int y, m, d;
+};
+
+// the date of a day since 1970-01-01
+constexpr civil civil_from_days( std::int64_t z ){
+   z += 719'468;
+   const std::int64_t era = ( z >= 0 ? z : z - 146'096 ) / 146'097;
+   const int doe = static_cast< int >( z - era * 146'097 );
+   const int yoe = ( doe - doe / 1460 + doe / 36'524 - doe / 146'096 ) / 365;
+   const int doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+   const int mp = ( 5 * doy + 2 ) / 153;
+   const int d = doy - ( 153 * mp + 2 ) / 5 + 1;
+   const int m = mp < 10 ? mp + 3 : mp - 9;
+   return civil{ static_cast< int >( yoe + era * 400 ) + ( m <= 2 ), m, d };
+}
+
+constexpr int days_in_month( int y, int m ){
+   constexpr unsigned char days[] = {
+      0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+   const bool leap = ( y % 4 == 0 ) & ( ( y % 100 != 0 ) | ( y % 400 == 0 ) );
+   return days[ m ] + ( ( m == 2 ) & leap );
+}
+
+inline constexpr std::int64_t scale[] = {
+   1'000'000'000, 100'000'000, 10'000'000, 1'000'000, 100'000,
+   10'000, 1'000, 100, 10, 1 };
+
+inline constexpr char pairs[] =
+   "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+   "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+   "8081828384858687888990919293949596979899";
+
+inline void write2( char * p, unsigned int v ){
+   p[ 0 ] = pairs[ 2 * v ];
+   p[ 1 ] = pairs[ 2 * v + 1 ];
+}
+
+template< typename T >
+constexpr std::int64_t to_ns( const T & v ){
+   if constexpr ( std::is_integral_v< T > ){
+      return v;
+   } else {
+      return v.count();
+   }
+}
+
+template< typename T >
+constexpr T from_ns( std::int64_t ns ){
+   return T( ns );
+}
+
+template< typename T >
+constexpr bool is_ns =
+   std::is_same_v< T, std::chrono::nanoseconds >
+   || ( std::is_integral_v< T > && sizeof( T ) == 8 && std::is_signed_v< T > );
+
+// the number of fraction digits, clamped to 0 .. 9
+constexpr int fraction_digits( int digits ){
+   return ( digits < 0 ) ? 0 : ( digits > 9 ) ? 9 : digits;
+}
+
+} // namespace iso8601_detail
+
+///@endcond
+
+
+// ==========================================================================
+//
+// parse
+//
+// ==========================================================================
+
+/// parse an RFC 3339 date-time
+///
+/// When the result is iso8601_error::none, t is set to the moment,
+/// else t is set to the zero moment (1970-01-01T00:00:00Z).
+template< typename T, typename M >
+iso8601_error iso8601_parse( std::string_view s, torsor< T, M > & t ){
+   using namespace iso8601_detail;
+   static_assert( is_ns< T >,
+      "the base type must be std::chrono::nanoseconds "
+      "or an int64_t count of nanoseconds" );
+
+   t = torsor< T, M >();
+   const std::size_t n = s.size();
+   if( n < 20 || n > 35 ){
+      return iso8601_error::syntax;
+   }
+   const char * p = s.data();
+
+   // YYYY-MM-DDThh:mm:ss, 8 characters at a time
+   std::uint64_t bad = check8( load8( p ),
+      0x00FF'FF00'FFFF'FFFF, 0xFF00'00FF'0000'0000, 0x2D00'002D'0000'0000 );
+   bad |= check8( load8( p + 8 ) & 0xFFFF, 0xFFFF, 0, 0 );
+   bad |= check8( load8( p + 11 ),
+      0xFFFF'00FF'FF00'FFFF, 0x0000'FF00'00FF'0000, 0x0000'3A00'003A'0000 );
+   const char sep = p[ 10 ];
+   bad |= ! ( ( ( sep | 0x20 ) == 't' ) | ( sep == ' ' ) );
+
+   // the zone: Z, or an offset
+   const char last = p[ n - 1 ];
+   const bool zulu = ( last | 0x20 ) == 'z';
+   const std::size_t zone = n - ( zulu ? 1 : 6 );
+   int offset = 0;
+   bool offset_ok = true;
+   if( ! zulu ){
+      const char * z = p + zone;
+      bad |= ! ( ( ( z[ 0 ] == '+' ) | ( z[ 0 ] == '-' ) ) & ( z[ 3 ] == ':' )
+         & is_digit( z[ 1 ] ) & is_digit( z[ 2 ] )
+         & is_digit( z[ 4 ] ) & is_digit( z[ 5 ] ) );
+      const int oh = two( z + 1 ), om = two( z + 4 );
+      bad |= ( zone < 19 );
+      offset_ok = ( oh <= 23 ) & ( om <= 59 );
+      offset = ( z[ 0 ] == '-' ? -1 : 1 ) * ( oh * 3600 + om * 60 );
+   }
+
+   // the fraction: nothing, or a . and 1 .. 9 digits
+   std::int64_t fraction = 0;
+   if( zone > 19 ){
+      const std::size_t k = zone - 20;
+      bad |= ( p[ 19 ] != '.' ) | ( k == 0 ) | ( k > 9 );
+      if( k == 9 ){
+         bad |= check8( load8( p + 20 ), ~0ULL, 0, 0 );
+         bad |= ! is_digit( p[ 28 ] );
+         fraction = std::int64_t( value8( load8( p + 20 ) ) ) * 10
+            + digit( p[ 28 ] );
+      } else if( k < 9 ){
+         for( std::size_t i = 0; i < k; ++i ){
+            bad |= ! is_digit( p[ 20 + i ] );
+            fraction = 10 * fraction + digit( p[ 20 + i ] );
+         }
+         fraction *= scale[ k ];
+      }
+   }
+
+   if( bad != 0 ){
+      return iso8601_error::syntax;
+   }
+
+   const int y = 100 * two( p ) + two( p + 2 );
+   const int mo = two( p + 5 ), d = two( p + 8 );
+   const int h = two( p + 11 ), mi = two( p + 14 ), sec = two( p + 17 );
+   const bool range_ok = offset_ok
+      & ( mo >= 1 ) & ( mo <= 12 ) & ( d >= 1 )
+      & ( d <= days_in_month( y, ( mo >= 1 ) & ( mo <= 12 ) ? mo : 1 ) )
+      & ( h <= 23 ) & ( mi <= 59 ) & ( sec <= 60 );
+
+   const std::int64_t seconds = days_from_civil( y, mo, d ) * 86'400
+      + h * 3600 + mi * 60 + sec - offset;
+
+   // in the range of an int64_t count of nanoseconds
+   const bool fits =
+      ( ( seconds < 9'223'372'036 )
+         | ( ( seconds == 9'223'372'036 ) & ( fraction <= 854'775'807 ) ) )
+      & ( ( seconds > -9'223'372'037 )
+         | ( ( seconds == -9'223'372'037 ) & ( fraction >= 145'224'192 ) ) );
+
+   if( ! ( range_ok & fits ) ){
+      return iso8601_error::range;
+   }
+   t = torsor< T, M >() + from_ns< T >( seconds * 1'000'000'000 + fraction );
+   return iso8601_error::none;
+}
+
+/// parse n RFC 3339 date-times
+///
+/// For each in[ i ], errors[ i ] is set to the result of parsing it,
+/// and out[ i ] to the moment (or the zero moment for an error).
+/// The result is the number of errors.
+template< typename T, typename M >
+std::size_t iso8601_parse(
+   const std::string_view * in, torsor< T, M > * out,
+   iso8601_error * errors, std::size_t n
+){
+   std::size_t n_errors = 0;
+   for( std::size_t i = 0; i < n; ++i ){
+      errors[ i ] = iso8601_parse( in[ i ], out[ i ] );
+      n_errors += ( errors[ i ] != iso8601_error::none );
+   }
+   return n_errors;
+}
+
+
+// ==========================================================================
+//
+// format
+//
+// ==========================================================================
+
+/// the length of a formatted date-time with digits fraction digits
+///
+/// The digits are clamped to 0 .. 9, like in iso8601_format().
+constexpr std::size_t iso8601_length( int digits = 9 ){
+   digits = iso8601_detail::fraction_digits( digits );
+   return digits == 0 ? 20 : 21 + digits;
+}
+
+/// format a moment as RFC 3339 date-time in UTC
+///
+/// The text is YYYY-MM-DDThh:mm:ss.fffffffffZ, with digits (0 .. 9)
+/// fraction digits (the moment is truncated to those), and without
+/// the . for 0 digits. Digits outside 0 .. 9 are clamped to that range.
+/// It is iso8601_length( digits ) characters,
+/// without a terminating 0. The result is that length.
+template< typename T, typename M >
+std::size_t iso8601_format(
+   const torsor< T, M > & t, char * out, int digits = 9
+){
+   using namespace iso8601_detail;
+   static_assert( is_ns< T >,
+      "the base type must be std::chrono::nanoseconds "
+      "or an int64_t count of nanoseconds" );
+
+   digits = fraction_digits( digits );
+   const std::int64_t ns = to_ns( t - torsor< T, M >() );
+
+   // floor divisions
+   std::int64_t seconds = ns / 1'000'000'000;
+   std::int64_t fraction = ns % 1'000'000'000;
+   seconds -= ( fraction < 0 );
+   fraction += ( fraction < 0 ) ? 1'000'000'000 : 0;
+   std::int64_t days = seconds / 86'400;
+   int second_of_day = static_cast< int >( seconds % 86'400 );
+   days -= ( second_of_day < 0 );
+   second_of_day += ( second_of_day < 0 ) ? 86'400 : 0;
+
+   const civil c = civil_from_days( days );
+   write2( out, c.y / 100 );
+   write2( out + 2, c.y % 100 );
+   out[ 4 ] = '-';
+   write2( out + 5, c.m );
+   out[ 7 ] = '-';
+   write2( out + 8, c.d );
+   out[ 10 ] = 'T';
+   write2( out + 11, second_of_day / 3600 );
+   out[ 13 ] = ':';
+   write2( out + 14, second_of_day / 60 % 60 );
+   out[ 16 ] = ':';
+   write2( out + 17, second_of_day % 60 );
+
+   if( digits == 0 ){
+      out[ 19 ] = 'Z';
+      return 20;
+   }
+
+   // all 9 digits in a buffer, the first digits of them to out
+   char f[ 10 ];
+   const unsigned int high = static_cast< unsigned int >( fraction / 100'000 );
+   const unsigned int low = static_cast< unsigned int >( fraction % 100'000 );
+   f[ 0 ] = static_cast< char >( '0' + high / 1000 );
+   write2( f + 1, high / 10 % 100 );
+   f[ 3 ] = static_cast< char >( '0' + high % 10 );
+   write2( f + 4, low / 1000 );
+   write2( f + 6, low / 10 % 100 );
+   f[ 8 ] = static_cast< char >( '0' + low % 10 );
+   out[ 19 ] = '.';
+   for( int i = 0; i < digits; ++i ){
+      out[ 20 + i ] = f[ i ];
+   }
+   out[ 20 + digits ] = 'Z';
+   return 21 + digits;
+}
+
+/// format n moments as RFC 3339 date-times in UTC
+///
+/// Each moment is formatted as by iso8601_format( in[ i ], ..., digits ),
+/// to the iso8601_length( digits ) characters at out + i * that length.
+template< typename T, typename M >
+void iso8601_format(
+   const torsor< T, M > * in, char * out, std::size_t n, int digits = 9
+){
+   const std::size_t length = iso8601_length( digits );
+   for( std::size_t i = 0; i < n; ++i ){
+      iso8601_format( in[ i ], out + i * length, digits );
+   }
+}
+
+#endif // ifndef torsor_iso8601_hpp
@@ -0,0 +1,337 @@
+// ==========================================================================
+//
+// torsor-merge.hpp
+//
+// k-way merge of sorted torsor-keyed ranges with a loser tree,
+// one record at a time, in batches, or in parallel
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_merge_hpp
+#define torsor_merge_hpp
+
+/// @file
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "torsor.hpp"
+
+// The merge takes k ranges of records, each sorted in non-decreasing
+// order of a torsor key, for instance the per-shard streams of events:
+//
+//    struct event { torsor< std::int64_t, ns_tag > time; int what; };
+//    auto time = []( const event & e ){ return e.time; };
+//
+//    std::vector< merge_range< event > > ranges;
+//    for( auto & s : shards ){
+//       ranges.push_back( { s.data(), s.data() + s.size() } );
+//    }
+//    merge_sorted( ranges.data(), ranges.size(), out.data(), 1, time );
+//
+// The key of a record is given by a function object. By default that
+// is merge_identity, for ranges of torsors themselves.
+// Records with equal keys are taken from the ranges in the order of
+// the ranges (the merge is stable).
+//
+// A loser tree (a tournament tree) holds the current record of each
+// range at its leaves, and in each node above them the loser of the
+// match between the winners of its two subtrees. The winner of the
+// whole tournament is the next record. When it is taken, the next
+// record of its range replays only the matches on the path from its
+// leaf to the root: log2( k ) comparisons, each against a loser
+// that is stored in the node (with its key, so without an indirection).
+// A binary heap (std::priority_queue) needs about 2 * log2( k )
+// comparisons for a pop and a push, on a path that depends on
+// the comparisons, so it is harder to predict.
+//
+// The next() of a loser_tree writes a batch of records to an array.
+// merge_sorted() with threads > 1 splits the key space at torsor
+// pivots (chosen from samples of the ranges), so each range is split
+// at the same moments by binary searches. Each thread merges the
+// records of one part of the key space (with its own loser tree)
+// to its own part of the output. The result is the same as with
+// one thread.
+
+
+// ==========================================================================
+//
+// ranges and keys
+//
+// ==========================================================================
+
+/// a sorted range of records [ first, last )
+template< typename R >
+struct merge_range {
+
+   /// the first record
+   const R * first;
+
+   /// just after the last record
+   const R * last;
+
+   /// the number of records
+   std::size_t size() const { return last - first; }
+};
+
+/// the key of a torsor is the torsor itself
+struct merge_identity {
+
+   /// the torsor
+   template< typename T, typename M >
+   constexpr const torsor< T, M > & operator()(
+      const torsor< T, M > & t
+   ) const {
+      return t;
+   }
+};
+
+
+// ==========================================================================
+//
+// loser tree
+//
+// ==========================================================================
+
+/// a k-way merge of sorted ranges of records R, with the key function K
+template< typename R, typename K = merge_identity >
+class loser_tree final {
+public:
+
+   /// the type of the keys (a torsor)
+   using key_type = std::decay_t< std::invoke_result_t< K, const R & > >;
+
+private:
+
+   // a leaf (range) and its key; rank is the index of the range,
+   // plus the (padded) number of leaves when the range is exhausted:
+   // then its key is the highest key of all ranges, so it is
+   // taken after all records without a check for exhaustion
+   struct node {
+      key_type key;
+      std::uint32_t rank;
+   };
+
+   K key_;
+   std::uint32_t leaves;
+   std::vector< const R * > heads;
+   std::vector< const R * > ends;
+   std::vector< node > losers;
+   node winner;
+   key_type last_key;
+
+   // whether a is taken before b: the lower key,
+   // of equal keys the one of the lower range
+   static bool beats( const node & a, const node & b ){
+      return ( a.key < b.key ) | ( ( a.key == b.key ) & ( a.rank < b.rank ) );
+   }
+
+   // the node for the current record of range i
+   node leaf( std::uint32_t i ) const {
+      return ( heads[ i ] != ends[ i ] )
+         ? node{ key_( *heads[ i ] ), i }
+         : node{ last_key, i + leaves };
+   }
+
+public:
+
+   /// a merge of the k ranges
+   ///
+   /// The records are not copied: the ranges must stay valid
+   /// while the merge is used.
+   loser_tree(
+      const merge_range< R > * ranges, std::size_t k, K key = K()
+   ):
+      key_( key ),
+      leaves( 1 )
+   {
+      while( leaves < k ){
+         leaves *= 2;
+      }
+      heads.resize( leaves, nullptr );
+      ends.resize( leaves, nullptr );
+      for( std::size_t i = 0; i < k; ++i ){
+         heads[ i ] = ranges[ i ].first;
+         ends[ i ] = ranges[ i ].last;
+      }
+      last_key = key_type();
+      bool any = false;
+      for( std::size_t i = 0; i < k; ++i ){
+         if( ranges[ i ].first != ranges[ i ].last ){
+            const key_type t = key_( *( ranges[ i ].last - 1 ) );
+            last_key = ( any && t < last_key ) ? last_key : t;
+            any = true;
+         }
+      }
+
+      // play the tournament: the winners of the matches
+      // go up, the losers stay in the nodes
+      std::vector< node > winners( 2 * leaves );
+      for( std::uint32_t i = 0; i < leaves; ++i ){
+         winners[ leaves + i ] = leaf( i );
+      }
+      losers.resize( leaves );
+      for( std::uint32_t n = leaves - 1; n > 0; --n ){
+         const node & a = winners[ 2 * n ];
+         const node & b = winners[ 2 * n + 1 ];
+         const bool a_wins = beats( a, b );
+         losers[ n ] = a_wins ? b : a;
+         winners[ n ] = a_wins ? a : b;
+      }
+      winner = winners[ 1 ];
+   }
+
+   /// whether all records have been taken
+   bool empty() const { return winner.rank >= leaves; }
+
+   /// the next record
+   ///
+   /// The merge must not be empty.
+   const R & top() const { return *heads[ winner.rank ]; }
+
+   /// the index of the range of the next record
+   ///
+   /// The merge must not be empty.
+   std::size_t source() const { return winner.rank; }
+
+   /// take the next record
+   ///
+   /// The merge must not be empty.
+   void pop(){
+      const std::uint32_t i = winner.rank;
+      ++heads[ i ];
+      node x = leaf( i );
+
+      // replay the matches on the path to the root; the winner and
+      // the loser of a match are selected by indexing (not with
+      // a branch, which would be mispredicted half of the time)
+      node * const l = losers.data();
+      for( std::uint32_t n = ( i + leaves ) / 2; n > 0; n /= 2 ){
+         const node c[ 2 ] = { x, l[ n ] };
+         const bool b = beats( c[ 1 ], c[ 0 ] );
+         l[ n ] = c[ ! b ];
+         x = c[ b ];
+      }
+      winner = x;
+   }
+
+   /// take (at most) the next n records, and copy them to out
+   ///
+   /// The result is the number of records that were taken:
+   /// less than n only when the merge is then empty.
+   std::size_t next( R * out, std::size_t n ){
+      std::size_t i = 0;
+      for( ; i < n && ! empty(); ++i ){
+         out[ i ] = top();
+         pop();
+      }
+      return i;
+   }
+
+}; // template class loser_tree
+
+
+// ==========================================================================
+//
+// merge
+//
+// ==========================================================================
+
+///@cond INTERNAL
+
+// pivots for threads parts of the records, from about 64 samples
+// per part, taken at the same stride from all ranges
+template< typename R, typename K >
+std::vector< typename loser_tree< R, K >::key_type > merge_pivots(
+   const merge_range< R > * ranges, std::size_t k, std::size_t total,
+   unsigned threads, const K & key
+){
+   std::vector< typename loser_tree< R, K >::key_type > samples;
+   const std::size_t stride = std::max< std::size_t >(
+      1, total / ( 64 * std::size_t( threads ) ) );
+   for( std::size_t r = 0; r < k; ++r ){
+      for( std::size_t i = stride / 2; i < ranges[ r ].size(); i += stride ){
+         samples.push_back( key( ranges[ r ].first[ i ] ) );
+      }
+   }
+   std::sort( samples.begin(), samples.end() );
+   std::vector< typename loser_tree< R, K >::key_type > pivots;
+   for( unsigned p = 1; p < threads && ! samples.empty(); ++p ){
+      pivots.push_back( samples[ samples.size() * p / threads ] );
+   }
+   return pivots;
+}
+
+///@endcond
+
+/// merge the k sorted ranges to out, with the key function K
+///
+/// The result is the number of records, which is the sum of the sizes
+/// of the ranges: out must have room for that many records.
+/// With threads > 1, the key space is split in (at most) that many
+/// parts, which are merged by their own threads.
+template< typename R, typename K = merge_identity >
+std::size_t merge_sorted(
+   const merge_range< R > * ranges, std::size_t k, R * out,
+   unsigned threads = 1, K key = K()
+){
+   std::size_t total = 0;
+   for( std::size_t r = 0; r < k; ++r ){
+      total += ranges[ r ].size();
+   }
+   if( threads <= 1 || total < 2 * std::size_t( threads ) ){
+      loser_tree< R, K > tree( ranges, k, key );
+      return tree.next( out, total );
+   }
+
+   // the parts: part p has the records with keys from pivot p - 1
+   // up to (not including) pivot p, parts[ p * k + r ] is the part
+   // of range r
+   const auto pivots = merge_pivots( ranges, k, total, threads, key );
+   const std::size_t n_parts = pivots.size() + 1;
+   std::vector< merge_range< R > > parts( n_parts * k );
+   std::vector< std::size_t > offsets( n_parts + 1, 0 );
+   for( std::size_t r = 0; r < k; ++r ){
+      const R * first = ranges[ r ].first;
+      for( std::size_t p = 0; p < n_parts; ++p ){
+         const R * last = ( p + 1 == n_parts )
+            ? ranges[ r ].last
+            : std::lower_bound( first, ranges[ r ].last, pivots[ p ],
+               [ & key ]( const R & x, const auto & t ){ return key( x ) < t; } );
+         parts[ p * k + r ] = merge_range< R >{ first, last };
+         offsets[ p + 1 ] += last - first;
+         first = last;
+      }
+   }
+   for( std::size_t p = 0; p < n_parts; ++p ){
+      offsets[ p + 1 ] += offsets[ p ];
+   }
+
+   // the last part is merged by the calling thread
+   auto merge_part = [ & ]( std::size_t p ){
+      loser_tree< R, K > tree( parts.data() + p * k, k, key );
+      tree.next( out + offsets[ p ], offsets[ p + 1 ] - offsets[ p ] );
+   };
+   std::vector< std::thread > workers;
+   workers.reserve( n_parts - 1 );
+   for( std::size_t p = 0; p + 1 < n_parts; ++p ){
+      workers.emplace_back( merge_part, p );
+   }
+   merge_part( n_parts - 1 );
+   for( auto & w : workers ){
+      w.join();
+   }
+   return total;
+}
+
+#endif // ifndef torsor_merge_hpp
@@ -0,0 +1,590 @@
+// ==========================================================================
+//
+// torsor-offset.hpp
+//
+// relocatable (self-relative and base-relative) pointers,
+// a region of memory to allocate them in,
+// and a list and a hash map that use them
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_offset_hpp
+#define torsor_offset_hpp
+
+/// @file
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "torsor.hpp"
+
+// An address is a torsor: the difference of two addresses is an
+// (unsigned) integer, and an address plus an integer is an address,
+// but the sum of two addresses is meaningless.
+//
+// A raw pointer stores an address, so a data structure that contains
+// pointers is only valid at the address where it was built. An
+// offset_ptr stores the difference between the address it points to
+// and its own address. When a block of memory that contains both
+// is copied, mapped from a file, or mapped as shared memory at
+// another address, that difference is still the same, so a data
+// structure built with offset_ptr's can be used in place: no
+// serialization, and no pass to fix up the pointers.
+//
+//    struct node {
+//       offset_ptr< node > next;
+//       int value;
+//    };
+//
+// A based_ptr stores the difference with the start of the region
+// it points into. It is trivially copyable and can be 32 bits,
+// but it must be given that start to be dereferenced.
+//
+// An offset_region formats a block of memory (a buffer, a mapped file,
+// a shared memory segment) with a header, allocates from it
+// (a bump allocator, nothing is freed), and holds a root object:
+//
+//    offset_region r = offset_region::create( memory, size );
+//    auto list = r.make< offset_list< int > >();
+//    list->push_front( r, 42 );
+//    r.set_root( list );
+//
+//    // later, maybe in another process, at another address
+//    offset_region r( memory, size );
+//    if( r.valid() ){
+//       auto list = r.root< offset_list< int > >();
+//       ...
+//    }
+//
+// The containers offset_list and offset_hash_map allocate their
+// nodes in a region, and must themselves be in that region.
+// Their elements must not contain raw pointers (or objects that
+// allocate on the heap): only values, offset_ptr's and based_ptr's.
+// The memory is not reclaimed when elements are removed.
+//
+// Using a region from several processes at the same time
+// requires synchronization by the application.
+
+
+// ==========================================================================
+//
+// addresses
+//
+// ==========================================================================
+
+/// the tag of memory addresses
+struct memory_address_tag {};
+
+/// a memory address
+using memory_address = torsor< std::uintptr_t, memory_address_tag >;
+
+/// the address of an object
+inline memory_address address_of( const volatile void * p ){
+   return memory_address() + reinterpret_cast< std::uintptr_t >( p );
+}
+
+/// the object at an address
+template< typename V >
+V * pointer_at( const memory_address & a ){
+   return reinterpret_cast< V * >( a - memory_address() );
+}
+
+
+// ==========================================================================
+//
+// offset_ptr
+//
+// ==========================================================================
+
+/// self-relative pointer to a V
+///
+/// It stores the address it points to minus its own address.
+/// A copy (construction or assignment) points to the same object,
+/// so it stores a different offset: an offset_ptr is not trivially
+/// copyable, but copying the memory it is in (with the object it
+/// points to) gives an offset_ptr that points to the copy.
+///
+/// An offset of 1 is the nullptr. That can't be a pointer to an
+/// object (other than a char) that is properly aligned. An offset
+/// of 0 is valid: it is for instance the head of an empty circular
+/// list that points to itself.
+template< typename V >
+class offset_ptr final {
+private:
+
+   static constexpr std::ptrdiff_t null_offset = 1;
+
+   std::ptrdiff_t offset_;
+
+   void set( V * p ){
+      offset_ = ( p == nullptr )
+         ? null_offset
+         : static_cast< std::ptrdiff_t >( address_of( p ) - address_of( this ) );
+   }
+
+public:
+
+   /// the type it points to
+   using element_type = V;
+
+   /// a nullptr
+   offset_ptr(): offset_( null_offset ){}
+
+   /// a nullptr
+   offset_ptr( std::nullptr_t ): offset_( null_offset ){}
+
+   /// a pointer to *p
+   offset_ptr( V * p ){ set( p ); }
+
+   /// a pointer to the same object as p
+   offset_ptr( const offset_ptr & p ){ set( p.get() ); }
+
+   /// a pointer to the same object as p, which points to a U
+   template< typename U >
+   requires std::is_convertible_v< U *, V * >
+   offset_ptr( const offset_ptr< U > & p ){ set( p.get() ); }
+
+   /// point to the same object as p
+   offset_ptr & operator=( const offset_ptr & p ){
+      set( p.get() );
+      return *this;
+   }
+
+   /// point to *p
+   offset_ptr & operator=( V * p ){
+      set( p );
+      return *this;
+   }
+
+   /// the raw pointer
+   V * get() const {
+      return ( offset_ == null_offset )
+         ? nullptr
+         : pointer_at< V >( address_of( this )
+            + static_cast< std::uintptr_t >( offset_ ) );
+   }
+
+   /// the object it points to
+   template< typename U = V >
+   requires ( ! std::is_void_v< U > )
+   U & operator*() const { return *get(); }
+
+   /// the object it points to
+   V * operator->() const { return get(); }
+
+   /// whether it is not a nullptr
+   explicit operator bool() const { return offset_ != null_offset; }
+
+   /// the stored offset
+   std::ptrdiff_t offset() const { return offset_; }
+
+   /// whether both point to the same object
+   friend bool operator==( const offset_ptr & a, const offset_ptr & b ){
+      return a.get() == b.get();
+   }
+
+   /// whether they point to different objects
+   friend bool operator!=( const offset_ptr & a, const offset_ptr & b ){
+      return a.get() != b.get();
+   }
+
+}; // template class offset_ptr
+
+
+// ==========================================================================
+//
+// based_ptr
+//
+// ==========================================================================
+
+/// base-relative pointer to a V, stored in an O
+///
+/// It stores the address it points to minus the start (the base)
+/// of the region it points into. It is trivially copyable, so it can
+/// be copied between regions, and with an O of 32 bits it is half
+/// the size of an offset_ptr (for regions up to 4 GB).
+/// An offset of 0 is the nullptr: that is the start of the region
+/// (the header, for an offset_region).
+template< typename V, typename O = std::uint32_t >
+class based_ptr final {
+private:
+
+   static_assert( std::is_unsigned_v< O >,
+      "the offset of a based_ptr must be an unsigned integer" );
+
+   O offset_;
+
+public:
+
+   /// the type it points to
+   using element_type = V;
+
+   /// a nullptr
+   constexpr based_ptr(): offset_( 0 ){}
+
+   /// a nullptr
+   constexpr based_ptr( std::nullptr_t ): offset_( 0 ){}
+
+   /// a pointer to *p, in the region that starts at base
+   based_ptr( V * p, const memory_address & base ):
+      offset_( ( p == nullptr )
+         ? O( 0 )
+         : static_cast< O >( address_of( p ) - base ) )
+   {}
+
+   /// the raw pointer, in the region that starts at base
+   V * get( const memory_address & base ) const {
+      return ( offset_ == 0 )
+         ? nullptr
+         : pointer_at< V >( base + std::uintptr_t( offset_ ) );
+   }
+
+   /// whether it is not a nullptr
+   explicit constexpr operator bool() const { return offset_ != 0; }
+
+   /// the stored offset: the distance in bytes from the base
+   constexpr O offset() const { return offset_; }
+
+   /// whether both point to the same object
+   friend constexpr bool operator==( const based_ptr & a, const based_ptr & b ){
+      return a.offset_ == b.offset_;
+   }
+
+   /// whether they point to different objects
+   friend constexpr bool operator!=( const based_ptr & a, const based_ptr & b ){
+      return a.offset_ != b.offset_;
+   }
+
+}; // template class based_ptr
+
+
+// ==========================================================================
+//
+// region
+//
+// ==========================================================================
+
+/// header at the start of an offset_region
+struct offset_region_header {
+
+   /// identifies an offset_region
+   std::uint64_t magic;
+
+   /// the size of the region in bytes, including this header
+   std::uint64_t size;
+
+   /// the number of bytes in use, including this header
+   std::uint64_t used;
+
+   /// the root object
+   offset_ptr< unsigned char > root;
+};
+
+/// a region of memory for relocatable data structures
+///
+/// The offset_region object itself is a handle: it holds the (raw)
+/// address of the memory, so it is not stored in the region.
+class offset_region final {
+private:
+
+   static constexpr std::uint64_t magic = 0x746f72736f72'0045ULL;
+
+   offset_region_header * header;
+
+   offset_region( offset_region_header * h ): header( h ){}
+
+public:
+
+   /// the region in memory of (at most) size bytes
+   ///
+   /// Check valid() before using it: the memory must have been
+   /// formatted by create(), and its size must fit in size.
+   offset_region( void * memory, std::size_t size ):
+      header( static_cast< offset_region_header * >( memory ) )
+   {
+      if( ( size < sizeof( offset_region_header ) )
+         || ( header->magic != magic )
+         || ( header->size > size )
+         || ( header->used > header->size )
+      ){
+         header = nullptr;
+      }
+   }
+
+   /// format memory of size bytes as an empty region
+   ///
+   /// The memory must be aligned for an offset_region_header.
+   /// The size must be at least sizeof( offset_region_header ),
+   /// else the result is not valid().
+   static offset_region create( void * memory, std::size_t size ){
+      if( size < sizeof( offset_region_header ) ){
+         return offset_region( nullptr );
+      }
+      auto h = new( memory ) offset_region_header{
+         magic, size, sizeof( offset_region_header ), nullptr };
+      return offset_region( h );
+   }
+
+   /// whether the memory contains a valid region
+   bool valid() const { return header != nullptr; }
+
+   /// the start of the region, the base for based_ptr's
+   memory_address base() const { return address_of( header ); }
+
+   /// the size of the region in bytes
+   std::size_t size() const { return valid() ? header->size : 0; }
+
+   /// the number of bytes in use
+   std::size_t used() const { return valid() ? header->used : 0; }
+
+   /// bytes of memory aligned to alignment (a power of 2)
+   ///
+   /// The result is nullptr when the region is full.
+   void * allocate( std::size_t bytes, std::size_t alignment ){
+      if( ! valid() ){
+         return nullptr;
+      }
+      const memory_address free = base() + header->used;
+      const std::uintptr_t pad =
+         ( alignment - ( ( free - memory_address() ) & ( alignment - 1 ) ) )
+            & ( alignment - 1 );
+      if( header->size - header->used < pad + bytes ){
+         return nullptr;
+      }
+      header->used += pad + bytes;
+      return pointer_at< void >( free + pad );
+   }
+
+   /// a T constructed from args in the region
+   ///
+   /// The result is nullptr when the region is full.
+   template< typename T, typename... Args >
+   T * make( Args &&... args ){
+      void * p = allocate( sizeof( T ), alignof( T ) );
+      return ( p == nullptr ) ? nullptr : new( p ) T( std::forward< Args >( args )... );
+   }
+
+   /// make p (which must be in the region, or nullptr) the root
+   template< typename T >
+   void set_root( T * p ){
+      header->root = reinterpret_cast< unsigned char * >( p );
+   }
+
+   /// the root, or nullptr when there is none
+   template< typename T >
+   T * root() const {
+      return valid() ? reinterpret_cast< T * >( header->root.get() ) : nullptr;
+   }
+
+}; // class offset_region
+
+
+// ==========================================================================
+//
+// list
+//
+// ==========================================================================
+
+/// singly linked list of V's, with its nodes in an offset_region
+template< typename V >
+class offset_list final {
+private:
+
+   struct node {
+      offset_ptr< node > next;
+      V value;
+   };
+
+   offset_ptr< node > head;
+   std::size_t count;
+
+public:
+
+   /// forward iterator
+   template< typename N, typename R >
+   class iterator_type final {
+   private:
+      N * p;
+   public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type        = V;
+      using difference_type   = std::ptrdiff_t;
+      using pointer           = R *;
+      using reference         = R &;
+
+      iterator_type( N * p = nullptr ): p( p ){}
+      R & operator*() const { return p->value; }
+      R * operator->() const { return & p->value; }
+      iterator_type & operator++(){ p = p->next.get(); return *this; }
+      iterator_type operator++( int ){ auto t = *this; ++*this; return t; }
+      bool operator==( const iterator_type & x ) const { return p == x.p; }
+      bool operator!=( const iterator_type & x ) const { return p != x.p; }
+   };
+
+   /// iterator over the values
+   using iterator = iterator_type< node, V >;
+
+   /// iterator over the values
+   using const_iterator = iterator_type< const node, const V >;
+
+   /// an empty list
+   offset_list(): head( nullptr ), count( 0 ){}
+
+   offset_list( const offset_list & ) = delete;
+   offset_list & operator=( const offset_list & ) = delete;
+
+   /// the number of values
+   std::size_t size() const { return count; }
+
+   /// whether the list is empty
+   bool empty() const { return count == 0; }
+
+   /// add value (allocated in r) at the front
+   ///
+   /// The result is false (and nothing is added) when r is full.
+   bool push_front( offset_region & r, const V & value ){
+      node * n = r.make< node >( node{ head, value } );
+      if( n == nullptr ){
+         return false;
+      }
+      head = n;
+      ++count;
+      return true;
+   }
+
+   /// remove the first value (which must exist)
+   void pop_front(){
+      head = head->next;
+      --count;
+   }
+
+   /// the first value (which must exist)
+   V & front(){ return head->value; }
+
+   /// the first value (which must exist)
+   const V & front() const { return head->value; }
+
+   iterator begin(){ return iterator( head.get() ); }
+   iterator end(){ return iterator(); }
+   const_iterator begin() const { return const_iterator( head.get() ); }
+   const_iterator end() const { return const_iterator(); }
+
+}; // template class offset_list
+
+
+// ==========================================================================
+//
+// hash map
+//
+// ==========================================================================
+
+/// hash map from K to V, with a fixed number of buckets
+/// and its nodes in an offset_region
+///
+/// The hash must give the same value for a key in each program that
+/// uses the map (std::hash does that for integers and pointers,
+/// but it is not guaranteed for strings across library versions).
+template< typename K, typename V, typename H = std::hash< K > >
+class offset_hash_map final {
+private:
+
+   struct node {
+      offset_ptr< node > next;
+      K key;
+      V value;
+   };
+
+   offset_ptr< offset_ptr< node > > buckets;
+   std::size_t n_buckets;
+   std::size_t count;
+
+   offset_ptr< node > & bucket( const K & key ) const {
+      return buckets.get()[ H()( key ) & ( n_buckets - 1 ) ];
+   }
+
+public:
+
+   /// a map with the buckets (at least 1) allocated in r
+   ///
+   /// The number of buckets is rounded up to a power of 2.
+   /// When r is full, the map has no buckets, and insert() fails.
+   offset_hash_map( offset_region & r, std::size_t n ):
+      buckets( nullptr ), n_buckets( 1 ), count( 0 )
+   {
+      while( n_buckets < n ){
+         n_buckets *= 2;
+      }
+      auto p = static_cast< offset_ptr< node > * >( r.allocate(
+         n_buckets * sizeof( offset_ptr< node > ),
+         alignof( offset_ptr< node > ) ) );
+      if( p == nullptr ){
+         n_buckets = 0;
+         return;
+      }
+      for( std::size_t i = 0; i < n_buckets; ++i ){
+         new( p + i ) offset_ptr< node >( nullptr );
+      }
+      buckets = p;
+   }
+
+   offset_hash_map( const offset_hash_map & ) = delete;
+   offset_hash_map & operator=( const offset_hash_map & ) = delete;
+
+   /// the number of keys
+   std::size_t size() const { return count; }
+
+   /// the number of buckets
+   std::size_t bucket_count() const { return n_buckets; }
+
+   /// the value of key, or nullptr when the key is not in the map
+   V * find( const K & key ){
+      if( n_buckets == 0 ){
+         return nullptr;
+      }
+      for( node * n = bucket( key ).get(); n != nullptr; n = n->next.get() ){
+         if( n->key == key ){
+            return & n->value;
+         }
+      }
+      return nullptr;
+   }
+
+   /// the value of key, or nullptr when the key is not in the map
+   const V * find( const K & key ) const {
+      return const_cast< offset_hash_map * >( this )->find( key );
+   }
+
+   /// set the value of key, adding it (allocated in r) when needed
+   ///
+   /// The result is false (and nothing is changed) when r is full.
+   bool insert( offset_region & r, const K & key, const V & value ){
+      if( V * v = find( key ) ){
+         *v = value;
+         return true;
+      }
+      if( n_buckets == 0 ){
+         return false;
+      }
+      offset_ptr< node > & b = bucket( key );
+      node * n = r.make< node >( node{ b, key, value } );
+      if( n == nullptr ){
+         return false;
+      }
+      b = n;
+      ++count;
+      return true;
+   }
+
+}; // template class offset_hash_map
+
+#endif // ifndef torsor_offset_hpp
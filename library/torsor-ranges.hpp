@@ -0,0 +1,438 @@
+// ==========================================================================
+//
+// torsor-ranges.hpp
+//
+// lazy C++20 range adaptors between torsors and their differences:
+// torsor_views::deltas, torsor_views::anchor,
+// torsor_views::offset, torsor_views::bucket
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_ranges_hpp
+#define torsor_ranges_hpp
+
+/// @file
+
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <type_traits>
+#include <utility>
+#include "torsor.hpp"
+
+// The adaptors and their views are in the namespace torsor_views.
+// They compose with the std::ranges adaptors (with |),
+// and allocate nothing: each element is computed when it is read.
+//
+//    std::vector< moment > ts = ...;
+//
+//    // the base type differences of adjacent moments
+//    for( auto d : ts | torsor_views::deltas ){ ... }
+//
+//    // the moments t0 + d0, t0 + d0 + d1, ...
+//    for( moment t : ds | torsor_views::anchor( t0 ) ){ ... }
+//
+//    // each moment plus d
+//    for( moment t : ts | torsor_views::offset( d ) ){ ... }
+//
+//    // the index of the bucket of each moment: the floor of
+//    // ( t - origin ) / width, origin is by default the zero moment
+//    for( auto i : ts | torsor_views::bucket( width ) ){ ... }
+//
+// So ( ts | torsor_views::deltas | torsor_views::anchor( ts[ 0 ] ) )
+// are the moments ts[ 1 ] ...
+//
+// The torsor rules are checked when the adaptor is applied:
+// deltas needs a range of torsors, anchor a range of values that
+// can be added to the t0 torsor, offset a range of torsors to
+// which d can be added (giving a torsor of the same type).
+//
+// The views have simple iterators (deltas holds two iterators of
+// the underlying range, anchor one plus the running torsor),
+// so a loop over a pipeline is a plain loop over the
+// underlying range, which the compiler can vectorize.
+
+namespace torsor_views {
+
+
+// ==========================================================================
+//
+// deltas
+//
+// ==========================================================================
+
+/// view of the differences of adjacent torsors in a range
+///
+/// Element i is r[ i + 1 ] - r[ i ], so a range of n > 0 torsors
+/// has n - 1 deltas.
+template< std::ranges::view V >
+   ///@cond INTERNAL
+   requires std::ranges::forward_range< V >
+      && torsor_concepts::is_torsor< std::ranges::range_value_t< V > >
+   ///@endcond
+class deltas_view final
+   : public std::ranges::view_interface< deltas_view< V > > {
+private:
+
+   V base_;
+
+   using base_iterator = std::ranges::iterator_t< V >;
+   using base_sentinel = std::ranges::sentinel_t< V >;
+   using torsor_type = std::ranges::range_value_t< V >;
+
+public:
+
+   /// the type of a delta
+   using delta_type = decltype(
+      std::declval< torsor_type >() - std::declval< torsor_type >() );
+
+   /// the iterator
+   class iterator {
+   private:
+
+      base_iterator current, next;
+
+   public:
+
+      using value_type = delta_type;
+      using difference_type = std::ranges::range_difference_t< V >;
+      using iterator_concept = std::forward_iterator_tag;
+
+      iterator() = default;
+
+      constexpr iterator( base_iterator current, base_iterator next ):
+         current( current ), next( next )
+      {}
+
+      constexpr delta_type operator*() const {
+         return *next - *current;
+      }
+
+      constexpr iterator & operator++(){
+         current = next;
+         ++next;
+         return *this;
+      }
+
+      constexpr iterator operator++( int ){
+         iterator old = *this;
+         ++*this;
+         return old;
+      }
+
+      friend constexpr bool operator==(
+         const iterator & left, const iterator & right
+      ){
+         return left.next == right.next;
+      }
+
+      friend constexpr bool operator==(
+         const iterator & left, const base_sentinel & right
+      ){
+         return left.next == right;
+      }
+   };
+
+   deltas_view() = default;
+
+   /// the deltas of the torsors in base
+   constexpr explicit deltas_view( V base ): base_( std::move( base ) ){}
+
+   /// the first delta
+   constexpr iterator begin(){
+      base_iterator first = std::ranges::begin( base_ );
+      if( first == std::ranges::end( base_ ) ){
+         return iterator( first, first );
+      }
+      return iterator( first, std::ranges::next( first ) );
+   }
+
+   /// the end of the deltas
+   constexpr base_sentinel end(){
+      return std::ranges::end( base_ );
+   }
+
+   /// the number of deltas
+   constexpr auto size()
+      ///@cond INTERNAL
+      requires std::ranges::sized_range< V >
+      ///@endcond
+   {
+      const auto n = std::ranges::size( base_ );
+      return ( n == 0 ) ? n : n - 1;
+   }
+
+}; // template class deltas_view
+
+template< typename R >
+deltas_view( R && ) -> deltas_view< std::views::all_t< R > >;
+
+
+// ==========================================================================
+//
+// anchor
+//
+// ==========================================================================
+
+/// view of a torsor plus the running sum of the values in a range
+///
+/// Element i is t0 + r[ 0 ] + ... + r[ i ], computed by adding
+/// each value to the previous element. A multi-pass iteration
+/// repeats those additions.
+template< std::ranges::view V, typename T, typename M >
+   ///@cond INTERNAL
+   requires std::ranges::input_range< V >
+      && torsor_concepts::can_be_update_added_with_value<
+         T, std::ranges::range_value_t< V > >
+   ///@endcond
+class anchor_view final
+   : public std::ranges::view_interface< anchor_view< V, T, M > > {
+private:
+
+   V base_;
+   torsor< T, M > start;
+
+   using base_iterator = std::ranges::iterator_t< V >;
+   using base_sentinel = std::ranges::sentinel_t< V >;
+
+public:
+
+   /// the iterator
+   class iterator {
+   private:
+
+      base_iterator current;
+      torsor< T, M > sum;
+
+   public:
+
+      using value_type = torsor< T, M >;
+      using difference_type = std::ranges::range_difference_t< V >;
+      using iterator_concept = std::conditional_t<
+         std::ranges::forward_range< V >,
+         std::forward_iterator_tag, std::input_iterator_tag >;
+
+      iterator() = default;
+
+      constexpr iterator( base_iterator current, const torsor< T, M > & sum ):
+         current( std::move( current ) ), sum( sum )
+      {}
+
+      constexpr torsor< T, M > operator*() const {
+         return sum + *current;
+      }
+
+      constexpr iterator & operator++(){
+         sum += *current;
+         ++current;
+         return *this;
+      }
+
+      constexpr void operator++( int ){
+         ++*this;
+      }
+
+      constexpr iterator operator++( int )
+         ///@cond INTERNAL
+         requires std::ranges::forward_range< V >
+         ///@endcond
+      {
+         iterator old = *this;
+         ++*this;
+         return old;
+      }
+
+      friend constexpr bool operator==(
+         const iterator & left, const iterator & right
+      ){
+         return left.current == right.current;
+      }
+
+      friend constexpr bool operator==(
+         const iterator & left, const base_sentinel & right
+      ){
+         return left.current == right;
+      }
+   };
+
+   anchor_view() = default;
+
+   /// the torsor start plus the running sum of the values in base
+   constexpr anchor_view( V base, const torsor< T, M > & start ):
+      base_( std::move( base ) ), start( start )
+   {}
+
+   /// the first torsor
+   constexpr iterator begin(){
+      return iterator( std::ranges::begin( base_ ), start );
+   }
+
+   /// the end of the torsors
+   constexpr base_sentinel end(){
+      return std::ranges::end( base_ );
+   }
+
+   /// the number of torsors
+   constexpr auto size()
+      ///@cond INTERNAL
+      requires std::ranges::sized_range< V >
+      ///@endcond
+   {
+      return std::ranges::size( base_ );
+   }
+
+}; // template class anchor_view
+
+template< typename R, typename T, typename M >
+anchor_view( R &&, const torsor< T, M > & )
+   -> anchor_view< std::views::all_t< R >, T, M >;
+
+
+// ==========================================================================
+//
+// the adaptors
+//
+// ==========================================================================
+
+///@cond INTERNAL
+
+// floor( d / width ) for a positive width
+template< typename D, typename W >
+constexpr auto bucket_index( const D & d, const W & width ){
+   if constexpr ( std::is_floating_point_v< decltype( d / width ) > ){
+      return std::floor( d / width );
+   } else {
+      auto q = d / width;
+      if( q * width > d ){
+         q -= 1;
+      }
+      return q;
+   }
+}
+
+struct deltas_adaptor {
+
+   template< std::ranges::viewable_range R >
+      requires std::ranges::forward_range< R >
+         && torsor_concepts::is_torsor< std::ranges::range_value_t< R > >
+   constexpr auto operator()( R && r ) const {
+      return deltas_view( std::forward< R >( r ) );
+   }
+
+   template< std::ranges::viewable_range R >
+      requires std::ranges::forward_range< R >
+         && torsor_concepts::is_torsor< std::ranges::range_value_t< R > >
+   friend constexpr auto operator|( R && r, const deltas_adaptor & a ){
+      return a( std::forward< R >( r ) );
+   }
+};
+
+template< typename T, typename M >
+struct anchor_adaptor {
+   torsor< T, M > start;
+
+   template< std::ranges::viewable_range R >
+      requires std::ranges::input_range< R >
+         && torsor_concepts::can_be_update_added_with_value<
+            T, std::ranges::range_value_t< R > >
+   friend constexpr auto operator|( R && r, const anchor_adaptor & a ){
+      return anchor_view( std::forward< R >( r ), a.start );
+   }
+};
+
+template< typename D >
+struct offset_adaptor {
+   D d;
+
+   template< std::ranges::viewable_range R >
+      requires std::ranges::input_range< R >
+         && torsor_concepts::is_torsor< std::ranges::range_value_t< R > >
+         && requires( std::ranges::range_value_t< R > t, D d ){
+            { t + d } -> std::same_as< std::ranges::range_value_t< R > >;
+         }
+   friend constexpr auto operator|( R && r, const offset_adaptor & a ){
+      return std::views::transform( std::forward< R >( r ),
+         [ d = a.d ]( const auto & t ){ return t + d; } );
+   }
+};
+
+// O is void for the zero moment of the elements as origin
+template< typename W, typename O >
+struct bucket_adaptor {
+   W width;
+   O origin;
+
+   template< std::ranges::viewable_range R >
+      requires std::ranges::input_range< R >
+         && std::is_same_v< std::ranges::range_value_t< R >, O >
+   friend constexpr auto operator|( R && r, const bucket_adaptor & a ){
+      return std::views::transform( std::forward< R >( r ),
+         [ width = a.width, origin = a.origin ]( const O & t ){
+            return bucket_index( t - origin, width );
+         } );
+   }
+};
+
+template< typename W >
+struct bucket_adaptor< W, void > {
+   W width;
+
+   template< std::ranges::viewable_range R >
+      requires std::ranges::input_range< R >
+         && torsor_concepts::is_torsor< std::ranges::range_value_t< R > >
+   friend constexpr auto operator|( R && r, const bucket_adaptor & a ){
+      using moment = std::ranges::range_value_t< R >;
+      return std::views::transform( std::forward< R >( r ),
+         [ width = a.width ]( const moment & t ){
+            return bucket_index( t - moment(), width );
+         } );
+   }
+};
+
+///@endcond
+
+/// the differences of adjacent torsors
+inline constexpr deltas_adaptor deltas;
+
+/// a torsor plus the running sum of the values
+template< typename T, typename M >
+constexpr auto anchor( const torsor< T, M > & start ){
+   return anchor_adaptor< T, M >{ start };
+}
+
+/// each torsor plus d
+template< typename D >
+constexpr auto offset( const D & d ){
+   return offset_adaptor< D >{ d };
+}
+
+/// the index of the width-wide bucket of each torsor,
+/// counted from the origin
+///
+/// The width must be positive.
+template< typename W, typename T, typename M >
+constexpr auto bucket( const W & width, const torsor< T, M > & origin ){
+   return bucket_adaptor< W, torsor< T, M > >{ width, origin };
+}
+
+/// the index of the width-wide bucket of each torsor,
+/// counted from its zero moment
+///
+/// The width must be positive.
+template< typename W >
+constexpr auto bucket( const W & width ){
+   return bucket_adaptor< W, void >{ width };
+}
+
+} // namespace torsor_views
+
+#endif // ifndef torsor_ranges_hpp
@@ -0,0 +1,732 @@
+// ==========================================================================
+//
+// torsor-segment.hpp
+//
+// fixed-layout segments of torsor-keyed records,
+// for storing in and reading (zero-copy) from files or memory,
+// and a store of such segments with a durable-flush policy
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_segment_hpp
+#define torsor_segment_hpp
+
+/// @file
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "torsor.hpp"
+
+#if __has_include( <sys/mman.h> ) && __has_include( <unistd.h> )
+   #include <fcntl.h>
+   #include <sys/mman.h>
+   #include <sys/stat.h>
+   #include <unistd.h>
+   #define TORSOR_SEGMENT_POSIX
+#endif
+
+// The segments live in a block of memory supplied by the user.
+// That can be a plain buffer, or a memory-mapped file:
+// the layout contains no pointers, so a segment written by a
+// segment_writer can be read in place by a segment_reader,
+// at whatever address it is mapped.
+//
+// A segment_store is a sequence of segments of the same capacity,
+// that are created by a storage: when a segment is full, the store
+// rolls over to a new one. The storage makes (parts of) a segment
+// durable when the store flushes it: after a number of records,
+// after a span of keys, when a segment is full, or on request.
+// memory_segment_storage keeps the segments in memory,
+// posix_segment_files (only where the POSIX headers are available)
+// memory-maps one file per segment, and flushes with msync.
+//
+// segment layout:
+//    segment_header
+//    capacity keys     ( torsor< int64_t, M >, non-decreasing )
+//    capacity payloads ( P )
+
+
+// ==========================================================================
+//
+// the segment header
+//
+// ==========================================================================
+
+/// header at the start of each segment
+///
+/// The min and max are the first and last key (as their distance
+/// from the anchor), so a set of headers is the sparse index that
+/// selects the segments that are relevant for a range scan.
+struct segment_header {
+
+   /// identifies a segment, and the sizes of its key and payload
+   std::uint64_t magic;
+
+   /// the maximum number of records
+   std::uint64_t capacity;
+
+   /// the number of records
+   std::uint64_t count;
+
+   /// the first key
+   std::int64_t min;
+
+   /// the last key
+   std::int64_t max;
+};
+
+///@cond INTERNAL
+constexpr std::uint64_t segment_magic(
+   std::size_t key_size, std::size_t payload_size
+){
+   return 0x746f72736f720000ULL
+      ^ ( (std::uint64_t) key_size << 8 )
+      ^ (std::uint64_t) payload_size;
+}
+
+constexpr std::size_t segment_align( std::size_t n, std::size_t a ){
+   return ( n + a - 1 ) / a * a;
+}
+///@endcond
+
+
+// ==========================================================================
+//
+// layout
+//
+// ==========================================================================
+
+/// the layout of a segment of records with payload P and tag M
+template< typename P, typename M = void >
+struct segment_layout {
+
+   /// the key of a record
+   using key = torsor< std::int64_t, M >;
+
+   static_assert( sizeof( key ) == sizeof( std::int64_t ),
+      "a torsor must have the layout of its base type" );
+   static_assert( std::is_trivially_copyable_v< key >,
+      "a torsor must be trivially copyable" );
+   static_assert( std::is_trivially_copyable_v< P >,
+      "the payload must be trivially copyable" );
+
+   /// offset of the keys column
+   static constexpr std::size_t keys_offset =
+      segment_align( sizeof( segment_header ), alignof( key ) );
+
+   /// offset of the payloads column
+   static constexpr std::size_t payloads_offset( std::size_t capacity ){
+      return segment_align(
+         keys_offset + capacity * sizeof( key ), alignof( P ) );
+   }
+
+   /// the number of bytes of a segment
+   static constexpr std::size_t bytes( std::size_t capacity ){
+      return payloads_offset( capacity ) + capacity * sizeof( P );
+   }
+
+   /// the magic value
+   static constexpr std::uint64_t magic =
+      segment_magic( sizeof( key ), sizeof( P ) );
+};
+
+
+// ==========================================================================
+//
+// writer
+//
+// ==========================================================================
+
+/// append-only writer of a segment
+///
+/// The writer formats a block of memory of (at least)
+/// segment_layout< P, M >::bytes( capacity ) bytes
+/// as an empty segment, and appends records to it.
+/// The keys must be appended in non-decreasing order.
+/// The header (including the count) is updated after each
+/// append, so the memory is always a valid segment.
+template< typename P, typename M = void >
+class segment_writer final {
+public:
+
+   /// the layout
+   using layout = segment_layout< P, M >;
+
+   /// the key of a record
+   using key = typename layout::key;
+
+private:
+
+   segment_header * header;
+   key * keys;
+   P * payloads;
+
+public:
+
+   /// format memory as an empty segment
+   segment_writer( void * memory, std::size_t capacity ):
+      header( static_cast< segment_header * >( memory ) ),
+      keys( reinterpret_cast< key * >(
+         static_cast< char * >( memory ) + layout::keys_offset )),
+      payloads( reinterpret_cast< P * >(
+         static_cast< char * >( memory )
+            + layout::payloads_offset( capacity )))
+   {
+      header->magic    = layout::magic;
+      header->capacity = capacity;
+      header->count    = 0;
+      header->min      = 0;
+      header->max      = 0;
+   }
+
+   /// the number of records
+   std::size_t size() const { return header->count; }
+
+   /// whether the segment is full
+   bool full() const { return header->count == header->capacity; }
+
+   /// append a record
+   ///
+   /// The result is false (and nothing is appended)
+   /// when the segment is full, or the key is before the last key.
+   bool append( const key & k, const P & payload ){
+      const auto n = header->count;
+      if( n == header->capacity ){
+         return false;
+      }
+      const std::int64_t d = k - key();
+      if( ( n > 0 ) && ( d < header->max ) ){
+         return false;
+      }
+      keys[ n ] = k;
+      payloads[ n ] = payload;
+      if( n == 0 ){
+         header->min = d;
+      }
+      header->max = d;
+      header->count = n + 1;
+      return true;
+   }
+
+}; // template class segment_writer
+
+
+// ==========================================================================
+//
+// reader
+//
+// ==========================================================================
+
+/// a range of records: [ first, last )
+struct segment_range {
+   std::size_t first;
+   std::size_t last;
+   std::size_t size() const { return last - first; }
+};
+
+/// zero-copy reader of a segment
+///
+/// The keys and payloads are accessed directly in the memory of
+/// the segment, without copying or parsing.
+template< typename P, typename M = void >
+class segment_reader final {
+public:
+
+   /// the layout
+   using layout = segment_layout< P, M >;
+
+   /// the key of a record
+   using key = typename layout::key;
+
+private:
+
+   const segment_header * header;
+   const key * keys_;
+   const P * payloads_;
+   bool valid_;
+
+public:
+
+   /// read the segment in memory of (at most) size bytes
+   ///
+   /// Check valid() before using the reader: the segment must
+   /// have been written for the same key and payload sizes, and
+   /// its capacity must fit in the size.
+   segment_reader( const void * memory, std::size_t size ):
+      header( static_cast< const segment_header * >( memory ) ),
+      keys_( nullptr ), payloads_( nullptr ), valid_( false )
+   {
+      if( ( size < sizeof( segment_header ) )
+         || ( header->magic != layout::magic )
+         || ( header->count > header->capacity )
+         || ( header->capacity > size )   // guards the next line
+         || ( layout::bytes( header->capacity ) > size )
+      ){
+         return;
+      }
+      keys_ = reinterpret_cast< const key * >(
+         static_cast< const char * >( memory ) + layout::keys_offset );
+      payloads_ = reinterpret_cast< const P * >(
+         static_cast< const char * >( memory )
+            + layout::payloads_offset( header->capacity ) );
+      valid_ = true;
+   }
+
+   /// whether the memory contains a valid segment
+   bool valid() const { return valid_; }
+
+   /// the number of records
+   std::size_t size() const { return valid_ ? header->count : 0; }
+
+   /// the keys column
+   const key * keys() const { return keys_; }
+
+   /// the payloads column
+   const P * payloads() const { return payloads_; }
+
+   /// the first key (only meaningful when size() > 0)
+   key min() const { return key() + header->min; }
+
+   /// the last key (only meaningful when size() > 0)
+   key max() const { return key() + header->max; }
+
+   /// whether the segment can have keys in [ from, to )
+   ///
+   /// This uses only the header, so it doesn't touch
+   /// the (possibly not yet paged-in) columns.
+   bool overlaps( const key & from, const key & to ) const {
+      return ( size() > 0 ) && ( from <= max() ) && ( min() < to );
+   }
+
+   /// the records with a key in [ from, to )
+   segment_range range( const key & from, const key & to ) const {
+      if( ! overlaps( from, to ) ){
+         return { 0, 0 };
+      }
+      const key * b = keys_;
+      const key * e = keys_ + size();
+      const key * f = ( from <= min() ) ? b : std::lower_bound( b, e, from );
+      const key * l = ( max() < to ) ? e : std::lower_bound( f, e, to );
+      return { (std::size_t)( f - b ), (std::size_t)( l - b ) };
+   }
+
+}; // template class segment_reader
+
+
+// ==========================================================================
+//
+// storage
+//
+// ==========================================================================
+
+// A storage has
+//
+//    std::size_t count() const
+//       the number of existing segments
+//
+//    void * create( std::size_t i, std::size_t bytes )
+//       create segment i (== count()) of bytes bytes,
+//       nullptr when that fails
+//
+//    void * open( std::size_t i, std::size_t & bytes )
+//       open the existing segment i, and set bytes to its size,
+//       nullptr when that fails
+//
+//    bool sync( void * memory, std::size_t offset, std::size_t bytes )
+//       make bytes bytes at offset in a segment durable
+//
+//    void close( void * memory, std::size_t bytes )
+//       close a segment
+
+/// storage that keeps the segments in memory
+///
+/// The segments live as long as the storage, so a store can be
+/// re-opened on it. The syncs are only counted.
+class memory_segment_storage final {
+private:
+
+   std::vector< std::vector< std::uint64_t > > blocks;
+   std::size_t syncs_ = 0;
+
+public:
+
+   /// the number of segments
+   std::size_t count() const { return blocks.size(); }
+
+   /// create segment i, only i == count() is possible
+   void * create( std::size_t i, std::size_t bytes ){
+      if( i != blocks.size() ){
+         return nullptr;
+      }
+      blocks.emplace_back( ( bytes + 7 ) / 8, 0 );
+      return blocks.back().data();
+   }
+
+   /// open segment i
+   void * open( std::size_t i, std::size_t & bytes ){
+      if( i >= blocks.size() ){
+         return nullptr;
+      }
+      bytes = blocks[ i ].size() * 8;
+      return blocks[ i ].data();
+   }
+
+   /// count a sync
+   bool sync( void *, std::size_t, std::size_t ){
+      ++syncs_;
+      return true;
+   }
+
+   /// (nothing to close)
+   void close( void *, std::size_t ){}
+
+   /// the number of syncs
+   std::size_t syncs() const { return syncs_; }
+
+}; // class memory_segment_storage
+
+#ifdef TORSOR_SEGMENT_POSIX
+
+/// storage of each segment in its own memory-mapped file
+///
+/// Segment i is the file prefix + i (6 digits) + ".seg",
+/// for instance the prefix "/data/ticks-" gives
+/// /data/ticks-000000.seg, /data/ticks-000001.seg, etc.
+/// A sync is an msync (MS_SYNC) of the pages that contain
+/// the bytes. A new file is made durable by an fsync of
+/// its directory.
+class posix_segment_files final {
+private:
+
+   std::string prefix;
+
+   std::string name( std::size_t i ) const {
+      std::string n = std::to_string( i );
+      return prefix + std::string( n.size() < 6 ? 6 - n.size() : 0, '0' )
+         + n + ".seg";
+   }
+
+   void sync_directory() const {
+      const auto slash = prefix.rfind( '/' );
+      const std::string directory = ( slash == std::string::npos )
+         ? "." : prefix.substr( 0, slash + 1 );
+      const int fd = ::open( directory.c_str(), O_RDONLY );
+      if( fd >= 0 ){
+         ::fsync( fd );
+         ::close( fd );
+      }
+   }
+
+   static void * map( int fd, std::size_t bytes ){
+      void * m = ::mmap( nullptr, bytes,
+         PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+      ::close( fd );
+      return ( m == MAP_FAILED ) ? nullptr : m;
+   }
+
+public:
+
+   /// the files prefix + 000000.seg, prefix + 000001.seg, ...
+   explicit posix_segment_files( std::string prefix ):
+      prefix( std::move( prefix ) )
+   {}
+
+   /// the number of existing (consecutive) segment files
+   std::size_t count() const {
+      std::size_t i = 0;
+      while( ::access( name( i ).c_str(), F_OK ) == 0 ){
+         ++i;
+      }
+      return i;
+   }
+
+   /// create (or truncate) and map segment file i
+   void * create( std::size_t i, std::size_t bytes ){
+      const int fd = ::open( name( i ).c_str(),
+         O_RDWR | O_CREAT | O_TRUNC, 0644 );
+      if( fd < 0 ){
+         return nullptr;
+      }
+      if( ::ftruncate( fd, (off_t) bytes ) != 0 ){
+         ::close( fd );
+         return nullptr;
+      }
+      sync_directory();
+      return map( fd, bytes );
+   }
+
+   /// map the existing segment file i
+   void * open( std::size_t i, std::size_t & bytes ){
+      const int fd = ::open( name( i ).c_str(), O_RDWR );
+      if( fd < 0 ){
+         return nullptr;
+      }
+      struct stat s;
+      if( ( ::fstat( fd, & s ) != 0 ) || ( s.st_size <= 0 ) ){
+         ::close( fd );
+         return nullptr;
+      }
+      bytes = (std::size_t) s.st_size;
+      return map( fd, bytes );
+   }
+
+   /// msync the pages that contain the bytes
+   bool sync( void * memory, std::size_t offset, std::size_t bytes ){
+      if( bytes == 0 ){
+         return true;
+      }
+      const std::uintptr_t page = (std::uintptr_t) ::sysconf( _SC_PAGESIZE );
+      const std::uintptr_t first =
+         ( (std::uintptr_t) memory + offset ) / page * page;
+      const std::uintptr_t last = (std::uintptr_t) memory + offset + bytes;
+      return ::msync( (void *) first, last - first, MS_SYNC ) == 0;
+   }
+
+   /// unmap a segment
+   void close( void * memory, std::size_t bytes ){
+      ::munmap( memory, bytes );
+   }
+
+   /// remove all segment files
+   void remove(){
+      for( std::size_t i = count(); i > 0; --i ){
+         ::unlink( name( i - 1 ).c_str() );
+      }
+   }
+
+}; // class posix_segment_files
+
+#endif // ifdef TORSOR_SEGMENT_POSIX
+
+
+// ==========================================================================
+//
+// store
+//
+// ==========================================================================
+
+/// when the records appended to a segment_store are made durable
+///
+/// A full segment is always flushed before the store rolls over
+/// to the next one. With both values 0, that and flush() are
+/// the only flushes.
+struct segment_flush_policy {
+
+   /// flush when this many records are not yet durable (0: never)
+   std::size_t records = 0;
+
+   /// flush when the key of a record is this far past the oldest
+   /// key that is not yet durable (0: never)
+   std::int64_t key_span = 0;
+};
+
+/// append-only store of segments on the storage S
+///
+/// The store opens the segments that exist on the storage (as
+/// read-only, new records go to a new segment), and creates new
+/// segments of capacity records. The keys must be appended in
+/// non-decreasing order, also across segments and re-opens.
+/// A flush syncs only the part of the current segment that was
+/// appended since the previous flush (and its header).
+/// The storage must outlive the store.
+template< typename P, typename M, typename S >
+class segment_store final {
+public:
+
+   /// the layout
+   using layout = segment_layout< P, M >;
+
+   /// the key of a record
+   using key = typename layout::key;
+
+   /// the reader of a segment
+   using reader = segment_reader< P, M >;
+
+private:
+
+   struct segment {
+      void * memory;
+      std::size_t bytes;
+   };
+
+   S & storage;
+   std::size_t capacity_;
+   segment_flush_policy policy;
+   std::vector< segment > segments_;
+   std::vector< reader > readers;
+   std::optional< segment_writer< P, M > > writer;
+   std::size_t synced;
+   key oldest;
+   key last;
+   bool any;
+   bool valid_;
+
+   bool roll(){
+      if( writer && ! flush() ){
+         return false;
+      }
+      writer.reset();
+      const std::size_t bytes = layout::bytes( capacity_ );
+      void * memory = storage.create( segments_.size(), bytes );
+      if( memory == nullptr ){
+         return false;
+      }
+      segments_.push_back( segment{ memory, bytes } );
+      writer.emplace( memory, capacity_ );
+      readers.emplace_back( memory, bytes );
+      synced = 0;
+      return true;
+   }
+
+public:
+
+   /// a store of segments of capacity records on the storage
+   ///
+   /// Check valid(): it is false when an existing segment
+   /// could not be opened, or is not a valid segment.
+   segment_store(
+      S & storage, std::size_t capacity, segment_flush_policy policy = {}
+   ):
+      storage( storage ), capacity_( capacity ), policy( policy ),
+      synced( 0 ), any( false ), valid_( capacity > 0 )
+   {
+      const std::size_t n = storage.count();
+      for( std::size_t i = 0; ( i < n ) && valid_; ++i ){
+         std::size_t bytes = 0;
+         void * memory = storage.open( i, bytes );
+         if( memory == nullptr ){
+            valid_ = false;
+            break;
+         }
+         segments_.push_back( segment{ memory, bytes } );
+         readers.emplace_back( memory, bytes );
+         valid_ = readers.back().valid();
+         if( valid_ && readers.back().size() > 0 ){
+            last = readers.back().max();
+            any = true;
+         }
+      }
+   }
+
+   segment_store( const segment_store & ) = delete;
+   segment_store & operator=( const segment_store & ) = delete;
+
+   /// flush, and close all segments
+   ~segment_store(){
+      if( writer ){
+         flush();
+      }
+      for( auto & s : segments_ ){
+         storage.close( s.memory, s.bytes );
+      }
+   }
+
+   /// whether the existing segments were opened
+   bool valid() const { return valid_; }
+
+   /// the capacity of (new) segments
+   std::size_t capacity() const { return capacity_; }
+
+   /// append a record
+   ///
+   /// The result is false (and nothing is appended) when the store
+   /// is not valid, the key is before the last key, or a new segment
+   /// could not be created.
+   bool append( const key & k, const P & payload ){
+      if( ! valid_ || ( any && ( k < last ) ) ){
+         return false;
+      }
+      if( ( ! writer || writer->full() ) && ! roll() ){
+         return false;
+      }
+      if( synced == writer->size() ){
+         oldest = k;
+      }
+      writer->append( k, payload );
+      last = k;
+      any = true;
+      const std::size_t pending = writer->size() - synced;
+      if( ( ( policy.records > 0 ) && ( pending >= policy.records ) )
+         || ( ( policy.key_span > 0 ) && ( k - oldest >= policy.key_span ) )
+      ){
+         return flush();
+      }
+      return true;
+   }
+
+   /// make all appended records durable
+   ///
+   /// The records are synced before the header that counts them.
+   bool flush(){
+      if( ! writer || ( synced == writer->size() ) ){
+         return true;
+      }
+      const std::size_t n = writer->size();
+      void * memory = segments_.back().memory;
+      const bool ok =
+         storage.sync( memory,
+            layout::keys_offset + synced * sizeof( key ),
+            ( n - synced ) * sizeof( key ) )
+         && storage.sync( memory,
+            layout::payloads_offset( capacity_ ) + synced * sizeof( P ),
+            ( n - synced ) * sizeof( P ) )
+         && storage.sync( memory, 0, sizeof( segment_header ) );
+      if( ok ){
+         synced = n;
+      }
+      return ok;
+   }
+
+   /// the number of records that are not yet durable
+   std::size_t pending() const {
+      return writer ? writer->size() - synced : 0;
+   }
+
+   /// the number of segments
+   std::size_t segments() const { return readers.size(); }
+
+   /// the reader of segment i
+   const reader & segment_at( std::size_t i ) const { return readers[ i ]; }
+
+   /// the number of records in all segments
+   std::size_t size() const {
+      std::size_t n = 0;
+      for( const auto & r : readers ){
+         n += r.size();
+      }
+      return n;
+   }
+
+   /// call f( keys, payloads, n ) for the records with a key
+   /// in [ from, to ), one call per segment that has such records
+   ///
+   /// The headers are the sparse index: the columns of the other
+   /// segments are not touched.
+   template< typename F >
+   void scan( const key & from, const key & to, F f ) const {
+      for( const auto & r : readers ){
+         const segment_range range = r.range( from, to );
+         if( range.size() > 0 ){
+            f( r.keys() + range.first, r.payloads() + range.first,
+               range.size() );
+         }
+      }
+   }
+
+}; // template class segment_store
+
+#endif // ifndef torsor_segment_hpp
@@ -0,0 +1,441 @@
+// ==========================================================================
+//
+// torsor-simulation.hpp
+//
+// discrete-event simulation with a virtual torsor clock,
+// events in a calendar queue
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_simulation_hpp
+#define torsor_simulation_hpp
+
+/// @file
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "torsor.hpp"
+
+// A simulator has a virtual clock: its now() is a torsor< D, M >
+// (by default D is std::chrono::nanoseconds and M is sim_tag)
+// that doesn't follow the real time, but jumps from event to event.
+// An event is an action (a function object without arguments)
+// that is scheduled at a moment, or after a delay (a D) from now.
+// Like the two wait() functions in the timing example of the readme,
+// the two schedule() functions are overloads: one for a moment,
+// one for a duration.
+//
+//    simulator<> sim;
+//    using namespace std::chrono_literals;
+//
+//    sim.schedule( 10ms, [ & ]{ ... } );
+//    sim.schedule( sim.now() + 1s, [ & ]{ ... } );
+//    sim.run();
+//
+// The events run in the order of their moments, events at the same
+// moment in the order in which they were scheduled, so a simulation
+// is deterministic. An action can schedule more events.
+//
+// The simulation_clock is the now() / wait() pair of a simulator,
+// as a clock (see torsor-clock.hpp). It replaces the real-time clock
+// for timing code that is a template on its clock: a wait() runs the
+// events up to the moment, and then sets now() to that moment.
+// So timer-heavy code can be tested deterministically, and as fast
+// as the events can be run.
+//
+//    template< typename C >
+//    typename C::duration time_to_run( F work ){
+//       auto start = C::now();
+//       work();    // which calls C::wait()
+//       auto stop = C::now();
+//       return stop - start;
+//    }
+//
+//    simulator<> sim;
+//    simulation_clock<>::use( sim );
+//    time_to_run< simulation_clock<> >( work );
+//
+// The events are stored in a calendar queue (R. Brown, 1988):
+// an array of buckets, each for an interval (its width) of time,
+// used as a year of days on a calendar. An event goes to the bucket
+// of its moment (modulo the year), in a short list that is sorted
+// on the moments. The next event is the first one in the current
+// bucket, or in one of the buckets after it, that is in this year.
+// When the number of events is more than twice, or less than half,
+// the number of buckets, the number of buckets is doubled or halved,
+// and the width is set to 3 times the average distance between the
+// first events (so a bucket has about 3 of them). That keeps both
+// the scheduling and the taking of the next event at O( 1 ) on
+// average (a binary heap needs O( log n )).
+// The events are stored (with their actions) in a pool,
+// so at a steady number of events nothing is allocated, as long as
+// the actions are small enough for std::function to store them
+// in place (in the common implementations, a lambda that captures
+// one or two pointers, for instance this).
+
+
+// ==========================================================================
+//
+// simulator
+//
+// ==========================================================================
+
+/// the default tag of the moments of a simulation
+struct sim_tag {};
+
+/// a discrete-event simulator: a virtual clock with moments
+/// torsor< D, M >, and a calendar queue of events
+template< typename D = std::chrono::nanoseconds, typename M = sim_tag >
+class simulator final {
+public:
+
+   /// the durations
+   using duration = D;
+
+   /// the moments
+   using moment = torsor< D, M >;
+
+   /// the actions of the events
+   using action = std::function< void() >;
+
+private:
+
+   static constexpr std::uint32_t none = ~std::uint32_t( 0 );
+   static constexpr std::size_t min_buckets = 16;
+
+   // an event: its moment (as the duration from the start) and the
+   // next event in its bucket (or in the free list); the actions are
+   // in a separate array, so the calendar uses less cache
+   struct event {
+      duration at;
+      std::uint32_t next;
+   };
+
+   moment start_;
+   duration now_;
+   std::vector< event > events;
+   std::vector< action > actions;
+   std::uint32_t free_list = none;
+   std::size_t pending_ = 0;
+   std::uint64_t processed_ = 0;
+   bool stopped = false;
+
+   // the calendar: the first and the last event in each bucket,
+   // the width of a bucket, the current bucket and the end of its interval
+   std::vector< std::uint32_t > buckets;
+   std::vector< std::uint32_t > lasts;
+   std::size_t mask;
+   duration width;
+   std::size_t current = 0;
+   duration current_end;
+
+   std::uint64_t day( const duration & at ) const {
+      return static_cast< std::uint64_t >( at / width );
+   }
+
+   // move to the day of at
+   void go_to( const duration & at ){
+      const std::uint64_t d = day( at );
+      current = d & mask;
+      current_end = width * static_cast< std::int64_t >( d + 1 );
+   }
+
+   // put event e in its bucket, after the events at or before it
+   // (mostly that is after the last one)
+   void insert( std::uint32_t e ){
+      const duration at = events[ e ].at;
+      const std::size_t b = day( at ) & mask;
+      const std::uint32_t last = lasts[ b ];
+      if( last == none || ! ( at < events[ last ].at ) ){
+         events[ e ].next = none;
+         ( ( last == none ) ? buckets[ b ] : events[ last ].next ) = e;
+         lasts[ b ] = e;
+      } else {
+         std::uint32_t * p = & buckets[ b ];
+         while( ! ( at < events[ *p ].at ) ){
+            p = & events[ *p ].next;
+         }
+         events[ e ].next = *p;
+         *p = e;
+      }
+
+      // an event before the current bucket makes that the current one
+      if( at < current_end - width ){
+         go_to( at );
+      }
+   }
+
+   // the first event (there must be one), and make its bucket current
+   std::uint32_t first(){
+      duration end = current_end;
+      for( std::size_t i = 0; i <= mask; ++i ){
+         const std::size_t b = ( current + i ) & mask;
+         const std::uint32_t e = buckets[ b ];
+         if( e != none && events[ e ].at < end ){
+            current = b;
+            current_end = end;
+            return e;
+         }
+         end += width;
+      }
+
+      // no event in this year: the width is too small for the
+      // events, so it is estimated again, then the earliest first
+      // event of a bucket is the first one
+      resize( buckets.size() );
+      std::uint32_t best = none;
+      for( const std::uint32_t e : buckets ){
+         if( e != none && ( best == none || events[ e ].at < events[ best ].at ) ){
+            best = e;
+         }
+      }
+      go_to( events[ best ].at );
+      return best;
+   }
+
+   // rebuild the calendar with n buckets
+   void resize( std::size_t n ){
+      std::vector< std::uint32_t > old( n, none );
+      old.swap( buckets );
+      lasts.assign( n, none );
+      mask = n - 1;
+
+      // the width: 3 times the average distance between the (up to 64)
+      // first events, ignoring distances of more than twice the average
+      std::vector< duration > first;
+      first.reserve( pending_ );
+      for( const std::uint32_t b : old ){
+         for( std::uint32_t e = b; e != none; e = events[ e ].next ){
+            first.push_back( events[ e ].at );
+         }
+      }
+      const std::size_t s = std::min< std::size_t >( first.size(), 64 );
+      std::partial_sort( first.begin(), first.begin() + s, first.end() );
+      width = duration( 1 );
+      if( s > 1 ){
+         const duration average = ( first[ s - 1 ] - first[ 0 ] )
+            / static_cast< std::int64_t >( s - 1 );
+         duration sum = duration( 0 );
+         std::int64_t count = 0;
+         for( std::size_t i = 1; i < s; ++i ){
+            const duration d = first[ i ] - first[ i - 1 ];
+            if( ! ( average * 2 < d ) ){
+               sum += d;
+               ++count;
+            }
+         }
+         if( count > 0 && duration( 0 ) < sum ){
+            width = std::max( duration( 1 ), ( sum * 3 ) / count );
+         }
+      }
+
+      // the events in their new buckets, in the order of the old
+      // buckets, so events at the same moment keep their order
+      go_to( now_ );
+      for( const std::uint32_t b : old ){
+         for( std::uint32_t e = b; e != none; ){
+            const std::uint32_t next = events[ e ].next;
+            insert( e );
+            e = next;
+         }
+      }
+   }
+
+   // run the first event (there must be one)
+   void run_first(){
+      const std::uint32_t e = first();
+      buckets[ current ] = events[ e ].next;
+      if( events[ e ].next == none ){
+         lasts[ current ] = none;
+      }
+      now_ = events[ e ].at;
+
+      // the action may schedule events, which can move the pool,
+      // so it is moved out, and the event is freed, first
+      action work = std::move( actions[ e ] );
+      events[ e ].next = free_list;
+      free_list = e;
+      --pending_;
+      ++processed_;
+      if( ( pending_ < buckets.size() / 2 ) && ( buckets.size() > min_buckets ) ){
+         resize( buckets.size() / 2 );
+      }
+      work();
+   }
+
+public:
+
+   /// a simulator at the moment start, without events
+   explicit simulator( const moment & start = moment() ):
+      start_( start ),
+      now_( 0 ),
+      buckets( min_buckets, none ),
+      lasts( min_buckets, none ),
+      mask( min_buckets - 1 ),
+      width( 1 ),
+      current_end( 1 )
+   {}
+
+   simulator( const simulator & ) = delete;
+   simulator & operator=( const simulator & ) = delete;
+
+   /// the current (virtual) moment
+   moment now() const { return start_ + now_; }
+
+   /// the number of scheduled events that have not run yet
+   std::size_t pending() const { return pending_; }
+
+   /// the number of events that have run
+   std::uint64_t processed() const { return processed_; }
+
+   /// schedule an action at the moment t
+   ///
+   /// A moment before now() is taken as now().
+   template< typename F >
+   void schedule( const moment & t, F && work ){
+      const duration at = std::max( now_, t - start_ );
+      std::uint32_t e;
+      if( free_list != none ){
+         e = free_list;
+         free_list = events[ e ].next;
+         actions[ e ] = std::forward< F >( work );
+      } else {
+         e = static_cast< std::uint32_t >( events.size() );
+         events.push_back( event{ at, none } );
+         actions.emplace_back( std::forward< F >( work ) );
+      }
+      events[ e ].at = at;
+      ++pending_;
+      insert( e );
+      if( pending_ > 2 * buckets.size() ){
+         resize( 2 * buckets.size() );
+      }
+   }
+
+   /// schedule an action after the delay d (from now)
+   template< typename F >
+   void schedule( const duration & d, F && work ){
+      schedule( now() + d, std::forward< F >( work ) );
+   }
+
+   /// the moment of the next event
+   ///
+   /// There must be a pending event.
+   moment next(){ return start_ + events[ first() ].at; }
+
+   /// run the next event, if any
+   ///
+   /// The result is whether there was an event.
+   bool step(){
+      if( pending_ == 0 ){
+         return false;
+      }
+      run_first();
+      return true;
+   }
+
+   /// run events until there are none, or an action calls stop()
+   ///
+   /// The result is the number of events that were run.
+   std::uint64_t run(){
+      const std::uint64_t before = processed_;
+      stopped = false;
+      while( ! stopped && pending_ > 0 ){
+         run_first();
+      }
+      return processed_ - before;
+   }
+
+   /// run the events at or before the moment t, then set now() to t
+   ///
+   /// When an action calls stop() no more events are run,
+   /// and now() stays at the moment of that event.
+   /// The result is the number of events that were run.
+   std::uint64_t run_until( const moment & t ){
+      const std::uint64_t before = processed_;
+      const duration end = t - start_;
+      stopped = false;
+      while( ! stopped && pending_ > 0 && ! ( end < events[ first() ].at ) ){
+         run_first();
+      }
+      if( ! stopped && now_ < end ){
+         now_ = end;
+      }
+      return processed_ - before;
+   }
+
+   /// run the events in the next duration d, then advance now() by d
+   std::uint64_t run_for( const duration & d ){
+      return run_until( now() + d );
+   }
+
+   /// wait until the moment t: run_until( t )
+   void wait( const moment & t ){ run_until( t ); }
+
+   /// wait for the duration d: run_for( d )
+   void wait( const duration & d ){ run_for( d ); }
+
+   /// make run(), run_until() or run_for() return
+   /// after the current event
+   void stop(){ stopped = true; }
+
+}; // template class simulator
+
+
+// ==========================================================================
+//
+// clock
+//
+// ==========================================================================
+
+/// the now() / wait() of a simulator (of this thread) as a clock
+template< typename D = std::chrono::nanoseconds, typename M = sim_tag >
+struct simulation_clock {
+
+   /// the durations
+   using duration = D;
+
+   /// the moments
+   using moment = torsor< D, M >;
+
+   /// the simulator
+   using simulator_type = simulator< D, M >;
+
+private:
+
+   static simulator_type *& current(){
+      static thread_local simulator_type * s = nullptr;
+      return s;
+   }
+
+public:
+
+   /// use the simulator s (on this thread)
+   static void use( simulator_type & s ){ current() = & s; }
+
+   /// the simulator that is used
+   static simulator_type & sim(){ return *current(); }
+
+   /// the current moment of the simulator
+   static moment now(){ return current()->now(); }
+
+   /// run the simulator until the moment t
+   static void wait( moment t ){ current()->wait( t ); }
+
+   /// run the simulator for the duration d
+   static void wait( duration d ){ current()->wait( d ); }
+};
+
+#endif // ifndef torsor_simulation_hpp
@@ -0,0 +1,349 @@
+// ==========================================================================
+//
+// torsor-split.hpp
+//
+// high precision two-part numbers (an integer anchor plus a
+// floating point offset) as base type for torsors,
+// and float offset batch kernels
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_split_hpp
+#define torsor_split_hpp
+
+/// @file
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include "torsor.hpp"
+
+// A torsor< double > of nanoseconds since 1970 has a resolution of
+// 256 ns, and a torsor< float > is useless for such moments.
+// A split< I, F > is an integer anchor I plus a floating point offset F:
+// the anchor holds the (large) integer part, the offset the
+// (small) rest, so the resolution depends only on the size
+// of the offset:
+//
+//    struct ns_tag {};
+//    using moment = torsor< split< int64_t, float >, ns_tag >;
+//
+//    moment t = moment() + 1'700'000'000'000'000'000;
+//    t += 0.25f;                    // exact
+//    float d = (float)( t - moment() - 1'700'000'000'000'000'000 ); // 0.25
+//
+// Adding or subtracting an integer changes only the anchor.
+// Adding or subtracting a floating point value changes only the
+// offset, unless the value is larger than the limit: then its
+// integer part is added to the anchor.
+// += and -= renormalize lazily: only when the magnitude of the offset
+// reaches the limit, its integer part is moved into the anchor.
+// The limit is 2^( digits of F - 8 ) (2^16 for a float, 2^45 for a
+// double), so the resolution of the offset is 2^-8 or better.
+// A floating point value that is added or subtracted must be
+// within the range of I (its integer part is converted to I).
+// Adding or subtracting two splits adds or subtracts the anchors
+// and the offsets, without renormalization.
+//
+// The batch kernels convert split torsors to float offsets from a
+// common integer anchor and back, and process arrays of such offsets:
+// those are float32 lanes, twice as many per vector as doubles.
+// The resolution of an offset o is ( o * 2^-23 ), so for a
+// resolution of 2^-8 (4 ps for ns) the offsets must stay below the limit
+// (65 us for ns): use a separate anchor for each chunk of a long capture.
+
+
+// ==========================================================================
+//
+// two-part number
+//
+// ==========================================================================
+
+/// integer anchor I plus floating point offset F
+template< typename I, typename F >
+class split final {
+public:
+
+   static_assert( std::is_integral_v< I > && std::is_floating_point_v< F >,
+      "a split is an integer anchor plus a floating point offset" );
+
+   /// the type of the anchor
+   using anchor_type = I;
+
+   /// the type of the offset
+   using offset_type = F;
+
+   /// the offset magnitude at which += and -= renormalize
+   static constexpr F limit = [](){
+      F x = 1;
+      for( int i = 0; i < std::numeric_limits< F >::digits - 8; ++i ){
+         x *= 2;
+      }
+      return x;
+   }();
+
+private:
+
+   I anchor_;
+   F offset_;
+
+   static constexpr bool small( F x ){
+      return ( x < limit ) && ( x > - limit );
+   }
+
+public:
+
+   /// zero
+   constexpr split(): anchor_( 0 ), offset_( 0 ){}
+
+   /// the value anchor + offset
+   ///
+   /// This conversion is implicit for a single (integer) argument,
+   /// because it is exact.
+   constexpr split( I anchor, F offset = 0 ):
+      anchor_( anchor ), offset_( offset )
+   {}
+
+   /// the anchor
+   constexpr I anchor() const { return anchor_; }
+
+   /// the offset
+   constexpr F offset() const { return offset_; }
+
+   /// move the integer part of the offset into the anchor
+   ///
+   /// This is exact: the new offset is the fraction of the old one.
+   constexpr void normalize(){
+      const I n = static_cast< I >( offset_ );
+      anchor_ += n;
+      offset_ -= static_cast< F >( n );
+   }
+
+   /// the value, rounded to the nearest integer
+   constexpr I rounded() const {
+      return anchor_ + static_cast< I >(
+         ( offset_ < 0 ) ? offset_ - F( 0.5 ) : offset_ + F( 0.5 ) );
+   }
+
+   /// the value as double
+   constexpr explicit operator double() const {
+      return static_cast< double >( anchor_ ) + offset_;
+   }
+
+   /// add an integer or floating point value
+   ///
+   /// A floating point value must be within the range of I.
+   template< typename D >
+   ///@cond INTERNAL
+   requires std::is_arithmetic_v< D >
+   ///@endcond
+   friend constexpr split operator+( const split & left, const D & right ){
+      if constexpr ( std::is_integral_v< D > ){
+         return split( left.anchor_ + right, left.offset_ );
+      } else {
+         if( ( right < limit ) && ( right > - limit ) ){
+            return split( left.anchor_, left.offset_ + static_cast< F >( right ) );
+         }
+         const I n = static_cast< I >( right );
+         return split( left.anchor_ + n,
+            left.offset_ + static_cast< F >( right - static_cast< D >( n ) ) );
+      }
+   }
+
+   /// add to an integer or floating point value
+   template< typename D >
+   ///@cond INTERNAL
+   requires std::is_arithmetic_v< D >
+   ///@endcond
+   friend constexpr split operator+( const D & left, const split & right ){
+      return right + left;
+   }
+
+   /// subtract an integer or floating point value
+   ///
+   /// A floating point value must be within the range of I.
+   /// The value is not negated (which would wrap an unsigned D):
+   /// its parts are subtracted from the anchor and the offset.
+   template< typename D >
+   ///@cond INTERNAL
+   requires std::is_arithmetic_v< D >
+   ///@endcond
+   friend constexpr split operator-( const split & left, const D & right ){
+      if constexpr ( std::is_integral_v< D > ){
+         return split( left.anchor_ - static_cast< I >( right ), left.offset_ );
+      } else {
+         if( ( right < limit ) && ( right > - limit ) ){
+            return split( left.anchor_, left.offset_ - static_cast< F >( right ) );
+         }
+         const I n = static_cast< I >( right );
+         return split( left.anchor_ - n,
+            left.offset_ - static_cast< F >( right - static_cast< D >( n ) ) );
+      }
+   }
+
+   /// add two splits (without renormalization)
+   friend constexpr split operator+( const split & left, const split & right ){
+      return split( left.anchor_ + right.anchor_, left.offset_ + right.offset_ );
+   }
+
+   /// subtract two splits (without renormalization)
+   friend constexpr split operator-( const split & left, const split & right ){
+      return split( left.anchor_ - right.anchor_, left.offset_ - right.offset_ );
+   }
+
+   /// negate
+   friend constexpr split operator-( const split & x ){
+      return split( - x.anchor_, - x.offset_ );
+   }
+
+   /// update add, renormalize when the offset reaches the limit
+   template< typename D >
+   constexpr split & operator+=( const D & right ){
+      *this = *this + right;
+      if( ! small( offset_ ) ){
+         normalize();
+      }
+      return *this;
+   }
+
+   /// update subtract, renormalize when the offset reaches the limit
+   template< typename D >
+   constexpr split & operator-=( const D & right ){
+      *this = *this - right;
+      if( ! small( offset_ ) ){
+         normalize();
+      }
+      return *this;
+   }
+
+private:
+
+   // the magnitude of the difference of two anchors, computed in the
+   // unsigned type, so it wraps neither for a signed nor for an
+   // unsigned I
+   static constexpr F distance( I low, I high ){
+      using U = std::make_unsigned_t< I >;
+      return static_cast< F >( static_cast< U >(
+         static_cast< U >( high ) - static_cast< U >( low ) ) );
+   }
+
+   // the sign of this difference is the sign of ( left - right ):
+   // the difference of the anchors is converted to F with its sign,
+   // and then the difference of the offsets (which need not be small,
+   // a split that was constructed or added isn't normalized) is added
+   static constexpr F compare( const split & left, const split & right ){
+      const F anchors = ( left.anchor_ < right.anchor_ )
+         ? - distance( left.anchor_, right.anchor_ )
+         : distance( right.anchor_, left.anchor_ );
+      return anchors + ( left.offset_ - right.offset_ );
+   }
+
+public:
+
+   /// compare equal
+   friend constexpr bool operator==( const split & left, const split & right ){
+      return compare( left, right ) == 0;
+   }
+
+   /// compare unequal
+   friend constexpr bool operator!=( const split & left, const split & right ){
+      return compare( left, right ) != 0;
+   }
+
+   /// compare smaller
+   friend constexpr bool operator<( const split & left, const split & right ){
+      return compare( left, right ) < 0;
+   }
+
+   /// compare smaller or equal
+   friend constexpr bool operator<=( const split & left, const split & right ){
+      return compare( left, right ) <= 0;
+   }
+
+   /// compare larger
+   friend constexpr bool operator>( const split & left, const split & right ){
+      return compare( left, right ) > 0;
+   }
+
+   /// compare larger or equal
+   friend constexpr bool operator>=( const split & left, const split & right ){
+      return compare( left, right ) >= 0;
+   }
+
+}; // template class split
+
+
+// ==========================================================================
+//
+// batch kernels
+//
+// These are plain loops without branches or calls in the loop body,
+// which the compiler vectorizes at -O2 / -O3 for the target at hand.
+//
+// ==========================================================================
+
+/// narrow n split torsors to F offsets from an integer anchor
+///
+/// Each out[ i ] is set to ( in[ i ] - anchor ), as F.
+/// The result is whether all offsets are below the limit
+/// (so their resolution is 2^-8 or better).
+/// All elements are stored regardless of the result.
+template< typename I, typename F, typename M >
+bool split_narrow(
+   const torsor< I, M > & anchor,
+   const torsor< split< I, F >, M > * in, F * out, std::size_t n
+){
+   const torsor< split< I, F >, M > zero;
+   const I a = anchor - torsor< I, M >();
+   bool bad = false;
+   for( std::size_t i = 0; i < n; ++i ){
+      const split< I, F > s = in[ i ] - zero;
+      const F o = static_cast< F >( s.anchor() - a ) + s.offset();
+      bad |= ! ( ( o < split< I, F >::limit ) && ( o > - split< I, F >::limit ) );
+      out[ i ] = o;
+   }
+   return ! bad;
+}
+
+/// widen n F offsets from an integer anchor to split torsors
+///
+/// Each out[ i ] is set to the anchor plus the offset in[ i ].
+template< typename I, typename F, typename M >
+void split_widen(
+   const torsor< I, M > & anchor,
+   const F * in, torsor< split< I, F >, M > * out, std::size_t n
+){
+   const torsor< split< I, F >, M > zero;
+   const I a = anchor - torsor< I, M >();
+   for( std::size_t i = 0; i < n; ++i ){
+      out[ i ] = zero + split< I, F >( a, in[ i ] );
+   }
+}
+
+/// shift n offsets by the same amount
+template< typename F >
+void split_shift( F * offsets, std::size_t n, F shift ){
+   for( std::size_t i = 0; i < n; ++i ){
+      offsets[ i ] += shift;
+   }
+}
+
+/// the n - 1 differences of n consecutive offsets
+///
+/// Each out[ i ] is set to in[ i + 1 ] - in[ i ].
+/// The in and out ranges must not overlap.
+template< typename F >
+void split_deltas( const F * in, F * out, std::size_t n ){
+   for( std::size_t i = 0; i + 1 < n; ++i ){
+      out[ i ] = in[ i + 1 ] - in[ i ];
+   }
+}
+
+#endif // ifndef torsor_split_hpp
@@ -0,0 +1,272 @@
+// ==========================================================================
+//
+// torsor-sync.hpp
+//
+// clock-domain synchronization: estimate the offset and drift between
+// two clocks, and map (batches of) torsors from one clock to the other
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_sync_hpp
+#define torsor_sync_hpp
+
+/// @file
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include "torsor.hpp"
+
+// The moments of two clocks are torsors with different tags,
+// for instance torsor< int64_t, device_tag > and
+// torsor< int64_t, host_tag >, so they can't be mixed by accident:
+// a clock_mapping is the only way from one to the other.
+//
+// A mapping is linear around an anchor pair:
+//
+//    to = to_anchor + d + d * drift,   with d = from - from_anchor
+//
+// The drift is small (parts per million), so d * drift is small,
+// and the double multiplication loses no significant precision,
+// even for nanosecond timestamps since 1970.
+//
+// A clock_sync fits the mapping to pairs of (from, to) samples,
+// with an online (weighted) linear regression of the offset
+// ( to - from ) on from. Samples with a residual that is too large
+// (for instance a delayed message) are rejected.
+
+
+// ==========================================================================
+//
+// mapping
+//
+// ==========================================================================
+
+/// linear mapping of torsor< T, FROM > moments to torsor< T, TO >
+template< typename T, typename FROM, typename TO >
+class clock_mapping final {
+public:
+
+   /// the moments of the clock that is mapped from
+   using from_moment = torsor< T, FROM >;
+
+   /// the moments of the clock that is mapped to
+   using to_moment = torsor< T, TO >;
+
+private:
+
+   from_moment from_anchor;
+   to_moment to_anchor;
+   double drift_;
+
+public:
+
+   /// the identity mapping (of the anchors)
+   clock_mapping():
+      from_anchor(), to_anchor(), drift_( 0.0 )
+   {}
+
+   /// the mapping that maps from_anchor to to_anchor, with a drift
+   clock_mapping(
+      const from_moment & from_anchor,
+      const to_moment & to_anchor,
+      double drift = 0.0
+   ):
+      from_anchor( from_anchor ), to_anchor( to_anchor ), drift_( drift )
+   {}
+
+   /// the drift: ( rate of the to clock / rate of the from clock ) - 1
+   double drift() const { return drift_; }
+
+   /// map a moment
+   ///
+   /// The d * drift term is truncated (towards zero),
+   /// exactly like convert() does.
+   to_moment operator()( const from_moment & t ) const {
+      const T d = t - from_anchor;
+      return to_anchor + ( d + static_cast< T >( d * drift_ ) );
+   }
+
+   /// map n moments
+   ///
+   /// The loop has no branches and no calls, only a subtraction,
+   /// a multiplication (with its conversions) and an addition per
+   /// element, so the compiler can vectorize it (on x86, the int64_t 
+   /// to and from double conversions need AVX-512DQ).
+   /// The in and out ranges may be the same, but must not
+   /// otherwise overlap.
+   void convert(
+      const from_moment * in, to_moment * out, std::size_t n
+   ) const {
+      const from_moment from = from_anchor;
+      const to_moment to = to_anchor;
+      const double drift = drift_;
+      for( std::size_t i = 0; i < n; ++i ){
+         const T d = in[ i ] - from;
+         out[ i ] = to + ( d + static_cast< T >( d * drift ) );
+      }
+   }
+
+}; // template class clock_mapping
+
+
+// ==========================================================================
+//
+// estimator
+//
+// ==========================================================================
+
+/// online estimator of the clock_mapping between two clocks
+///
+/// Add pairs of moments that (are believed to) coincide,
+/// and get the mapping that best fits them.
+///
+/// With a forgetting factor below 1, older samples weigh less,
+/// so the mapping follows a slowly changing drift.
+///
+/// After warmup samples, a sample with a residual of more than
+/// outlier_limit times the (weighted) rms residual (or more than the
+/// tolerance, when that is larger) is rejected.
+/// The tolerance keeps perfect samples from rejecting the
+/// rounding of later samples.
+/// After max_rejects consecutive rejections the clock is assumed to
+/// have stepped: the estimator restarts from the next sample.
+template< typename T, typename FROM, typename TO >
+class clock_sync final {
+public:
+
+   /// the moments of the clock that is mapped from
+   using from_moment = torsor< T, FROM >;
+
+   /// the moments of the clock that is mapped to
+   using to_moment = torsor< T, TO >;
+
+   /// the mapping
+   using mapping = clock_mapping< T, FROM, TO >;
+
+private:
+
+   const double outlier_limit;
+   const double forgetting;
+   const double tolerance;
+   const std::size_t warmup;
+   const std::size_t max_rejects;
+
+   // the first sample: the origin of x and y
+   from_moment from0;
+   to_moment to0;
+
+   // weighted means and co-moments of x = from - from0
+   // and y = ( to - to0 ) - x
+   std::size_t n;
+   double w, mean_x, mean_y, c_xx, c_xy;
+
+   // weighted mean square of the residuals of accepted samples
+   double w_residuals, residuals;
+
+   std::size_t rejected_, consecutive;
+
+   double offset_at( double x ) const {
+      return mean_y + drift() * ( x - mean_x );
+   }
+
+public:
+
+   /// create an estimator
+   clock_sync(
+      double outlier_limit = 4.0,
+      double forgetting = 1.0,
+      T tolerance = T( 1 ),
+      std::size_t warmup = 8,
+      std::size_t max_rejects = 16
+   ):
+      outlier_limit( outlier_limit ), forgetting( forgetting ),
+      tolerance( (double) tolerance ),
+      warmup( warmup ), max_rejects( max_rejects ),
+      rejected_( 0 )
+   {
+      reset();
+   }
+
+   /// forget all samples
+   void reset(){
+      n = 0;
+      w = mean_x = mean_y = c_xx = c_xy = 0.0;
+      w_residuals = residuals = 0.0;
+      consecutive = 0;
+   }
+
+   /// add a sample: the from and to moments coincide
+   ///
+   /// The result is false when the sample was rejected as an outlier.
+   bool add( const from_moment & from, const to_moment & to ){
+      if( n == 0 ){
+         from0 = from;
+         to0 = to;
+      }
+      const double x = (double) ( from - from0 );
+      const double y = (double) ( to - to0 ) - x;
+
+      if( n >= warmup ){
+         const double r = y - offset_at( x );
+         const double limit = outlier_limit * std::sqrt( residuals );
+         if( std::fabs( r ) > std::fmax( limit, tolerance ) ){
+            ++rejected_;
+            if( ++consecutive >= max_rejects ){
+               reset();
+            }
+            return false;
+         }
+      }
+      consecutive = 0;
+
+      if( n > 0 ){
+         const double r = y - offset_at( x );
+         w_residuals = forgetting * w_residuals + 1.0;
+         residuals += ( r * r - residuals ) / w_residuals;
+      }
+
+      // weighted Welford update
+      w = forgetting * w + 1.0;
+      c_xx *= forgetting;
+      c_xy *= forgetting;
+      const double dx = x - mean_x;
+      mean_x += dx / w;
+      mean_y += ( y - mean_y ) / w;
+      c_xx += dx * ( x - mean_x );
+      c_xy += dx * ( y - mean_y );
+      ++n;
+      return true;
+   }
+
+   /// the number of samples that are used (since the last restart)
+   std::size_t samples() const { return n; }
+
+   /// the number of rejected samples
+   std::size_t rejected() const { return rejected_; }
+
+   /// the estimated drift
+   double drift() const {
+      return ( c_xx > 0.0 ) ? c_xy / c_xx : 0.0;
+   }
+
+   /// the mapping that fits the samples
+   ///
+   /// The anchors are at the (weighted) mean of the samples,
+   /// where the fit is most accurate.
+   mapping get() const {
+      const T x = static_cast< T >( std::llround( mean_x ) );
+      const T y = static_cast< T >( std::llround( offset_at( (double) x ) ) );
+      return mapping( from0 + x, to0 + ( x + y ), drift() );
+   }
+
+}; // template class clock_sync
+
+#endif // ifndef torsor_sync_hpp
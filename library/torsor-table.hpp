@@ -0,0 +1,107 @@
+// ==========================================================================
+//
+// torsor-table.hpp
+//
+// compile-time tables of torsors:
+// progressions, schedules and lookup
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_table_hpp
+#define torsor_table_hpp
+
+/// @file
+
+#include <cstddef>
+#include <array>
+#include "torsor.hpp"
+
+// All torsor operations are constexpr, so tables of torsors can be
+// computed by the compiler. Declared as
+//
+//    static constexpr auto table = torsor_progression< 8 >( start, step );
+//
+// a table is checked with static_assert, and placed in read-only
+// memory (.rodata, which is ROM on a micro-controller), so it costs
+// no startup time and no RAM.
+//
+// The elements of a table are of the type of the start torsor:
+// like +=, the additions are narrowed to its base type.
+
+
+/// the table start, start + step, ... start + ( N - 1 ) * step
+template< std::size_t N, typename T, typename M, typename D >
+constexpr std::array< torsor< T, M >, N > torsor_progression(
+   const torsor< T, M > & start, const D & step
+){
+   std::array< torsor< T, M >, N > table{};
+   torsor< T, M > t = start;
+   for( std::size_t i = 0; i < N; ++i ){
+      table[ i ] = t;
+      t += step;
+   }
+   return table;
+}
+
+/// the moments of a schedule of N durations
+///
+/// The first moment is the start, each next moment is one
+/// duration after the previous one, so the result has N + 1 moments
+/// (the last one is the end of the schedule).
+template< typename T, typename M, typename D, std::size_t N >
+constexpr std::array< torsor< T, M >, N + 1 > torsor_schedule(
+   const torsor< T, M > & start, const std::array< D, N > & durations
+){
+   std::array< torsor< T, M >, N + 1 > table{};
+   torsor< T, M > t = start;
+   table[ 0 ] = t;
+   for( std::size_t i = 0; i < N; ++i ){
+      t += durations[ i ];
+      table[ i + 1 ] = t;
+   }
+   return table;
+}
+
+/// the table start + offsets[ 0 ], ... start + offsets[ N - 1 ]
+template< typename T, typename M, typename D, std::size_t N >
+constexpr std::array< torsor< T, M >, N > torsor_offsets(
+   const torsor< T, M > & start, const std::array< D, N > & offsets
+){
+   std::array< torsor< T, M >, N > table{};
+   for( std::size_t i = 0; i < N; ++i ){
+      torsor< T, M > t = start;
+      t += offsets[ i ];
+      table[ i ] = t;
+   }
+   return table;
+}
+
+/// the index of the last entry of a non-decreasing table that
+/// is not after t, or N when t is before the first entry
+///
+/// This is a binary search, which can also be done at compile time.
+template< typename T, typename M, std::size_t N >
+constexpr std::size_t torsor_lookup(
+   const std::array< torsor< T, M >, N > & table, const torsor< T, M > & t
+){
+   // the number of entries that are not after t
+   std::size_t low = 0, high = N;
+   while( low < high ){
+      const std::size_t middle = low + ( high - low ) / 2;
+      if( table[ middle ] <= t ){
+         low = middle + 1;
+      } else {
+         high = middle;
+      }
+   }
+   return ( low == 0 ) ? N : low - 1;
+}
+
+#endif // ifndef torsor_table_hpp
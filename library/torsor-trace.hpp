@@ -0,0 +1,369 @@
+// ==========================================================================
+//
+// torsor-trace.hpp
+//
+// per-thread trace event recorder, with torsor timestamps,
+// and Chrome / Perfetto trace (JSON) output
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_trace_hpp
+#define torsor_trace_hpp
+
+/// @file
+
+#include <cstdint>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "torsor.hpp"
+#include "torsor-clock.hpp"
+
+// Each thread appends its events to its own ring buffer.
+// The thread is the only writer of its buffer, and the collector
+// is the only reader, so the hot path needs no lock and no
+// read-modify-write atomic: a plain store of the event, and a
+// release store of the head.
+// When a buffer is full, new events are dropped (and counted)
+// rather than blocking the thread.
+//
+// The collector (called on demand, or from a background thread)
+// drains all buffers and merges the events in torsor order.
+// write_json() writes them as Chrome / Perfetto trace JSON.
+//
+// When a thread ends, its buffer is retired. Once its events have
+// been collected it is reused (with its thread number) by a new
+// thread, so the number of buffers is the largest number of threads
+// that traced at the same time. The thread numbers are 16 bits: the
+// events of threads beyond 65535 buffers are dropped.
+//
+// Defining TORSOR_TRACE_DISABLED (before including this file)
+// replaces the tracer by one with only empty functions: no registry,
+// no buffers and no thread_local, so the tracing code disappears
+// from the application.
+
+
+/// a trace event
+template< typename MOMENT >
+struct trace_event {
+
+   /// the kinds of event
+   enum class kinds : std::uint8_t { begin, end, instant };
+
+   /// when it happened
+   MOMENT moment;
+
+   /// the name, as a name id
+   std::uint32_t name;
+
+   /// the (tracer) thread number
+   std::uint16_t thread;
+
+   /// begin, end or instant
+   kinds kind;
+};
+
+
+#ifndef TORSOR_TRACE_DISABLED
+
+/// per-thread trace recorder
+//
+/// The tracer is a template on a clock C (see torsor-clock.hpp),
+/// and has only static members:
+/// there is one tracer for each clock and buffer size N.
+/// N must be a power of 2.
+template< typename C = steady_clock_source, std::size_t N = 4096 >
+class tracer final {
+public:
+
+   /// the moments of the clock
+   using moment = typename C::moment;
+
+   /// a trace event
+   using event = trace_event< moment >;
+
+private:
+
+   static_assert( ( N & ( N - 1 ) ) == 0, "N must be a power of 2" );
+
+   struct buffer {
+      event events[ N ];
+      std::atomic< std::uint64_t > head{ 0 };
+      std::atomic< std::uint64_t > tail{ 0 };
+      std::atomic< std::uint64_t > dropped{ 0 };
+      std::atomic< bool > retired{ false };
+      std::uint16_t thread;
+   };
+
+   struct registry {
+      std::mutex lock;
+      std::vector< std::unique_ptr< buffer > > buffers;
+      std::vector< std::string > names;
+      std::atomic< std::uint64_t > dropped{ 0 };
+   };
+
+   static registry & the_registry(){
+      static registry r;
+      return r;
+   }
+
+   // retires the buffer of a thread when the thread ends: the buffer
+   // stays in the registry, so its last events can still be collected
+   struct owner {
+      buffer * b = nullptr;
+      ~owner(){
+         if( b != nullptr ){
+            b->retired.store( true, std::memory_order_release );
+         }
+      }
+   };
+
+   // a retired buffer of which all events have been collected,
+   // or else a new buffer (nullptr when there are too many)
+   static buffer * claim(){
+      auto & r = the_registry();
+      std::lock_guard< std::mutex > guard( r.lock );
+      for( auto & b : r.buffers ){
+         if( b->retired.load( std::memory_order_acquire )
+            && ( b->head.load( std::memory_order_relaxed )
+               == b->tail.load( std::memory_order_relaxed ) )
+         ){
+            b->retired.store( false, std::memory_order_relaxed );
+            return b.get();
+         }
+      }
+      if( r.buffers.size() >= 0xFFFF ){
+         return nullptr;
+      }
+      r.buffers.push_back( std::make_unique< buffer >() );
+      r.buffers.back()->thread = (std::uint16_t) r.buffers.size();
+      return r.buffers.back().get();
+   }
+
+   static buffer * local(){
+      thread_local owner o;
+      if( o.b == nullptr ){
+         o.b = claim();
+      }
+      return o.b;
+   }
+
+   static std::string escaped( const std::string & s ){
+      static const char hex[] = "0123456789abcdef";
+      std::string r;
+      for( char c : s ){
+         const unsigned char u = (unsigned char) c;
+         if( ( c == '"' ) || ( c == '\\' ) ){
+            r += '\\';
+            r += c;
+         } else if( c == '\n' ){
+            r += "\\n";
+         } else if( c == '\t' ){
+            r += "\\t";
+         } else if( c == '\r' ){
+            r += "\\r";
+         } else if( u < 0x20 ){
+            r += "\\u00";
+            r += hex[ u >> 4 ];
+            r += hex[ u & 0x0F ];
+         } else {
+            r += c;
+         }
+      }
+      return r;
+   }
+
+   static void record( std::uint32_t name, typename event::kinds kind ){
+      buffer * b = local();
+      if( b == nullptr ){
+         the_registry().dropped.fetch_add( 1, std::memory_order_relaxed );
+         return;
+      }
+      const auto h = b->head.load( std::memory_order_relaxed );
+      if( h - b->tail.load( std::memory_order_acquire ) == N ){
+         b->dropped.fetch_add( 1, std::memory_order_relaxed );
+         return;
+      }
+      b->events[ h & ( N - 1 ) ] = event{ C::now(), name, b->thread, kind };
+      b->head.store( h + 1, std::memory_order_release );
+   }
+
+public:
+
+   /// the id for a name
+   ///
+   /// This takes a lock: call it once for each name,
+   /// not on the hot path.
+   static std::uint32_t id( const std::string & name ){
+      auto & r = the_registry();
+      std::lock_guard< std::mutex > guard( r.lock );
+      auto p = std::find( r.names.begin(), r.names.end(), name );
+      if( p != r.names.end() ){
+         return p - r.names.begin();
+      }
+      r.names.push_back( name );
+      return r.names.size() - 1;
+   }
+
+   /// the name for an id
+   static std::string name( std::uint32_t id ){
+      auto & r = the_registry();
+      std::lock_guard< std::mutex > guard( r.lock );
+      return ( id < r.names.size() ) ? r.names[ id ] : std::to_string( id );
+   }
+
+   /// record the begin of a slice
+   static void begin( std::uint32_t name ){
+      record( name, event::kinds::begin );
+   }
+
+   /// record the end of a slice
+   static void end( std::uint32_t name ){
+      record( name, event::kinds::end );
+   }
+
+   /// record an instant event
+   static void instant( std::uint32_t name ){
+      record( name, event::kinds::instant );
+   }
+
+   /// begin() and end() of a slice, as a scope guard
+   class scope final {
+   private:
+      std::uint32_t name;
+
+   public:
+      scope( std::uint32_t name ): name( name ){ begin( name ); }
+      ~scope(){ end( name ); }
+      scope( const scope & ) = delete;
+      scope & operator=( const scope & ) = delete;
+   };
+
+   /// the number of events that were dropped because a buffer was full
+   static std::uint64_t dropped(){
+      auto & r = the_registry();
+      std::lock_guard< std::mutex > guard( r.lock );
+      std::uint64_t n = r.dropped.load( std::memory_order_relaxed );
+      for( auto & b : r.buffers ){
+         n += b->dropped.load( std::memory_order_relaxed );
+      }
+      return n;
+   }
+
+   /// move the recorded events to the end of out, in torsor order
+   ///
+   /// The events of each thread are already in order,
+   /// so each collected part is merged into the result.
+   static void collect( std::vector< event > & out ){
+      auto & r = the_registry();
+      std::lock_guard< std::mutex > guard( r.lock );
+      const std::size_t first = out.size();
+      for( auto & b : r.buffers ){
+         const auto h = b->head.load( std::memory_order_acquire );
+         auto t = b->tail.load( std::memory_order_relaxed );
+         const std::size_t middle = out.size();
+         for( ; t != h; ++t ){
+            out.push_back( b->events[ t & ( N - 1 ) ] );
+         }
+         b->tail.store( t, std::memory_order_release );
+         std::inplace_merge(
+            out.begin() + first, out.begin() + middle, out.end(),
+            []( const event & a, const event & b ){
+               return a.moment < b.moment; } );
+      }
+   }
+
+   /// write events as Chrome / Perfetto trace JSON
+   ///
+   /// The timestamps are written in microseconds
+   /// since the first event.
+   /// This requires that the duration of the clock is a 
+   /// std::chrono::duration.
+   static void write_json( std::ostream & s, const std::vector< event > & events ){
+      s << "{\"traceEvents\":[";
+      const moment zero = events.empty() ? moment() : events.front().moment;
+      const char * separator = "\n";
+      for( auto & e : events ){
+         const auto ns = std::chrono::duration_cast<
+            std::chrono::nanoseconds >( e.moment - zero ).count();
+         s << separator
+           << "{\"name\":\"" << escaped( name( e.name ) ) << "\",\"ph\":\""
+           << ( e.kind == event::kinds::begin ? 'B'
+              : e.kind == event::kinds::end ? 'E' : 'i' )
+           << "\",\"ts\":" << ns / 1000 << '.'
+           << (char)( '0' + ns / 100 % 10 )
+           << (char)( '0' + ns / 10 % 10 )
+           << (char)( '0' + ns % 10 )
+           << ",\"pid\":1,\"tid\":" << e.thread
+           << ( e.kind == event::kinds::instant ? ",\"s\":\"t\"" : "" )
+           << "}";
+         separator = ",\n";
+      }
+      s << "\n]}\n";
+   }
+
+}; // template class tracer
+
+#else // ifndef TORSOR_TRACE_DISABLED
+
+/// the per-thread trace recorder, disabled: it records nothing
+template< typename C = steady_clock_source, std::size_t N = 4096 >
+class tracer final {
+public:
+
+   /// the moments of the clock
+   using moment = typename C::moment;
+
+   /// a trace event
+   using event = trace_event< moment >;
+
+   /// the id for a name (always 0)
+   static std::uint32_t id( const std::string & ){ return 0; }
+
+   /// the name for an id (the id)
+   static std::string name( std::uint32_t id ){ return std::to_string( id ); }
+
+   /// does nothing
+   static void begin( std::uint32_t ){}
+
+   /// does nothing
+   static void end( std::uint32_t ){}
+
+   /// does nothing
+   static void instant( std::uint32_t ){}
+
+   /// does nothing
+   class scope final {
+   public:
+      scope( std::uint32_t ){}
+      scope( const scope & ) = delete;
+      scope & operator=( const scope & ) = delete;
+   };
+
+   /// no events are dropped
+   static std::uint64_t dropped(){ return 0; }
+
+   /// there are no events
+   static void collect( std::vector< event > & ){}
+
+   /// write an empty trace
+   static void write_json( std::ostream & s, const std::vector< event > & ){
+      s << "{\"traceEvents\":[\n]}\n";
+   }
+
+}; // template class tracer
+
+#endif // ifndef TORSOR_TRACE_DISABLED
+
+#endif // ifndef torsor_trace_hpp
@@ -0,0 +1,233 @@
+// ==========================================================================
+//
+// torsor-unwrap.hpp
+//
+// extension of the readings of a narrow wrapping counter
+// (a hardware timer, a capture timestamp) to 64-bit torsors
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_unwrap_hpp
+#define torsor_unwrap_hpp
+
+/// @file
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "torsor.hpp"
+
+// A hardware timer or a capture format often has a counter of
+// only 16, 24 or 32 bits, that wraps around to 0 after 2^N ticks.
+// An unwrapper extends each reading to a torsor< int64_t, M >
+// (which doesn't wrap in any practical time), by remembering the
+// last extended value: the distance from its low N bits to the
+// new reading (modulo 2^N) is the number of ticks since then.
+//
+//    struct tick_tag {};
+//    counter_unwrapper< std::uint32_t, tick_tag > timer;
+//
+//    torsor< std::int64_t, tick_tag > t = timer.update( read_timer() );
+//
+// The extended value of a reading has the reading as its low N bits.
+// The counter must be read at least once for each 2^N ticks,
+// else a whole period is missed.
+//
+// A counter_unwrapper expects its readings in order (it is not
+// thread safe), so each reading is at or after the previous one.
+//
+// An atomic_counter_unwrapper can be updated concurrently, from
+// threads and from interrupts. A reading that was made before the
+// last update (because the reader was interrupted between reading
+// the counter and the update) is then possible: it gives a moment
+// slightly before the last one, and it doesn't change the state.
+// So the distance is taken as a signed N-bit value, and the
+// counter must be read at least once for each 2^( N - 1 ) ticks.
+// The state is a single std::atomic< std::int64_t >, updated with a
+// compare-and-swap: lock-free (and so safe to use from an interrupt)
+// where such an atomic is lock-free (is_lock_free is true).
+//
+// The batch update extends an array of readings (captured in order)
+// in chunks: in a chunk, a wrap shows as a reading that is lower
+// than the previous one. Most chunks have no wrap: those are
+// extended by adding the same 64-bit value to each reading.
+// The compiler vectorizes that loop (the additions, and the search
+// for a wrap). Only a chunk with a wrap is done again, one reading
+// at a time.
+
+
+// ==========================================================================
+//
+// unwrapper
+//
+// ==========================================================================
+
+/// extends the readings of an N-bit wrapping counter
+/// (stored in the unsigned integer C) to torsor< std::int64_t, M >
+template< typename C, typename M = void, int N = 8 * sizeof( C ) >
+class counter_unwrapper final {
+public:
+
+   static_assert( std::is_unsigned_v< C > && ( N >= 1 ) && ( N <= 32 )
+      && ( N <= 8 * (int) sizeof( C ) ),
+      "the counter must be an unsigned integer of (at most) 32 bits" );
+
+   /// the extended readings
+   using moment = torsor< std::int64_t, M >;
+
+   /// the number of ticks after which the counter wraps
+   static constexpr std::int64_t period = std::int64_t( 1 ) << N;
+
+private:
+
+   static constexpr std::int64_t mask = period - 1;
+
+   static constexpr std::size_t chunk = 256;
+
+   std::int64_t last_;
+
+public:
+
+   /// an unwrapper, for a first reading at most a period after start
+   explicit constexpr counter_unwrapper( const moment & start = moment() ):
+      last_( start - moment() )
+   {}
+
+   /// the extended last reading (or the start)
+   constexpr moment last() const { return moment() + last_; }
+
+   /// extend a reading, which must be at or after the previous one
+   constexpr moment update( C reading ){
+      last_ += ( std::int64_t( reading ) - last_ ) & mask;
+      return moment() + last_;
+   }
+
+   /// extend n readings, which must be in order
+   ///
+   /// The in and out ranges must not overlap.
+   void update( const C * in, moment * out, std::size_t n ){
+      if( n == 0 ){
+         return;
+      }
+
+      // the first reading by itself, so each chunk has a reading before it
+      out[ 0 ] = update( in[ 0 ] );
+      std::size_t i = 1;
+      for( ; i + chunk <= n; i += chunk ){
+         update_chunk< chunk >( in + i, out + i );
+      }
+      for( ; i < n; ++i ){
+         out[ i ] = update( in[ i ] );
+      }
+   }
+
+private:
+
+   // extend the S readings at p, as if they are all in the period
+   // of the last reading, and check that: a reading that is lower
+   // than the one before it (p[ -1 ] must exist) is a wrap, and
+   // then the chunk is done again, one reading at a time.
+   // The loop runs exactly S times, which the compiler vectorizes
+   // also with its cheapest cost model (the default at -O2).
+   template< std::size_t S >
+   void update_chunk( const C * p, moment * out ){
+      const std::int64_t base = last_ - ( last_ & mask );
+      const moment b = moment() + base;
+      C wraps = 0;
+      for( std::size_t j = 0; j < S; ++j ){
+         out[ j ] = b + std::int64_t( p[ j ] );
+         wraps |= C( p[ j ] < p[ j - 1 ] );
+      }
+      if( wraps == 0 ){
+         last_ = base + std::int64_t( p[ S - 1 ] );
+      } else {
+         for( std::size_t j = 0; j < S; ++j ){
+            out[ j ] = update( p[ j ] );
+         }
+      }
+   }
+
+}; // template class counter_unwrapper
+
+
+// ==========================================================================
+//
+// atomic unwrapper
+//
+// ==========================================================================
+
+/// extends the readings of an N-bit wrapping counter
+/// (stored in the unsigned integer C) to torsor< std::int64_t, M >,
+/// from concurrent threads and interrupts
+template< typename C, typename M = void, int N = 8 * sizeof( C ) >
+class atomic_counter_unwrapper final {
+public:
+
+   static_assert( std::is_unsigned_v< C > && ( N >= 2 ) && ( N <= 32 )
+      && ( N <= 8 * (int) sizeof( C ) ),
+      "the counter must be an unsigned integer of (at most) 32 bits" );
+
+   /// the extended readings
+   using moment = torsor< std::int64_t, M >;
+
+   /// the number of ticks after which the counter wraps
+   static constexpr std::int64_t period = std::int64_t( 1 ) << N;
+
+   /// whether update() is lock-free (and so safe from an interrupt)
+   static constexpr bool is_lock_free =
+      std::atomic< std::int64_t >::is_always_lock_free;
+
+private:
+
+   static constexpr std::int64_t mask = period - 1;
+   static constexpr std::int64_t half = period / 2;
+
+   std::atomic< std::int64_t > last_;
+
+public:
+
+   /// an unwrapper, for a first reading
+   /// less than half a period before or after start
+   explicit atomic_counter_unwrapper( const moment & start = moment() ):
+      last_( start - moment() )
+   {}
+
+   atomic_counter_unwrapper( const atomic_counter_unwrapper & ) = delete;
+   atomic_counter_unwrapper & operator=(
+      const atomic_counter_unwrapper & ) = delete;
+
+   /// the latest extended reading (or the start)
+   moment last() const {
+      return moment() + last_.load( std::memory_order_acquire );
+   }
+
+   /// extend a reading
+   ///
+   /// The reading must be less than half a period
+   /// before or after the latest update.
+   moment update( C reading ){
+      std::int64_t last = last_.load( std::memory_order_acquire );
+      for(;;){
+         // the signed N-bit distance
+         const std::int64_t d =
+            ( ( ( std::int64_t( reading ) - last ) & mask ) ^ half ) - half;
+         const std::int64_t t = last + d;
+         if( ( d <= 0 ) || last_.compare_exchange_weak(
+            last, t, std::memory_order_acq_rel, std::memory_order_acquire )
+         ){
+            return moment() + t;
+         }
+      }
+   }
+
+}; // template class atomic_counter_unwrapper
+
+#endif // ifndef torsor_unwrap_hpp
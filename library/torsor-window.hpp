@@ -0,0 +1,290 @@
+// ==========================================================================
+//
+// torsor-window.hpp
+//
+// sliding-window aggregation (count, sum, min, max)
+// of values at torsor moments
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#ifndef torsor_window_hpp
+#define torsor_window_hpp
+
+/// @file
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "torsor.hpp"
+
+// Both windows use only fixed-size storage (no heap),
+// the sizes are template parameters.
+
+
+// ==========================================================================
+//
+// exact sliding window
+//
+// ==========================================================================
+
+/// exact sliding window over (at most) N events
+//
+/// The window contains the events (moment, value) that were added
+/// with a moment in ( t - width, t ], where t is the latest moment
+/// passed to add() or advance().
+/// The moments must be passed in non-decreasing order.
+///
+/// The count and sum are maintained on the fly, the min and max
+/// are the fronts of two monotonic queues, so all operations
+/// are O(1) (add() and advance() amortized).
+///
+/// N must be at least the number of events that can be in the window,
+/// add() returns false (and ignores the event) when it is full.
+template< typename V, std::size_t N, typename T, typename M = void >
+class sliding_window final {
+private:
+
+   using moment = torsor< T, M >;
+
+   T width;
+   moment last;
+
+   // the events, as a ring buffer indexed by sequence number
+   moment moments[ N ];
+   V values[ N ];
+   std::uint64_t head = 0, tail = 0;
+
+   // monotonic queues of sequence numbers
+   std::uint64_t mins[ N ], maxs[ N ];
+   std::uint64_t min_head = 0, min_tail = 0;
+   std::uint64_t max_head = 0, max_tail = 0;
+
+   V total;
+
+   void expire(){
+      const moment oldest = last - width;
+      while( ( head != tail ) && ( moments[ head % N ] <= oldest ) ){
+         total -= values[ head % N ];
+         if( mins[ min_head % N ] == head ){
+            ++min_head;
+         }
+         if( maxs[ max_head % N ] == head ){
+            ++max_head;
+         }
+         ++head;
+      }
+   }
+
+public:
+
+   /// create an empty window of the specified width
+   sliding_window( const T & width ):
+      width( width ), last(), total( 0 )
+   {}
+
+   /// add an event (at a moment not before the previous moment)
+   ///
+   /// The result is false when the window was full:
+   /// the event is then not added.
+   bool add( const moment & t, const V & v ){
+      advance( t );
+      if( tail - head == N ){
+         return false;
+      }
+      moments[ tail % N ] = t;
+      values[ tail % N ] = v;
+      total += v;
+      while( ( min_tail != min_head )
+         && !( values[ mins[ ( min_tail - 1 ) % N ] % N ] < v )
+      ){
+         --min_tail;
+      }
+      mins[ min_tail++ % N ] = tail;
+      while( ( max_tail != max_head )
+         && !( v < values[ maxs[ ( max_tail - 1 ) % N ] % N ] )
+      ){
+         --max_tail;
+      }
+      maxs[ max_tail++ % N ] = tail;
+      ++tail;
+      return true;
+   }
+
+   /// move the window to end at t (not before the previous moment)
+   void advance( const moment & t ){
+      last = t;
+      expire();
+   }
+
+   /// the number of events in the window
+   std::size_t count() const { return tail - head; }
+
+   /// the sum of the values in the window
+   V sum() const { return total; }
+
+   /// the smallest value in the window (only when count() > 0)
+   V min() const { return values[ mins[ min_head % N ] % N ]; }
+
+   /// the largest value in the window (only when count() > 0)
+   V max() const { return values[ maxs[ max_head % N ] % N ]; }
+
+}; // template class sliding_window
+
+
+// ==========================================================================
+//
+// bucketed (approximate) sliding window
+//
+// ==========================================================================
+
+/// approximate sliding window of B buckets
+//
+/// The window is divided in B buckets of width / B, which hold the
+/// aggregates of the events in that part of the window.
+/// The window moves one bucket at a time, so it contains the events
+/// of the last ( B - 1 ) * width / B to width.
+/// The memory is fixed, regardless of the event rate.
+///
+/// The moments must be passed in non-decreasing order,
+/// and not before the origin.
+/// The count and sum are O(1), min and max are O(B).
+template< typename V, std::size_t B, typename T, typename M = void >
+class bucketed_window final {
+private:
+
+   using moment = torsor< T, M >;
+
+   struct bucket {
+      std::size_t count;
+      V sum, min, max;
+   };
+
+   moment origin;
+   T bucket_width;
+   bucket buckets[ B ];
+   std::uint64_t current;
+   moment current_end;
+   std::size_t total_count;
+   V total_sum;
+
+   void clear( bucket & b ){
+      total_count -= b.count;
+      total_sum -= b.sum;
+      b.count = 0;
+      b.sum = V( 0 );
+   }
+
+   void move_to( std::uint64_t index ){
+      if( index - current >= B ){
+         for( auto & b : buckets ){
+            clear( b );
+         }
+      } else {
+         while( current != index ){
+            ++current;
+            clear( buckets[ current % B ] );
+         }
+      }
+      current = index;
+      current_end = origin + static_cast< T >( index + 1 ) * bucket_width;
+   }
+
+   // for an integral T, a width below B would give buckets of width 0
+   static T width_of_bucket( const T & width ){
+      const T w = width / static_cast< T >( B );
+      if constexpr ( std::is_integral_v< T > ){
+         return ( w < T( 1 ) ) ? T( 1 ) : w;
+      } else {
+         return w;
+      }
+   }
+
+   // most events are in the current bucket: avoid the division
+   void move_to( const moment & t ){
+      if( !( t < current_end ) ){
+         move_to( (std::uint64_t) ( ( t - origin ) / bucket_width ) );
+      }
+   }
+
+public:
+
+   /// create an empty window of the specified width,
+   /// with bucket boundaries at the origin + n * ( width / B )
+   ///
+   /// The width must be positive. For an integral T the bucket width
+   /// is at least 1, so a width below B gives a window of B.
+   bucketed_window( const T & width, const moment & origin = moment() ):
+      origin( origin ), bucket_width( width_of_bucket( width ) ),
+      current( 0 ), current_end( origin + bucket_width ),
+      total_count( 0 ), total_sum( 0 )
+   {
+      for( auto & b : buckets ){
+         b.count = 0;
+         b.sum = V( 0 );
+      }
+   }
+
+   /// add an event (at a moment not before the previous moment)
+   void add( const moment & t, const V & v ){
+      move_to( t );
+      bucket & b = buckets[ current % B ];
+      if( b.count == 0 ){
+         b.min = v;
+         b.max = v;
+      } else {
+         if( v < b.min ){
+            b.min = v;
+         }
+         if( b.max < v ){
+            b.max = v;
+         }
+      }
+      ++b.count;
+      b.sum += v;
+      ++total_count;
+      total_sum += v;
+   }
+
+   /// move the window to end at t (not before the previous moment)
+   void advance( const moment & t ){
+      move_to( t );
+   }
+
+   /// the number of events in the window
+   std::size_t count() const { return total_count; }
+
+   /// the sum of the values in the window
+   V sum() const { return total_sum; }
+
+   /// the smallest value in the window (only when count() > 0)
+   V min() const {
+      const bucket * r = nullptr;
+      for( auto & b : buckets ){
+         if( ( b.count > 0 ) && ( ( r == nullptr ) || ( b.min < r->min ) ) ){
+            r = & b;
+         }
+      }
+      return r->min;
+   }
+
+   /// the largest value in the window (only when count() > 0)
+   V max() const {
+      const bucket * r = nullptr;
+      for( auto & b : buckets ){
+         if( ( b.count > 0 ) && ( ( r == nullptr ) || ( r->max < b.max ) ) ){
+            r = & b;
+         }
+      }
+      return r->max;
+   }
+
+}; // template class bucketed_window
+
+#endif // ifndef torsor_window_hpp
@@ -17,14 +17,49 @@
 #ifndef torsor_hpp
 #define torsor_hpp
 
+#include <type_traits>
+#ifdef TORSOR_CHECK_NARROWING
+   #include <cassert>
+#endif
+
 // this file contains Doxygen lines
 /// @file 
 
 // Doxygen doeesn't understand concepts or even the
-// __attribute__((always_inline)), so those are put
+// TORSOR_FORCE_INLINE attribute, so those are put
 // in @cond INTERNAL / @endcond blocks.
 
 
+// ==========================================================================
+//
+// forced inlining
+//
+// All torsor operations must be inlined, even in a debug (-O0) build:
+// a call for each + or < would make a loop that handles timestamps
+// many times slower than the same loop on raw base values.
+//
+// GCC and Clang inline an always_inline function at any optimization
+// level, so no call frame is created. The artificial attribute makes 
+// a debugger step over it, like over a built-in operator.
+// MSVC inlines a __forceinline function unless inlining is disabled
+// altogether (/Ob0, implied by /Od), so use /Od /Ob1 for debug builds.
+//
+// Define TORSOR_FORCE_INLINE (before including this file)
+// to override this choice.
+//
+// ==========================================================================
+
+#ifndef TORSOR_FORCE_INLINE
+   #if defined( __GNUC__ ) || defined( __clang__ )
+      #define TORSOR_FORCE_INLINE __attribute__((always_inline, artificial))
+   #elif defined( _MSC_VER )
+      #define TORSOR_FORCE_INLINE __forceinline
+   #else
+      #define TORSOR_FORCE_INLINE inline
+   #endif
+#endif
+
+
 // ==========================================================================
 //
 // concepts for protecting the torsor operators
@@ -39,8 +74,26 @@
 // doxygen doesn't handle concepts
 ///@cond INTERNAL
 
+template< typename T, typename M > class torsor;
+
 namespace torsor_concepts {
    
+// recognizing a torsor (of any base type and tag) doesn't need
+// to instantiate any operator, so it can guard the others
+template< typename V >
+struct is_torsor_type {
+   static constexpr bool value = false;
+};
+
+template< typename T, typename M >
+struct is_torsor_type< torsor< T, M > > {
+   static constexpr bool value = true;
+};
+
+// concept for a torsor (of any base type and tag)
+template< typename V >
+concept is_torsor = is_torsor_type< V >::value;
+
 
 // concept for the torsor copy constructor
 template< typename V, typename W >
@@ -146,12 +199,87 @@ concept can_be_printed_to
 ///@endcond
 
 
+// ==========================================================================
+//
+// storage preserving arithmetic
+//
+// ==========================================================================
+
+/// opt-in storage preserving arithmetic for the torsors of a tag
+///
+/// By default, ( torsor + value ), ( value + torsor ), 
+/// ( torsor - value ) and ( + torsor ) yield a torsor of the 
+/// type of the same operation on the base type. 
+/// For small base types that is the promoted type: 
+/// torsor< uint16_t > + 1 is a torsor< int >, 
+/// which is twice as large. 
+///
+/// Specializing this variable to true for a tag M makes those
+/// operators yield a torsor< T, M >: the base result is explicitly
+/// narrowed (static_cast) to T, which is what ( torsor += value ) 
+/// and ( torsor -= value ) already do.
+/// For unsigned base types this narrowing wraps around, which
+/// is what you want for instance for ring buffer indexes.
+///
+/// Subtracting two torsors is not affected: it still yields
+/// a value of the type of the subtraction of the base values.
+///
+/// The narrowing is not checked: torsor< uint8_t > + 300 is 44 
+/// above the original. Define TORSOR_CHECK_NARROWING (before 
+/// including this file) to assert that each narrowed value fits
+/// (for instance in a debug build), or use torsor_checked_add()
+/// and torsor_checked_subtract(), which report whether it fits.
+template< typename M >
+constexpr bool torsor_preserves_storage = false;
+
+///@cond INTERNAL
+
+// whether the (integer) value x is negative
+template< typename X >
+constexpr bool torsor_is_negative( const X & x ){
+   if constexpr ( std::is_signed_v< X > ){
+      return x < X( 0 );
+   } else {
+      return false;
+   }
+}
+
+// whether the (integer) value v is unchanged by narrowing it to T;
+// for other types the narrowing is not checked
+template< typename T, typename U >
+constexpr bool torsor_narrowing_fits( const U & v ){
+   if constexpr ( std::is_integral_v< T > && std::is_integral_v< U > ){
+      return ( static_cast< U >( static_cast< T >( v ) ) == v )
+         && ( torsor_is_negative( v ) 
+            == torsor_is_negative( static_cast< T >( v ) ) );
+   } else {
+      return true;
+   }
+}
+
+// the storage preserving narrowing of v to T
+template< typename T, typename U >
+TORSOR_FORCE_INLINE
+constexpr T torsor_narrow( const U & v ){
+   #ifdef TORSOR_CHECK_NARROWING
+      assert( torsor_narrowing_fits< T >( v ) );
+   #endif
+   return static_cast< T >( v );
+}
+
+///@endcond
+
+
 // ==========================================================================
 //
 // the torsor template class itself
 //
 // ==========================================================================
 
+///@cond INTERNAL
+struct torsor_access;
+///@endcond
+
 /// absolute version of an arithmetic value type
 //
 /// For a value type that denotes a ratio scale value (a value
@@ -170,10 +298,17 @@ concept can_be_printed_to
 /// The base type T of a torsor must have a constructor that
 /// accepts a (single) 0 argument.
 ///
-/// All operations have the __attribute__((always_inline)),
+/// All operations are forced inline (TORSOR_FORCE_INLINE),
+/// also in a debug build,
 /// hence there is no need to bother with choosing for copy 
 /// or reference parameter passing: all passing disappears.
 ///
+/// Only the constructors and the (update) assignments are members,
+/// the other operators are templates outside the class.
+/// Those are declared once, instead of once for each instantiation
+/// of the class, which makes a program with many torsor types
+/// compile faster and in less memory.
+///
 template< typename T, typename M = void >
 class torsor final {  
 private:
@@ -182,13 +317,16 @@ private:
    // - access the value of torsors of any (same or other) type
    // - create non-zero torsors of any (same or other) type
    template<typename, typename> friend class torsor; 
+
+   // the operators outside the class do so via torsor_access
+   friend struct torsor_access;
    
    // the stored base type value
    T value;
 
    // create a (possibly non-zero) torsor value
    ///@cond INTERNAL
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
    ///@endcond
    constexpr explicit torsor( const T & value ):
       value( value )
@@ -199,7 +337,7 @@ public:
 
    // =======================================================================
    //
-   // constructor and assignment
+   // constructors and assignments
    //
    // =======================================================================
 
@@ -207,7 +345,7 @@ public:
    ///
    /// Create a torsor with the zero (anchor) value.
    ///@cond INTERNAL
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
    ///@endcond
    constexpr torsor():value( 0 ){}
 
@@ -218,7 +356,7 @@ public:
    template< typename U >
    ///@cond INTERNAL
    requires torsor_concepts::can_be_constructed_from< T, U >
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
    ///@endcond
    constexpr torsor( const torsor< U, M > & right ):
       value( right.value )
@@ -231,46 +369,12 @@ public:
    template< typename U >
    ///@cond INTERNAL
    requires torsor_concepts::can_be_assigned_from< T, U >
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
    ///@endcond
-   torsor & operator=( const torsor< U, M > & right ){
+   constexpr torsor & operator=( const torsor< U, M > & right ){
       value = right.value;
       return *this;
    }
-   
-
-   // =======================================================================
-   //
-   // add
-   //
-   // =======================================================================
-
-   /// positive of a torsor
-   ///
-   /// This unary plus operator just returns the torsor (value) itself.w
-   constexpr auto operator+() const 
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_plussed< T >
-   __attribute__((always_inline))
-   ///@endcond
-   {
-      return ::torsor< decltype( + value ), M >( + value ); 
-   }
-
-   /// add a torsor with a value
-   ///
-   /// Add a value to ourself.
-   /// The base types of our torsor and the value must be addable.
-   /// The result is a torsor of the type 
-   /// and with the value of that addition.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_added_with_value< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator+( const U & right ) const {
-      return ::torsor< decltype( value + right ), M >( value + right );      
-   }
 
    /// update add a torsor with a value
    ///
@@ -281,50 +385,13 @@ public:
    template< typename U >
    ///@cond INTERNAL
    requires torsor_concepts::can_be_update_added_with_value< T, U >
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
    ///@endcond
-   torsor & operator+=( const U & right ){
+   constexpr torsor & operator+=( const U & right ){
       value += right;
       return *this;
    }
 
-
-   // =======================================================================
-   //
-   // subtract
-   //
-   // =======================================================================
-
-   /// subtract a torsor with a value
-   ///
-   /// Subtract a value from ourself.
-   /// The base types of our torsor and the value must be subtractable.
-   /// The result is a torsor of the type 
-   /// and with the value of that subtraction.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_subtracted_with_value< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator-( const U & right ) const {
-      return ::torsor< decltype( value - right ), M >( value - right );     
-   }
-   
-   /// subtract two torsors
-   ///
-   /// Subtract a torsor from ourself.
-   /// The base types of our torsor and the other torsor 
-   /// must be subtractable.
-   /// The result is of the type and has the value of that subtraction.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_subtracted_with_value< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator-( const torsor< U, M > & right ) const {
-      return value - right.value;      
-   }
-   
    /// update subtract a torsor with a value
    ///
    /// Subtract a value into ourself.
@@ -334,150 +401,330 @@ public:
    template< typename U >
    ///@cond INTERNAL
    requires torsor_concepts::can_be_update_subtracted_with_value< T, U >
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
    ///@endcond
-   torsor & operator-=( const U & right ){
+   constexpr torsor & operator-=( const U & right ){
       value -= right;
       return *this;
    }
-   
-   
-   // =======================================================================
-   //
-   // compare equal
-   //
-   // =======================================================================
 
-   /// compare torsors for equality
-   ///
-   /// Compare two torsors for equality.
-   /// The base types of te torsors must support comparing for equality.
-   /// The result is te result of that comparison.
-   template< typename U >
+   // stopgap because friend doesn't seem to work properly for operator+
    ///@cond INTERNAL
-   requires torsor_concepts::can_be_compared_equal< T, U >
-   __attribute__((always_inline))
+   TORSOR_FORCE_INLINE
+   constexpr explicit torsor( const T & value, int ):
+      value( value )
+   {}   
    ///@endcond
-   constexpr auto operator==( const torsor< U, M > & right ) const {
-      return value == right.value;
-   }
 
-   /// compare torsors for inequality
-   ///
-   /// Compare two torsors for inequality.
-   /// The base types of te torsors must support comparing for inequality.
-   /// The result is te result of that comparison.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_compared_unequal< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator!=( const torsor< U, M > & right ) const {
-      return value != right.value;
-   }
-   
+}; // template class torsor
 
-   // =======================================================================
-   //
-   // compare larger
-   //
-   // =======================================================================
 
-   /// compare torsors for larger
-   ///
-   /// Compares a torsor for being larger than another torsor.
-   /// The base types of te torsors must support the comparison.
-   /// The result is te result of that comparison.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_compared_larger< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator>( const torsor< U, M > & right ) const {
-      return value > right.value;
+// ==========================================================================
+//
+// access for the operators
+//
+// ==========================================================================
+
+///@cond INTERNAL
+struct torsor_access {
+
+   // the base value member of a torsor: ( t.*torsor_access::value< T, M > )
+   // is the base value of t, without a function call
+   template< typename T, typename M >
+   static constexpr T torsor< T, M >::* value = & torsor< T, M >::value;
+};
+///@endcond
+
+
+// ==========================================================================
+//
+// add
+//
+// ==========================================================================
+
+/// positive of a torsor
+///
+/// This unary plus operator just returns the torsor (value) itself.
+template< typename T, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_plussed< T >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator+( const torsor< T, M > & t ){
+   const T & v = t.*torsor_access::value< T, M >;
+   if constexpr ( torsor_preserves_storage< M > ){
+      return torsor< T, M >( torsor_narrow< T >( + v ), 42 );
+   } else {
+      return torsor< decltype( + v ), M >( + v, 42 ); 
    }
+}
 
-   /// compare torsors for larger or equal
-   ///
-   /// Compares a torsor for being larger than or equal to another torsor.
-   /// The base types of te torsors must support the comparison.
-   /// The result is te result of that comparison.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_compared_larger_or_equal< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator>=( const torsor< U, M > & right ) const {
-      return value >= right.value;
+/// add a torsor with a value
+///
+/// Add a value to a torsor.
+/// The base types of the torsor and the value must be addable.
+/// The result is a torsor of the type 
+/// and with the value of that addition,
+/// or of the torsor type when torsor_preserves_storage< M >.
+template< typename T, typename M, typename U >
+///@cond INTERNAL
+requires torsor_concepts::can_be_added_with_value< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator+( const torsor< T, M > & left, const U & right ){
+   const T & v = left.*torsor_access::value< T, M >;
+   if constexpr ( torsor_preserves_storage< M > ){
+      return torsor< T, M >( torsor_narrow< T >( v + right ), 42 );
+   } else {
+      return torsor< decltype( v + right ), M >( v + right, 42 );
    }
+}
 
+/// add a value and a torsor
+///
+/// Add a torsor to a value.
+/// The base types of the torsor and the value must be addable.
+/// The result is a torsor of the type 
+/// and with the value of that addition,
+/// or of the torsor type when torsor_preserves_storage< M >.
+///
+/// The right operand must be deduced as a torsor before the 
+/// constraints are checked, otherwise ADL would make any ( x + y ) 
+/// with a torsor among the template arguments of x check ( x + T ),
+/// which can depend on itself.
+template< typename U, typename T, typename M >
+///@cond INTERNAL
+requires ( ! torsor_concepts::is_torsor< U > )
+   && torsor_concepts::can_be_added_with_value< U, T >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator+( const U & left, const torsor< T, M > & right ){ 
+   const T & v = right.*torsor_access::value< T, M >;
+   if constexpr ( torsor_preserves_storage< M > ){
+      return torsor< T, M >( torsor_narrow< T >( left + v ), 42 );
+   } else {
+      return torsor< decltype( left + v ), M >( left + v, 42 ); 
+   }
+}
 
-   // =======================================================================
-   //
-   // compare smaller
-   //
-   // =======================================================================
 
-   /// compare torsors for smaller
-   ///
-   /// Compares a torsor for being smaller than another torsor.
-   /// The base types of te torsors must support the comparison.
-   /// The result is te result of that comparison.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_compared_smaller< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator<( const torsor< U, M > & right ) const {
-      return value < right.value;
+// ==========================================================================
+//
+// subtract
+//
+// ==========================================================================
+
+/// subtract a value from a torsor
+///
+/// Subtract a value from a torsor.
+/// The base types of the torsor and the value must be subtractable.
+/// The result is a torsor of the type 
+/// and with the value of that subtraction,
+/// or of the torsor type when torsor_preserves_storage< M >.
+template< typename T, typename M, typename U >
+///@cond INTERNAL
+requires torsor_concepts::can_be_subtracted_with_value< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator-( const torsor< T, M > & left, const U & right ){
+   const T & v = left.*torsor_access::value< T, M >;
+   if constexpr ( torsor_preserves_storage< M > ){
+      return torsor< T, M >( torsor_narrow< T >( v - right ), 42 );
+   } else {
+      return torsor< decltype( v - right ), M >( v - right, 42 );
    }
+}
 
-   /// compare torsors for smaller or equal
-   ///
-   /// Compares a torsor for being smaller than or equal to another torsor.
-   /// The base types of te torsors must support the comparison.
-   /// The result is te result of that comparison.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_compared_smaller_or_equal< T, U >
-   __attribute__((always_inline))
-   ///@endcond
-   constexpr auto operator<=( const torsor< U, M > & right ) const {
-      return value <= right.value;
+/// subtract two torsors
+///
+/// Subtract a torsor from a torsor.
+/// The base types of the two torsors must be subtractable.
+/// The result is of the type and has the value of that subtraction.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_subtracted_with_value< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator-( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      - ( right.*torsor_access::value< U, M > );
+}
+
+
+// ==========================================================================
+//
+// checked add and subtract
+//
+// ==========================================================================
+
+/// add a value to a torsor, checking the narrowing
+///
+/// Add a value to a torsor, like ( left + right ) with
+/// torsor_preserves_storage< M >, but with the result stored in
+/// result only when it fits in T (an integer base type: other base
+/// types are not checked). The return value is whether it fits.
+template< typename T, typename M, typename U >
+///@cond INTERNAL
+requires torsor_concepts::can_be_added_with_value< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr bool torsor_checked_add( 
+   const torsor< T, M > & left, const U & right, torsor< T, M > & result 
+){
+   const auto v = ( left.*torsor_access::value< T, M > ) + right;
+   if( ! torsor_narrowing_fits< T >( v ) ){
+      return false;
    }
-     
-   // =======================================================================
-   //
-   // reverse arithmetic
-   //
-   // =======================================================================
+   result = torsor< T, M >( static_cast< T >( v ), 42 );
+   return true;
+}
 
-   // stopgap because friend doesn't seem to work properly for operator+
-   ///@cond INTERNAL
-   __attribute__((always_inline))
-   constexpr explicit torsor( const T & value, int n ):
-      value( value )
-   {}   
-   ///@endcond
-   
-   /// add a value and a torsor
-   ///
-   /// Add ourself to a value.
-   /// The base types of our torsor and the value must be addable.
-   /// The result is a torsor of the type 
-   /// and with the value of that addition.
-   template< typename U >
-   ///@cond INTERNAL
-   requires torsor_concepts::can_be_added_with_value< U, T >
-   __attribute__((always_inline))
-   ///@endcond
-   friend constexpr auto operator+( const U & left, const torsor & right ){ 
-      return torsor< decltype( left + right.value ), M >( 
-        left + right.value, 42 ); 
+/// subtract a value from a torsor, checking the narrowing
+///
+/// Subtract a value from a torsor, like ( left - right ) with
+/// torsor_preserves_storage< M >, but with the result stored in
+/// result only when it fits in T (an integer base type: other base
+/// types are not checked). The return value is whether it fits.
+template< typename T, typename M, typename U >
+///@cond INTERNAL
+requires torsor_concepts::can_be_subtracted_with_value< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr bool torsor_checked_subtract( 
+   const torsor< T, M > & left, const U & right, torsor< T, M > & result 
+){
+   const auto v = ( left.*torsor_access::value< T, M > ) - right;
+   if( ! torsor_narrowing_fits< T >( v ) ){
+      return false;
    }
+   result = torsor< T, M >( static_cast< T >( v ), 42 );
+   return true;
+}
 
 
-}; // template class torsor
+// ==========================================================================
+//
+// compare equal
+//
+// ==========================================================================
+
+/// compare torsors for equality
+///
+/// Compare two torsors for equality.
+/// The base types of te torsors must support comparing for equality.
+/// The result is te result of that comparison.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_compared_equal< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator==( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      == ( right.*torsor_access::value< U, M > );
+}
+
+/// compare torsors for inequality
+///
+/// Compare two torsors for inequality.
+/// The base types of te torsors must support comparing for inequality.
+/// The result is te result of that comparison.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_compared_unequal< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator!=( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      != ( right.*torsor_access::value< U, M > );
+}
+
+
+// ==========================================================================
+//
+// compare larger
+//
+// ==========================================================================
+
+/// compare torsors for larger
+///
+/// Compares a torsor for being larger than another torsor.
+/// The base types of te torsors must support the comparison.
+/// The result is te result of that comparison.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_compared_larger< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator>( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      > ( right.*torsor_access::value< U, M > );
+}
+
+/// compare torsors for larger or equal
+///
+/// Compares a torsor for being larger than or equal to another torsor.
+/// The base types of te torsors must support the comparison.
+/// The result is te result of that comparison.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_compared_larger_or_equal< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator>=( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      >= ( right.*torsor_access::value< U, M > );
+}
+
+
+// ==========================================================================
+//
+// compare smaller
+//
+// ==========================================================================
+
+/// compare torsors for smaller
+///
+/// Compares a torsor for being smaller than another torsor.
+/// The base types of te torsors must support the comparison.
+/// The result is te result of that comparison.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_compared_smaller< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator<( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      < ( right.*torsor_access::value< U, M > );
+}
+
+/// compare torsors for smaller or equal
+///
+/// Compares a torsor for being smaller than or equal to another torsor.
+/// The base types of te torsors must support the comparison.
+/// The result is te result of that comparison.
+template< typename T, typename U, typename M >
+///@cond INTERNAL
+requires torsor_concepts::can_be_compared_smaller_or_equal< T, U >
+TORSOR_FORCE_INLINE
+///@endcond
+constexpr auto operator<=( 
+   const torsor< T, M > & left, const torsor< U, M > & right 
+){
+   return ( left.*torsor_access::value< T, M > )
+      <= ( right.*torsor_access::value< U, M > );
+}
 
 
 // ==========================================================================
@@ -0,0 +1,157 @@
+// ==========================================================================
+//
+// test-arena.cpp
+//
+// torsor-arena tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "torsor-arena.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+// a mark is not a size, and a size is not a mark
+static_assert( ! std::is_convertible_v< std::size_t, arena_mark > );
+static_assert( ! std::is_convertible_v< arena_mark, std::size_t > );
+static_assert( ! std::is_invocable_v<
+   decltype( & arena::rewind ), arena &, std::size_t > );
+static_assert( std::is_same_v<
+   decltype( arena_mark() - arena_mark() ), std::size_t > );
+
+std::uintptr_t address( const void * p ){
+   return reinterpret_cast< std::uintptr_t >( p );
+}
+
+void test_allocate(){
+   alignas( 64 ) char buffer[ 256 ];
+   arena a( buffer, sizeof( buffer ), 1024 );
+   CHECK_EQUAL( a.used(), 0u );
+
+   // in the buffer, aligned
+   char * c = static_cast< char * >( a.allocate( 1, 1 ) );
+   CHECK_TRUE( c == buffer );
+   void * d = a.allocate( 8, 8 );
+   CHECK_TRUE( d == buffer + 8 );
+   void * e = a.allocate( 1, 64 );
+   CHECK_TRUE( e == buffer + 64 );
+   CHECK_EQUAL( a.used(), 65u );
+
+   // a T
+   struct pair { int a, b; };
+   pair * p = a.make< pair >( pair{ 1, 2 } );
+   CHECK_EQUAL( address( p ) % alignof( pair ), 0u );
+   CHECK_EQUAL( p->b, 2 );
+   int * q = a.make_array< int >( 10 );
+   CHECK_EQUAL( address( q ) % alignof( int ), 0u );
+}
+
+void test_blocks(){
+   char buffer[ 100 ];
+   arena a( buffer, sizeof( buffer ), 1000 );
+   const arena_mark start = a.mark();
+
+   // more than the buffer: a next block, the rest of the buffer is used
+   a.allocate( 60, 1 );
+   char * p = static_cast< char * >( a.allocate( 60, 1 ) );
+   CHECK_TRUE( ( p < buffer ) || ( p >= buffer + 100 ) );
+   CHECK_EQUAL( a.used(), 160u );
+   const arena_mark m = a.mark();
+
+   // more than a block
+   char * big = static_cast< char * >( a.allocate( 5000, 16 ) );
+   big[ 4999 ] = 1;
+   CHECK_EQUAL( address( big ) % 16, 0u );
+   CHECK_TRUE( a.mark() - m >= 5000u );
+
+   // back into the second block: it is re-used
+   a.rewind( m );
+   CHECK_EQUAL( a.used(), 160u );
+   void * x = a.allocate( 1, 1 );
+   CHECK_TRUE( x == p + 60 );
+
+   // back to the buffer
+   a.rewind( start );
+   x = a.allocate( 1, 1 );
+   CHECK_TRUE( x == buffer );
+   a.allocate( 200, 1 );
+   x = a.allocate( 1, 1 );
+   CHECK_TRUE( x == p + 200 );
+
+   a.release();
+   CHECK_EQUAL( a.used(), 0u );
+}
+
+void test_empty(){
+   arena a( 256 );
+   void * p = a.allocate( 0 );
+   CHECK_TRUE( p != nullptr );
+   for( int i = 0; i < 100; ++i ){
+      a.make< std::int64_t >( i );
+   }
+   CHECK_TRUE( a.used() >= 800u );
+   a.reset();
+   CHECK_EQUAL( a.used(), 0u );
+}
+
+void test_scope(){
+   arena a;
+   a.allocate( 10 );
+   const arena_mark m = a.mark();
+   {
+      arena_scope s( a );
+      a.allocate( 100'000 );
+      CHECK_TRUE( a.mark() - m >= 100'000u );
+   }
+   CHECK_TRUE( a.mark() == m );
+}
+
+void test_thread(){
+   arena * mine = & thread_arena();
+   arena * other = nullptr;
+   std::thread t( [ & ]{ other = & thread_arena(); } );
+   t.join();
+   CHECK_TRUE( mine == & thread_arena() );
+   CHECK_TRUE( mine != other );
+}
+
+void test_resource(){
+   char buffer[ 4096 ];
+   arena a( buffer, sizeof( buffer ) );
+   arena_resource r( a );
+   std::pmr::vector< int > v( & r );
+   for( int i = 0; i < 100; ++i ){
+      v.push_back( i );
+   }
+   CHECK_EQUAL( v[ 99 ], 99 );
+   CHECK_TRUE( address( v.data() ) >= address( buffer ) );
+   CHECK_TRUE( address( v.data() ) < address( buffer + sizeof( buffer ) ) );
+   CHECK_TRUE( & r.get_arena() == & a );
+}
+
+int main(){
+   test_allocate();
+   test_blocks();
+   test_empty();
+   test_scope();
+   test_thread();
+   test_resource();
+
+   return test_end();
+}
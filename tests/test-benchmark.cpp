@@ -0,0 +1,136 @@
+// ==========================================================================
+//
+// test-benchmark.cpp
+//
+// torsor-benchmark runtime tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <sstream>
+#include <string>
+#include "torsor-benchmark.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+using std::chrono::nanoseconds;
+
+// a clock that only advances when the work tells it to
+struct fake_clock {
+   using duration = nanoseconds;
+   struct tag {};
+   using moment = torsor< duration, tag >;
+   static inline moment t;
+   static moment now(){ return t; }
+};
+
+void test_summary(){
+   std::vector< nanoseconds > samples;
+   for( int i = 1; i <= 9; ++i ){
+      samples.push_back( nanoseconds( 100 + i ) );
+   }
+   samples.push_back( nanoseconds( 1000 ) );
+
+   // the 1000 is rejected
+   auto s = benchmark_summary( samples );
+   CHECK_EQUAL( s.samples, 9 );
+   CHECK_EQUAL( s.outliers, 1 );
+   CHECK_EQUAL( s.min.count(), 101 );
+   CHECK_EQUAL( s.median.count(), 105 );
+   CHECK_EQUAL( s.mean.count(), 105 );
+   CHECK_EQUAL( s.max.count(), 109 );
+   CHECK_EQUAL( s.stddev.count(), 3 );
+   CHECK_EQUAL( s.p90.count(), 108 );
+
+   // unless rejection is off
+   s = benchmark_summary( samples, 0.0 );
+   CHECK_EQUAL( s.samples, 10 );
+   CHECK_EQUAL( s.outliers, 0 );
+   CHECK_EQUAL( s.max.count(), 1000 );
+
+   // when most samples are equal the median absolute deviation is 0:
+   // then nothing is rejected
+   std::vector< nanoseconds > equal( 7, nanoseconds( 50 ) );
+   equal.push_back( nanoseconds( 51 ) );
+   s = benchmark_summary( equal );
+   CHECK_EQUAL( s.samples, 8 );
+   CHECK_EQUAL( s.outliers, 0 );
+   CHECK_EQUAL( s.max.count(), 51 );
+}
+
+void test_harness(){
+   benchmark_harness< fake_clock > h( {
+      nanoseconds( 1000 ), nanoseconds( 100 ), 5, 3.0 } );
+
+   // each run takes 30 ns, so a sample needs 4 runs
+   int calls = 0;
+   const auto & r = h.run( "work", 10, [ & ]{
+      ++calls;
+      fake_clock::t += nanoseconds( 30 ); } );
+   CHECK_EQUAL( r.runs, 4 );
+   CHECK_EQUAL( r.statistics.samples, 5 );
+   CHECK_EQUAL( r.statistics.median.count(), 30 );
+   CHECK_EQUAL( r.ns_per_element(), 3.0 );
+
+   // the warmup runs at least 1000 ns
+   CHECK_TRUE( calls * 30 >= 1000 + 5 * 4 * 30 );
+
+   std::stringstream csv;
+   h.write_csv( csv );
+   CHECK_EQUAL( csv.str(),
+      "name,elements,runs,samples,outliers,"
+      "min,median,mean,stddev,p90,p99,max,ns_per_element\n"
+      "\"work\",10,4,5,0,30,30,30,0,30,30,30,3\n" );
+
+   std::stringstream json;
+   h.write_json( json );
+   CHECK_EQUAL( json.str(),
+      "[\n{\"name\":\"work\",\"elements\":10,\"runs\":4,\"samples\":5,"
+      "\"outliers\":0,\"min\":30,\"median\":30,\"mean\":30,\"stddev\":0,"
+      "\"p90\":30,\"p99\":30,\"max\":30,\"ns_per_element\":3}\n]\n" );
+}
+
+void test_resolution(){
+   benchmark_harness< fake_clock > h( {
+      nanoseconds( 0 ), nanoseconds( 100 ), 5, 3.0 } );
+
+   // 10 ns per 3 runs: the time of a run is not truncated to 3 ns
+   int calls = 0;
+   const auto & r = h.run( "a \"quoted\"\tname", 1, [ & ]{
+      if( ++calls % 3 == 0 ){
+         fake_clock::t += nanoseconds( 10 );
+      }
+   } );
+   const double median = r.statistics.median.count();
+   CHECK_TRUE( ( median > 3.2 ) && ( median < 3.5 ) );
+
+   // the name is escaped
+   std::stringstream csv;
+   h.write_csv( csv );
+   CHECK_TRUE( csv.str().find( "\n\"a \"\"quoted\"\"\tname\"," )
+      != std::string::npos );
+   std::stringstream json;
+   h.write_json( json );
+   CHECK_TRUE( json.str().find( "{\"name\":\"a \\\"quoted\\\"\\u0009name\"," )
+      != std::string::npos );
+}
+
+int main(){
+   test_summary();
+   test_harness();
+   test_resolution();
+
+   return test_end();
+}
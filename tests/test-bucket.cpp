@@ -0,0 +1,159 @@
+// ==========================================================================
+//
+// test-bucket.cpp
+//
+// torsor-bucket tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "torsor-bucket.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct ns_tag {};
+using moment = torsor< int64_t, ns_tag >;
+using divider = bucket_divider< int64_t, ns_tag >;
+
+// the floor, also for negative values
+static_assert( divider( 10 ).index( moment() + 25 ) == 2 );
+static_assert( divider( 10 ).index( moment() + 20 ) == 2 );
+static_assert( divider( 10 ).index( moment() + 19 ) == 1 );
+static_assert( divider( 10 ).index( moment() - 1 ) == -1 );
+static_assert( divider( 10 ).index( moment() - 10 ) == -1 );
+static_assert( divider( 10 ).index( moment() - 11 ) == -2 );
+static_assert( divider( 1 ).index( moment() - 7 ) == -7 );
+static_assert( divider( 8 ).index( moment() - 7 ) == -1 );
+
+// from an origin
+constexpr divider minutes( 60, moment() + 30 );
+static_assert( minutes.index( moment() + 89 ) == 0 );
+static_assert( minutes.index( moment() + 90 ) == 1 );
+static_assert( minutes.floor( moment() + 100 ) == moment() + 90 );
+static_assert( minutes.floor( moment() + 29 ) == moment() - 30 );
+static_assert( minutes.ceil( moment() + 100 ) == moment() + 150 );
+static_assert( minutes.ceil( moment() + 90 ) == moment() + 90 );
+static_assert( minutes.start( -2 ) == moment() - 90 );
+
+// the index type
+static_assert( std::is_same_v<
+   bucket_divider< uint16_t >::index_type, int32_t > );
+static_assert( std::is_same_v<
+   bucket_divider< uint64_t >::index_type, int64_t > );
+static_assert( bucket_divider< uint16_t >::max_width == 65'535 );
+static_assert( bucket_divider< int16_t >::max_width == 32'767 );
+static_assert( bucket_divider< uint32_t >::max_width == 0x7FFF'FFFF );
+static_assert( bucket_divider< uint64_t >::max_width
+   == 0x7FFF'FFFF'FFFF'FFFF );
+static_assert( bucket_divider< int64_t >::max_width
+   == std::numeric_limits< int64_t >::max() );
+static_assert( bucket_divider< uint32_t >( 0x7FFF'FFFF ).index(
+   torsor< uint32_t >() + 0x7FFF'FFFFU ) == 1 );
+static_assert( bucket_divider< uint16_t >( 65'535 ).index(
+   torsor< uint16_t >() + uint16_t( 65'534 ) ) == 0 );
+
+// the reference: floor of d / w
+int64_t floor_divide( int64_t d, int64_t w ){
+   const int64_t q = d / w;
+   return ( q * w > d ) ? q - 1 : q;
+}
+
+uint64_t seed = 42;
+uint64_t next(){
+   seed = seed * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+   return seed;
+}
+
+template< typename T >
+bool same_as_division( T width ){
+   using mt = torsor< T, ns_tag >;
+   using index_type = typename bucket_divider< T, ns_tag >::index_type;
+   const bucket_divider< T, ns_tag > d( width );
+   bool same = true;
+   for( int i = 0; i < 2'000; ++i ){
+      // a random difference, a small one, and the extremes
+      index_type x = static_cast< index_type >( next() >> ( next() % 64 ) );
+      if( i == 0 ){
+         x = std::numeric_limits< index_type >::max();
+      } else if( i == 1 ){
+         x = std::numeric_limits< index_type >::min();
+      }
+      const mt t = mt() + static_cast< T >( x );
+      same = same && ( d.index( t ) == floor_divide( x, width ) );
+   }
+   return same;
+}
+
+void test_division(){
+   bool same = true;
+   for( int64_t w : std::vector< int64_t >{ 1, 2, 3, 7, 10, 60, 1000, 1024,
+      86'400'000, 1'000'000'007, 60'000'000'000, 1LL << 40, ( 1LL << 62 ) + 1,
+      std::numeric_limits< int64_t >::max() }
+   ){
+      same = same && same_as_division< int64_t >( w );
+   }
+   CHECK_TRUE( same );
+
+   same = true;
+   for( int32_t w : std::vector< int32_t >{ 1, 3, 10, 1000, 65'536,
+      1'000'003, std::numeric_limits< int32_t >::max() }
+   ){
+      same = same && same_as_division< int32_t >( w );
+      same = same && same_as_division< uint32_t >( w );
+   }
+   CHECK_TRUE( same );
+
+   for( int i = 0; i < 1000; ++i ){
+      const int64_t w = 1 + (int64_t) ( next() >> ( 1 + next() % 63 ) );
+      same = same && same_as_division< int64_t >( w );
+   }
+   CHECK_TRUE( same );
+}
+
+void test_batch(){
+   const divider d( 1000, moment() + 500 );
+   std::vector< moment > in, floors( 100 ), ceils( 100 );
+   std::vector< int64_t > indices( 100 );
+   for( int i = 0; i < 100; ++i ){
+      in.push_back( moment() + ( i * 97 - 5000 ) );
+   }
+   d.index( in.data(), indices.data(), 100 );
+   d.floor( in.data(), floors.data(), 100 );
+   d.ceil( in.data(), ceils.data(), 100 );
+
+   bool ok = true;
+   for( int i = 0; i < 100; ++i ){
+      ok = ok && indices[ i ] == floor_divide( in[ i ] - d.origin(), 1000 );
+      ok = ok && floors[ i ] <= in[ i ] && in[ i ] - floors[ i ] < 1000;
+      ok = ok && ceils[ i ] >= in[ i ] && ceils[ i ] - in[ i ] < 1000;
+      ok = ok && ( floors[ i ] - d.origin() ) % 1000 == 0;
+      ok = ok && ( ceils[ i ] - d.origin() ) % 1000 == 0;
+   }
+   CHECK_TRUE( ok );
+
+   // in place
+   d.floor( in.data(), in.data(), 100 );
+   CHECK_TRUE( in == floors );
+}
+
+int main(){
+   test_division();
+   test_batch();
+
+   return test_end();
+}
@@ -0,0 +1,153 @@
+// ==========================================================================
+//
+// test-compact.cpp
+//
+// torsor-compact runtime tests
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <algorithm>
+#include "torsor-compact.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests 
+//
+// ==========================================================================
+
+struct ns_tag {};
+using moment = torsor< int64_t, ns_tag >;
+
+const moment epoch = moment() + 1'000'000'000'000;
+
+void test_access(){
+   int32_t offsets[ 4 ] = { 0, 10, -20, 30 };
+   compact_torsors< int32_t, int64_t, ns_tag > c( epoch, offsets, 4 );
+
+   CHECK_EQUAL( c.size(), 4 );
+   CHECK_EQUAL( (moment) c[ 1 ] - epoch, 10 );
+   CHECK_EQUAL( (moment) c[ 2 ] - epoch, -20 );
+
+   c[ 3 ] = epoch + 1000;
+   CHECK_EQUAL( offsets[ 3 ], 1000 );
+   CHECK_EQUAL( ( (moment) c[ 3 ] ) - epoch, 1000 );
+
+   c[ 0 ] = c[ 1 ];
+   CHECK_EQUAL( offsets[ 0 ], 10 );
+
+   CHECK_TRUE(  c.fits( epoch + 2'000'000'000 ) );
+   CHECK_FALSE( c.fits( epoch + 3'000'000'000 ) );
+   CHECK_FALSE( c.fits( epoch - 3'000'000'000 ) );
+}
+
+void test_iterate(){
+   int32_t offsets[ 4 ] = { 5, 6, 7, 8 };
+   const compact_torsors< int32_t, int64_t, ns_tag > c( epoch, offsets, 4 );
+
+   int64_t n = 5;
+   for( auto t : c ){
+      CHECK_EQUAL( t - epoch, n );
+      ++n;
+   }
+   CHECK_EQUAL( c.end() - c.begin(), 4 );
+   CHECK_EQUAL( c.begin()[ 2 ] - epoch, 7 );
+
+   auto p = std::lower_bound( c.begin(), c.end(), epoch + 7 );
+   CHECK_EQUAL( p - c.begin(), 2 );
+
+   // the iterators hand out values or proxies, not references
+   using iterator = compact_torsors< int32_t, int64_t, ns_tag >::const_iterator;
+   static_assert( std::is_same_v<
+      std::iterator_traits< iterator >::iterator_category,
+      std::input_iterator_tag > );
+   static_assert( std::is_same_v<
+      iterator::iterator_concept, std::random_access_iterator_tag > );
+}
+
+void test_batch(){
+   moment wide[ 3 ] = { epoch + 1, epoch - 2, epoch + 100'000 };
+   int16_t narrow_offsets[ 3 ];
+   CHECK_FALSE( narrow( epoch, wide, narrow_offsets, 3 ) );
+   CHECK_TRUE(  narrow( epoch, wide, narrow_offsets, 2 ) );
+   CHECK_EQUAL( narrow_offsets[ 1 ], -2 );
+
+   moment back[ 2 ];
+   widen( epoch, narrow_offsets, back, 2 );
+   CHECK_EQUAL( back[ 0 ], wide[ 0 ] );
+   CHECK_EQUAL( back[ 1 ], wide[ 1 ] );
+
+   int32_t offsets[ 3 ];
+   compact_torsors< int32_t, int64_t, ns_tag > c( epoch, offsets, 3 );
+   CHECK_TRUE( c.set( wide ) );
+   moment all[ 3 ];
+   c.get( all );
+   CHECK_EQUAL( all[ 2 ], wide[ 2 ] );
+}
+
+void test_vector(){
+   compact_vector< int16_t, int64_t, ns_tag > c( epoch );
+   CHECK_TRUE( c.empty() );
+
+   // only torsors that fit are appended
+   const bool ok1 = c.push_back( epoch + 5 );
+   const bool ok2 = c.push_back( epoch - 32'768 );
+   const bool ok3 = c.push_back( epoch + 40'000 );
+   CHECK_TRUE( ok1 );
+   CHECK_TRUE( ok2 );
+   CHECK_FALSE( ok3 );
+   CHECK_EQUAL( c.size(), 2u );
+   CHECK_EQUAL( c.data()[ 1 ], -32'768 );
+   CHECK_EQUAL( (moment) c[ 1 ] - epoch, -32'768 );
+
+   // written through references and iterators
+   c[ 0 ] = epoch + 7;
+   *( c.begin() + 1 ) = epoch + 9;
+   c[ 1 ] = c[ 0 ];
+   CHECK_EQUAL( (moment) c[ 1 ] - epoch, 7 );
+   for( auto r : c ){
+      r = moment( r ) + 1;
+   }
+   CHECK_EQUAL( (moment) c[ 0 ] - epoch, 8 );
+   CHECK_EQUAL( c.end() - c.begin(), 2 );
+
+   // assign all or nothing
+   moment wide[ 3 ] = { epoch + 1, epoch + 2, epoch + 100'000 };
+   const bool ok4 = c.assign( wide, 2 );
+   CHECK_TRUE( ok4 );
+   CHECK_EQUAL( c.size(), 2u );
+   const bool ok5 = c.assign( wide, 3 );
+   CHECK_FALSE( ok5 );
+   CHECK_TRUE( c.empty() );
+
+   // read-only, and as a view
+   c.resize( 3 );
+   c[ 2 ] = epoch + 3;
+   const auto & r = c;
+   auto p = std::lower_bound( r.begin(), r.end(), epoch + 1 );
+   CHECK_EQUAL( p - r.begin(), 2 );
+   auto v = c.view();
+   CHECK_EQUAL( v.size(), 3u );
+   CHECK_EQUAL( (moment) v[ 2 ] - epoch, 3 );
+   moment all[ 3 ];
+   c.get( all );
+   CHECK_EQUAL( all[ 0 ], epoch );
+}
+
+int main(){
+   test_access();
+   test_iterate();
+   test_batch();
+   test_vector();
+
+   return test_end();
+}
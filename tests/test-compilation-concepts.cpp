@@ -183,3 +183,21 @@ ALLOWED(  _t1     <= _t1                  )
 ERROR(    _t1     <= _t2                  )
 
 
+
+// the ( value + torsor ) operator deduces its right operand as a
+// torsor, so a torsor in the template arguments of an iterator
+// doesn't make ( iterator + offset ) depend on itself
+std::vector< torsor< long > >::iterator _iterator;
+
+ALLOWED(  _iterator = _iterator + _int     )
+ALLOWED(  _iterator = _int + _iterator     )
+ALLOWED(  _t1       = _int + _t1           )
+ERROR(    _t1       = _int + _t2           )
+
+struct preserving {};
+template<>
+constexpr bool torsor_preserves_storage< preserving > = true;
+torsor< unsigned char, preserving > _narrow;
+
+ALLOWED(  _narrow   = _int + _narrow       )
+ERROR(    _narrow   = _int + _torsor       )
@@ -0,0 +1,153 @@
+// ==========================================================================
+//
+// test-coroutine.cpp
+//
+// torsor-coroutine runtime tests
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <string>
+#include "torsor-coroutine.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// a manual clock: wait() jumps to the moment
+//
+// ==========================================================================
+
+struct manual_clock {
+   using duration = int64_t;
+   struct tag {};
+   using moment = torsor< duration, tag >;
+
+   static inline moment current;
+   static inline int waits = 0;
+
+   static moment now(){ 
+      return current; 
+   }
+
+   static void wait( moment t ){
+      ++waits;
+      current = t;
+   }
+};
+
+using moment = manual_clock::moment;
+using executor = coroutine_executor< manual_clock >;
+using task = coroutine_task< manual_clock >;
+
+std::string trace;
+
+task sleeper( char name, int64_t delay, int n ){
+   for( int i = 0; i < n; ++i ){
+      co_await sleep_for( delay );
+      trace += name;
+   }
+}
+
+task alarm( char name, moment t ){
+   co_await sleep_until( t );
+   trace += name;
+   CHECK_TRUE( manual_clock::now() >= t );
+}
+
+
+// counts the destructions of the frames that hold one
+struct frame_guard {
+   static inline int destroyed = 0;
+   ~frame_guard(){ ++destroyed; }
+};
+
+task guarded( int64_t delay ){
+   frame_guard g;
+   co_await sleep_for( delay );
+   trace += 'g';
+}
+
+
+// ==========================================================================
+//
+// the tests 
+//
+// ==========================================================================
+
+void test_order(){
+   executor e;
+   trace = "";
+   manual_clock::current = moment() + 1000;
+   e.spawn( sleeper( 'a', 10, 3 ) );
+   e.spawn( sleeper( 'b', 15, 2 ) );
+   e.spawn( alarm( 'c', moment() + 1025 ) );
+   e.run();
+
+   // a at 10, 20, 30; b at 15, 30; c at 25;
+   // at 30 b goes first because it went to sleep first
+   CHECK_EQUAL( trace, "abacba" );
+   CHECK_EQUAL( manual_clock::now(), moment() + 1030 );
+   CHECK_EQUAL( e.resumes(), 6 );
+}
+
+void test_batch(){
+   executor e;
+   trace = "";
+   manual_clock::current = moment();
+   manual_clock::waits = 0;
+   for( char c = 'a'; c <= 'e'; ++c ){
+      e.spawn( alarm( c, moment() + 100 ) );
+   }
+   e.spawn( alarm( 'x', moment() + 200 ) );
+   e.run();
+
+   // coinciding deadlines: one wait, one batch, in spawn order
+   CHECK_EQUAL( trace, "abcdex" );
+   CHECK_EQUAL( manual_clock::waits, 2 );
+   CHECK_EQUAL( e.wakeups(), 2 );
+}
+
+void test_past(){
+   executor e;
+   trace = "";
+   manual_clock::current = moment() + 500;
+   manual_clock::waits = 0;
+   e.spawn( alarm( 'p', moment() + 100 ) );
+   e.run();
+
+   // a deadline in the past doesn't wait
+   CHECK_EQUAL( trace, "p" );
+   CHECK_EQUAL( manual_clock::waits, 0 );
+}
+
+void test_destroy(){
+   manual_clock::current = moment();
+   frame_guard::destroyed = 0;
+   trace = "";
+   {
+      executor e;
+      e.spawn( guarded( 10 ) );
+      e.spawn( guarded( 20 ) );
+   }
+
+   // the executor destroys the frames of the sleeping tasks
+   CHECK_EQUAL( frame_guard::destroyed, 2 );
+   CHECK_EQUAL( trace, "" );
+}
+
+int main(){
+   test_order();
+   test_batch();
+   test_past();
+   test_destroy();
+
+   return test_end();
+}
@@ -0,0 +1,122 @@
+// ==========================================================================
+//
+// test-deadline.cpp
+//
+// torsor-deadline runtime tests
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <atomic>
+#include <string>
+#include "torsor-deadline.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests 
+//
+// ==========================================================================
+
+using clock_source = steady_clock_source;
+using moment = clock_source::moment;
+using namespace std::chrono_literals;
+
+void test_order(){
+   deadline_pool<> pool( 1 );
+   std::atomic< bool > go{ false };
+   std::string log;
+
+   // keep the worker busy until all jobs are submitted
+   const moment t = clock_source::now() + 10s;
+   pool.submit( t, [ & ]{ while( ! go ){} } );
+   pool.submit( t + 3ms, [ & ]{ log += 'c'; } );
+   pool.submit( t + 1ms, [ & ]{ log += 'a'; } );
+   pool.submit( t + 2ms, [ & ]{ log += 'b'; } );
+   pool.submit( t + 1ms, [ & ]{ log += 'A'; } );
+   go = true;
+   pool.wait_idle();
+
+   CHECK_EQUAL( log, "aAbc" );
+   CHECK_EQUAL( pool.stats().done, 5 );
+   CHECK_EQUAL( pool.stats().shed, 0 );
+   CHECK_EQUAL( pool.stats().late, 0 );
+}
+
+void test_shed(){
+   deadline_pool<> pool( 2 );
+   std::atomic< int > runs{ 0 };
+   pool.submit( clock_source::now() - 1ms, [ & ]{ ++runs; } );
+   pool.submit( clock_source::now() + 10s, [ & ]{ ++runs; } );
+   pool.wait_idle();
+
+   CHECK_EQUAL( runs, 1 );
+   CHECK_EQUAL( pool.stats().shed, 1 );
+   CHECK_EQUAL( pool.stats().done, 1 );
+}
+
+void test_late(){
+   deadline_pool<> pool( 1, false );
+   pool.submit( clock_source::now() - 1ms, []{} );
+   pool.submit( clock_source::now() + 1ms, []{ 
+      std::this_thread::sleep_for( 5ms ); } );
+   pool.wait_idle();
+
+   auto s = pool.stats( 0 );
+   CHECK_EQUAL( s.done, 2 );
+   CHECK_EQUAL( s.shed, 0 );
+   CHECK_EQUAL( s.late, 2 );
+   CHECK_TRUE( s.max_lateness >= 3ms );
+   CHECK_TRUE( s.total_lateness >= s.max_lateness + 1ms );
+}
+
+void test_many(){
+   deadline_pool<> pool( 4 );
+   std::atomic< int > runs{ 0 };
+   const moment t = clock_source::now() + 10s;
+   for( int i = 0; i < 10'000; ++i ){
+      pool.submit( t + i * 1us, [ & ]{ ++runs; } );
+   }
+   pool.wait_idle();
+   CHECK_EQUAL( runs, 10'000 );
+   CHECK_EQUAL( pool.stats().done, 10'000 );
+}
+
+void test_steal(){
+   deadline_pool<> pool( 2 );
+   std::atomic< bool > go{ false };
+   std::atomic< bool > released{ false };
+
+   // the jobs go to the workers in turn: the third job goes to the
+   // worker of the first job, which waits for it, so another
+   // worker must steal it (or this would take 10 seconds)
+   const moment t = clock_source::now() + 20s;
+   pool.submit( t, [ & ]{
+      const moment end = clock_source::now() + 10s;
+      while( ! go && ( clock_source::now() < end ) ){}
+      released = go.load();
+   } );
+   pool.submit( t, []{} );
+   pool.submit( t, [ & ]{ go = true; } );
+   pool.wait_idle();
+
+   CHECK_TRUE( released );
+   CHECK_EQUAL( pool.stats().done, 3 );
+}
+
+int main(){
+   test_order();
+   test_shed();
+   test_late();
+   test_many();
+   test_steal();
+
+   return test_end();
+}
@@ -0,0 +1,140 @@
+// ==========================================================================
+//
+// test-fixed.cpp
+//
+// torsor-fixed tests: the static_asserts are the compile-time tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include "torsor-fixed.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+using meters = fixed< 16, 16 >;
+struct position_tag {};
+using position = torsor< meters, position_tag >;
+
+template< fixed_rounding R >
+using q4 = fixed< 8, 4, R >;
+using floor4 = q4< fixed_rounding::floor >;
+using truncate4 = q4< fixed_rounding::truncate >;
+using nearest4 = q4< fixed_rounding::nearest >;
+
+// the smallest storage
+static_assert( sizeof( fixed< 4, 4 > ) == 1 );
+static_assert( sizeof( fixed< 8, 8 > ) == 2 );
+static_assert( sizeof( fixed< 8, 9 > ) == 4 );
+static_assert( sizeof( meters ) == 4 );
+static_assert( sizeof( fixed< 32, 32 > ) == 8 );
+static_assert( sizeof( position ) == sizeof( meters ) );
+
+// construction
+static_assert( meters().raw() == 0 );
+static_assert( meters( 3 ).raw() == 3 << 16 );
+static_assert( meters( -3 ).raw() == -3 * 65536 );
+static_assert( meters( 0.25 ).raw() == 1 << 14 );
+static_assert( meters( -0.25 ).raw() == - ( 1 << 14 ) );
+static_assert( meters::from_raw( 5 ).raw() == 5 );
+
+// rounding of a floating point value
+static_assert( fixed< 8, 0, fixed_rounding::floor >( 2.5 ).raw() == 2 );
+static_assert( fixed< 8, 0, fixed_rounding::floor >( -2.5 ).raw() == -3 );
+static_assert( fixed< 8, 0, fixed_rounding::truncate >( -2.5 ).raw() == -2 );
+static_assert( fixed< 8, 0, fixed_rounding::nearest >( 2.5 ).raw() == 3 );
+static_assert( fixed< 8, 0, fixed_rounding::nearest >( -2.5 ).raw() == -2 );
+static_assert( fixed< 8, 0, fixed_rounding::nearest >( -2.6 ).raw() == -3 );
+
+// rounding of a product: 3/16 * 1/2 = 1.5/16
+static_assert( ( floor4::from_raw( 3 ) * floor4( 0.5 ) ).raw() == 1 );
+static_assert( ( truncate4::from_raw( 3 ) * truncate4( 0.5 ) ).raw() == 1 );
+static_assert( ( nearest4::from_raw( 3 ) * nearest4( 0.5 ) ).raw() == 2 );
+static_assert( ( floor4::from_raw( -3 ) * floor4( 0.5 ) ).raw() == -2 );
+static_assert( ( truncate4::from_raw( -3 ) * truncate4( 0.5 ) ).raw() == -1 );
+static_assert( ( nearest4::from_raw( -3 ) * nearest4( 0.5 ) ).raw() == -1 );
+
+// rounding to an integer
+static_assert( floor4( -2.5 ).integer() == -3 );
+static_assert( truncate4( -2.5 ).integer() == -2 );
+static_assert( nearest4( 2.5 ).integer() == 3 );
+static_assert( nearest4( 2.4375 ).integer() == 2 );
+
+// arithmetic
+static_assert( meters( 1.5 ) + meters( 2 ) == meters( 3.5 ) );
+static_assert( meters( 1.5 ) - 2 == meters( -0.5 ) );
+static_assert( - meters( 1.5 ) == meters( -1.5 ) );
+static_assert( meters( 1.5 ) * meters( 2.25 ) == meters( 3.375 ) );
+static_assert( meters( 1.5 ) * 3 == meters( 4.5 ) );
+static_assert( 3 * meters( 1.5 ) == meters( 4.5 ) );
+static_assert( meters( 3 ) / meters( 2 ) == meters( 1.5 ) );
+static_assert( meters( 3 ) / 2 == meters( 1.5 ) );
+static_assert( meters( -3 ) / meters::from_raw( 1 << 17 ) == meters( -1.5 ) );
+static_assert( meters( 1 ) < meters( 1.5 ) );
+static_assert( meters( 1.5 ) >= 1 );
+static_assert( meters( 1.5 ) != 1 );
+
+// format conversion
+static_assert( fixed< 16, 8 >( meters( 1.5 ) ).raw() == 384 );
+static_assert( meters( fixed< 16, 8 >( 1.5 ) ) == meters( 1.5 ) );
+static_assert(
+   fixed< 8, 1, fixed_rounding::floor >( meters( -1.25 ) ).raw() == -3 );
+static_assert(
+   fixed< 8, 1, fixed_rounding::nearest >( meters( -1.25 ) ).raw() == -2 );
+
+// widening multiply: exact
+constexpr auto product = widening_multiply( meters( 1.5 ), fixed< 8, 8 >( 2.25 ) );
+static_assert( std::is_same_v<
+   std::remove_const_t< decltype( product ) >, fixed< 24, 24 > > );
+static_assert( product.raw() == (int64_t)( 3.375 * ( 1 << 24 ) ) );
+static_assert( widening_multiply( floor4::from_raw( -3 ), floor4( 0.5 ) )
+   .raw() == -24 );
+
+// as base type of a torsor
+constexpr position moved(){
+   position p = position() + meters( 3 );
+   p += meters( 0.25 );
+   p -= 1;
+   return p;
+}
+static_assert( moved() - position() == meters( 2.25 ) );
+static_assert( moved() > position() );
+static_assert( moved() + meters( 0.5 ) - moved() == meters( 0.5 ) );
+
+void test_runtime(){
+   meters v( 0.125 ), dt( 0.5 );
+   position p = position() + 10;
+   for( int i = 0; i < 100; ++i ){
+      p += v * dt;
+   }
+   CHECK_EQUAL( ( p - position() ).raw(), meters( 16.25 ).raw() );
+   CHECK_EQUAL( (double) ( p - position() ), 16.25 );
+
+   // the 8-bit storage wraps
+   fixed< 4, 4 > x( 7 );
+   x += 1;
+   CHECK_EQUAL( x.integer(), -8 );
+
+   // a runtime double is rounded like a constexpr one
+   volatile double d = -2.5;
+   CHECK_EQUAL( nearest4( d ).raw(), nearest4( -2.5 ).raw() );
+   CHECK_EQUAL( floor4( d ).integer(), -3 );
+}
+
+int main(){
+   test_runtime();
+
+   return test_end();
+}
@@ -0,0 +1,166 @@
+// ==========================================================================
+//
+// test-gcra.cpp
+//
+// torsor-gcra tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "torsor-gcra.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct ns_tag {};
+using moment = torsor< std::int64_t, ns_tag >;
+using limit = gcra_limit< std::int64_t >;
+
+static_assert( std::atomic< moment >::is_always_lock_free );
+
+// the number of requests admitted at now
+int admitted( gcra_cell< std::int64_t, ns_tag > & c,
+   const limit & l, const moment & now, int n
+){
+   int a = 0;
+   for( int i = 0; i < n; ++i ){
+      a += c.admit( l, now );
+   }
+   return a;
+}
+
+void test_cell(){
+   const limit l( 100, 5 );
+   CHECK_EQUAL( l.tolerance, 400 );
+   gcra_cell< std::int64_t, ns_tag > c;
+   const moment t = moment() + 1'000'000;
+
+   // a burst of 5, then one per interval
+   // (the results are stored first: a CHECK evaluates its arguments twice)
+   const int a1 = admitted( c, l, t, 10 );
+   CHECK_EQUAL( a1, 5 );
+   CHECK_EQUAL( c.delay( l, t ), 100 );
+   const int a2 = admitted( c, l, t + 99, 10 );
+   CHECK_EQUAL( a2, 0 );
+   const int a3 = admitted( c, l, t + 100, 10 );
+   CHECK_EQUAL( a3, 1 );
+   const int a4 = admitted( c, l, t + 350, 10 );
+   CHECK_EQUAL( a4, 2 );
+
+   // idle: a full burst again
+   CHECK_EQUAL( c.delay( l, t + 10'000 ), 0 );
+   const int a5 = admitted( c, l, t + 10'000, 10 );
+   CHECK_EQUAL( a5, 5 );
+
+   // requests of several cells
+   c.reset();
+   const bool b1 = c.admit( l, t, 6 );
+   const bool b2 = c.admit( l, t, 4 );
+   const bool b3 = c.admit( l, t, 2 );
+   CHECK_FALSE( b1 );
+   CHECK_TRUE( b2 );
+   CHECK_FALSE( b3 );
+   CHECK_EQUAL( c.delay( l, t, 2 ), 100 );
+   CHECK_TRUE( c.arrival() == t + 400 );
+}
+
+void test_chrono(){
+   using namespace std::chrono_literals;
+   struct steady_tag {};
+   using steady = torsor< std::chrono::nanoseconds, steady_tag >;
+   const gcra_limit< std::chrono::nanoseconds > l( 1ms, 2 );
+   gcra_cell< std::chrono::nanoseconds, steady_tag > c;
+   const steady t = steady() + 1h;
+   const bool b1 = c.admit( l, t );
+   const bool b2 = c.admit( l, t );
+   const bool b3 = c.admit( l, t );
+   CHECK_TRUE( b1 && b2 && ! b3 );
+   CHECK_TRUE( c.delay( l, t ) == 1ms );
+   const bool b4 = c.admit( l, t + 1ms );
+   CHECK_TRUE( b4 );
+}
+
+void test_table(){
+   gcra_table< std::int64_t, ns_tag > table( limit( 100, 2 ), 1000, 4 );
+   CHECK_EQUAL( table.capacity(), 1024u );
+   const moment t = moment() + 1'000'000;
+
+   // each key has its own limit
+   int a = 0;
+   for( std::uint64_t k = 0; k < 500; ++k ){
+      for( int i = 0; i < 3; ++i ){
+         a += table.admit( k * 1'000'003, t );
+      }
+   }
+   CHECK_EQUAL( a, 1000 );
+
+   // the batch gives the same
+   std::vector< std::uint64_t > keys;
+   for( std::uint64_t k = 0; k < 500; ++k ){
+      for( int i = 0; i < 3; ++i ){
+         keys.push_back( k * 1'000'003 );
+      }
+   }
+   std::unique_ptr< bool[] > result( new bool[ keys.size() ] );
+   table.clear();
+   const std::size_t n = table.admit(
+      keys.data(), result.get(), keys.size(), t );
+   CHECK_EQUAL( n, 1000u );
+   CHECK_TRUE( result[ 0 ] && result[ 1 ] && ! result[ 2 ] );
+
+   // a full table: the first 4 keys get a slot,
+   // the other keys share an overflow cell
+   gcra_table< std::int64_t, ns_tag > small( limit( 100, 2 ), 4, 1 );
+   a = 0;
+   for( std::uint64_t k = 0; k < 100; ++k ){
+      a += small.admit( k, t );
+   }
+   CHECK_EQUAL( a, 4 + 2 );
+}
+
+void test_threads(){
+   // many threads, one key, at the same moment: exactly a burst
+   gcra_table< std::int64_t, ns_tag > table( limit( 100, 1000 ), 1024 );
+   const moment t = moment() + 1'000'000;
+   std::atomic< int > a( 0 );
+   std::vector< std::thread > threads;
+   for( int n = 0; n < 4; ++n ){
+      threads.emplace_back( [ & ]{
+         int mine = 0;
+         for( int i = 0; i < 10'000; ++i ){
+            mine += table.admit( 42, t );
+         }
+         a += mine;
+      } );
+   }
+   for( auto & x : threads ){
+      x.join();
+   }
+   CHECK_EQUAL( a.load(), 1000 );
+}
+
+int main(){
+   test_cell();
+   test_chrono();
+   test_table();
+   test_threads();
+
+   return test_end();
+}
@@ -0,0 +1,171 @@
+// ==========================================================================
+//
+// test-iso8601.cpp
+//
+// torsor-iso8601 tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "torsor-iso8601.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct utc_tag {};
+using utc = torsor< std::chrono::nanoseconds, utc_tag >;
+using utc64 = torsor< int64_t, utc_tag >;
+
+// the nanoseconds since 1970 of a date-time, or -1 for an error
+int64_t ns( std::string_view s ){
+   utc64 t;
+   return iso8601_parse( s, t ) == iso8601_error::none ? t - utc64() : -1;
+}
+
+iso8601_error error( std::string_view s ){
+   utc t;
+   return iso8601_parse( s, t );
+}
+
+std::string format( int64_t v, int digits = 9 ){
+   char s[ 30 ];
+   return std::string( s, iso8601_format( utc64() + v, s, digits ) );
+}
+
+void test_parse(){
+   const int64_t moment = 1'792'413'296'123'456'789;
+   CHECK_EQUAL( ns( "1970-01-01T00:00:00Z" ), 0 );
+   CHECK_EQUAL( ns( "2026-10-19T12:34:56.123456789Z" ), moment );
+   CHECK_EQUAL( ns( "2026-10-19t12:34:56.123456789z" ), moment );
+   CHECK_EQUAL( ns( "2026-10-19 12:34:56.123456789Z" ), moment );
+   CHECK_EQUAL( ns( "2026-10-19T14:34:56.123456789+02:00" ), moment );
+   CHECK_EQUAL( ns( "2026-10-19T11:04:56.123456789-01:30" ), moment );
+   CHECK_EQUAL( ns( "2026-10-19T12:34:56.5Z" ), moment - 123'456'789 + 500'000'000 );
+   CHECK_EQUAL( ns( "2026-10-19T12:34:56.1234Z" ), moment - 56'789 );
+   CHECK_EQUAL( ns( "2026-10-19T12:34:56Z" ), moment - 123'456'789 );
+   CHECK_EQUAL( ns( "1969-12-31T23:59:59.999999998Z" ), -2 );
+   CHECK_EQUAL( ns( "2024-02-29T00:00:00Z" ), 1'709'164'800'000'000'000 );
+   CHECK_EQUAL( ns( "2016-12-31T23:59:60Z" ), ns( "2017-01-01T00:00:00Z" ) );
+
+   // the chrono and the integer base type give the same moment
+   utc t;
+   iso8601_parse( "2026-10-19T12:34:56.123456789Z", t );
+   CHECK_EQUAL( ( t - utc() ).count(), moment );
+
+   // the extremes of an int64_t
+   CHECK_EQUAL( ns( "2262-04-11T23:47:16.854775807Z" ),
+      std::numeric_limits< int64_t >::max() );
+   CHECK_EQUAL( ns( "1677-09-21T00:12:43.145224192Z" ),
+      std::numeric_limits< int64_t >::min() );
+}
+
+void test_errors(){
+   using e = iso8601_error;
+   CHECK_TRUE( error( "2026-10-19T12:34:56Z" ) == e::none );
+   for( auto s : {
+      "", "2026-10-19", "2026-10-19T12:34:56", "2026-10-19X12:34:56Z",
+      "2026-1a-19T12:34:56Z", "2026/10/19T12:34:56Z", "2026-10-19T12-34-56Z",
+      "2026-10-19T12:34:56.Z", "2026-10-19T12:34:56,5Z",
+      "2026-10-19T12:34:56.1234567890Z", "2026-10-19T12:34:56.12345678xZ",
+      "2026-10-19T12:34:56+0200", "2026-10-19T12:34:56+02-00",
+      "2026-10-19T12:34:5Z", " 2026-10-19T12:34:56Z"
+   } ){
+      if( error( s ) != e::syntax ){
+         CHECK_EQUAL( std::string( s ), "syntax error" );
+      }
+   }
+   for( auto s : {
+      "2026-13-19T12:34:56Z", "2026-00-19T12:34:56Z", "2026-10-00T12:34:56Z",
+      "2023-02-29T12:34:56Z", "1900-02-29T12:34:56Z", "2026-04-31T12:34:56Z",
+      "2026-10-19T24:00:00Z", "2026-10-19T12:60:56Z", "2026-10-19T12:34:61Z",
+      "2026-10-19T12:34:56+24:00", "2026-10-19T12:34:56+02:60",
+      "2262-04-11T23:47:16.854775808Z", "1677-09-21T00:12:43.145224191Z",
+      "9999-12-31T23:59:59Z", "0000-01-01T00:00:00Z"
+   } ){
+      if( error( s ) != e::range ){
+         CHECK_EQUAL( std::string( s ), "range error" );
+      }
+   }
+
+   // a failed parse gives the zero moment
+   utc64 t = utc64() + 5;
+   iso8601_parse( "2026-13-19T12:34:56Z", t );
+   CHECK_EQUAL( t - utc64(), 0 );
+}
+
+void test_format(){
+   CHECK_EQUAL( format( 0 ), "1970-01-01T00:00:00.000000000Z" );
+   CHECK_EQUAL( format( 1'792'413'296'123'456'789 ),
+      "2026-10-19T12:34:56.123456789Z" );
+   CHECK_EQUAL( format( 1'792'413'296'123'456'789, 3 ),
+      "2026-10-19T12:34:56.123Z" );
+   CHECK_EQUAL( format( 1'792'413'296'123'456'789, 0 ),
+      "2026-10-19T12:34:56Z" );
+   CHECK_EQUAL( format( -1 ), "1969-12-31T23:59:59.999999999Z" );
+   CHECK_EQUAL( format( std::numeric_limits< int64_t >::max() ),
+      "2262-04-11T23:47:16.854775807Z" );
+   CHECK_EQUAL( format( std::numeric_limits< int64_t >::min() ),
+      "1677-09-21T00:12:43.145224192Z" );
+
+   // the fraction digits are clamped to 0 .. 9
+   CHECK_EQUAL( format( 1'792'413'296'123'456'789, 12 ),
+      "2026-10-19T12:34:56.123456789Z" );
+   CHECK_EQUAL( format( 1'792'413'296'123'456'789, -3 ),
+      "2026-10-19T12:34:56Z" );
+   CHECK_EQUAL( iso8601_length( 12 ), iso8601_length( 9 ) );
+   CHECK_EQUAL( iso8601_length( -3 ), 20 );
+
+   // parse( format( t ) ) == t
+   uint64_t random = 42;
+   bool same = true;
+   for( int i = 0; i < 100'000; ++i ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      const int64_t v = (int64_t) random >> ( random % 20 );
+      same = same && ( ns( format( v ) ) == v || v == -1 );
+   }
+   CHECK_TRUE( same );
+}
+
+void test_bulk(){
+   const std::vector< std::string_view > in = {
+      "2026-10-19T12:34:56Z", "2026-10-19T12:34:56", "2026-02-30T12:34:56Z",
+      "1970-01-01T00:00:01.5Z" };
+   std::vector< utc > out( 4 );
+   std::vector< iso8601_error > errors( 4 );
+   CHECK_EQUAL( iso8601_parse( in.data(), out.data(), errors.data(), 4 ), 2u );
+   CHECK_TRUE( errors[ 0 ] == iso8601_error::none );
+   CHECK_TRUE( errors[ 1 ] == iso8601_error::syntax );
+   CHECK_TRUE( errors[ 2 ] == iso8601_error::range );
+   CHECK_EQUAL( ( out[ 3 ] - utc() ).count(), 1'500'000'000 );
+
+   // fixed-width records
+   std::string text( 2 * iso8601_length( 3 ), '?' );
+   const utc m[] = { out[ 0 ], out[ 3 ] };
+   iso8601_format( m, text.data(), 2, 3 );
+   CHECK_EQUAL( text, "2026-10-19T12:34:56.000Z1970-01-01T00:00:01.500Z" );
+}
+
+int main(){
+   test_parse();
+   test_errors();
+   test_format();
+   test_bulk();
+
+   return test_end();
+}
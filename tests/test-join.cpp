@@ -0,0 +1,190 @@
+// ==========================================================================
+//
+// test-join.cpp
+//
+// torsor-join tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <vector>
+#include "torsor-join.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct tick_tag {};
+using tick = torsor< int64_t, tick_tag >;
+
+std::vector< tick > ticks( std::vector< int64_t > values ){
+   std::vector< tick > result;
+   for( auto v : values ){
+      result.push_back( tick() + v );
+   }
+   return result;
+}
+
+std::vector< std::size_t > asof(
+   const std::vector< tick > & left, const std::vector< tick > & right,
+   join_direction direction, int64_t tolerance, unsigned threads = 1
+){
+   std::vector< std::size_t > match( left.size() );
+   asof_join( left.data(), left.size(), right.data(), right.size(),
+      match.data(), direction, tolerance, threads );
+   return match;
+}
+
+// the matches, by looking at all pairs
+std::vector< std::size_t > asof_reference(
+   const std::vector< tick > & left, const std::vector< tick > & right,
+   join_direction direction, int64_t tolerance
+){
+   std::vector< std::size_t > match;
+   for( auto t : left ){
+      std::size_t b = join_none, f = join_none;
+      for( std::size_t j = 0; j < right.size(); ++j ){
+         if( right[ j ] <= t && t - right[ j ] <= tolerance ){
+            b = j;
+         }
+         if( f == join_none && right[ j ] >= t && right[ j ] - t <= tolerance ){
+            f = j;
+         }
+      }
+      if( direction == join_direction::backward ){
+         match.push_back( b );
+      } else if( direction == join_direction::forward ){
+         match.push_back( f );
+      } else if( b == join_none || f == join_none ){
+         match.push_back( ( b == join_none ) ? f : b );
+      } else {
+         match.push_back( ( t - right[ b ] <= right[ f ] - t ) ? b : f );
+      }
+   }
+   return match;
+}
+
+const std::size_t none = join_none;
+using indices = std::vector< std::size_t >;
+
+void test_asof(){
+   const auto left = ticks( { 0, 10, 20, 25, 40 } );
+   const auto right = ticks( { 5, 10, 10, 22, 30 } );
+
+   CHECK_TRUE( asof( left, right, join_direction::backward, 100 )
+      == indices( { none, 2, 2, 3, 4 } ) );
+   CHECK_TRUE( asof( left, right, join_direction::forward, 100 )
+      == indices( { 0, 1, 3, 4, none } ) );
+   CHECK_TRUE( asof( left, right, join_direction::nearest, 100 )
+      == indices( { 0, 2, 3, 3, 4 } ) );
+
+   // the tolerance
+   CHECK_TRUE( asof( left, right, join_direction::backward, 5 )
+      == indices( { none, 2, none, 3, none } ) );
+   CHECK_TRUE( asof( left, right, join_direction::nearest, 2 )
+      == indices( { none, 2, 3, none, none } ) );
+
+   // empty columns
+   CHECK_TRUE( asof( left, {}, join_direction::nearest, 100 )
+      == indices( 5, none ) );
+   CHECK_TRUE( asof( {}, right, join_direction::nearest, 100 ).empty() );
+}
+
+void test_asof_random(){
+   uint32_t random = 42;
+   auto next = [ & ]( int64_t n ){
+      random = random * 1'103'515'245 + 12'345;
+      return (int64_t) ( ( random >> 16 ) % n );
+   };
+   std::vector< tick > left, right;
+   tick a, b;
+   for( int i = 0; i < 500; ++i ){
+      a += next( 10 );
+      b += next( 10 );
+      left.push_back( a );
+      right.push_back( b );
+   }
+
+   bool same = true;
+   for( auto direction : { join_direction::backward,
+      join_direction::forward, join_direction::nearest }
+   ){
+      const auto reference = asof_reference( left, right, direction, 7 );
+      for( unsigned threads : { 1, 3, 8 } ){
+         same = same
+            && ( asof( left, right, direction, 7, threads ) == reference );
+      }
+   }
+   CHECK_TRUE( same );
+}
+
+std::vector< std::size_t > window(
+   const std::vector< tick > & left, const std::vector< tick > & right,
+   int64_t before, int64_t after, unsigned threads = 1
+){
+   std::vector< join_pair > pairs;
+   window_join( left.data(), left.size(), right.data(), right.size(),
+      before, after, pairs, threads );
+   indices result;
+   for( auto p : pairs ){
+      result.push_back( p.left );
+      result.push_back( p.right );
+   }
+   return result;
+}
+
+void test_window(){
+   const auto left = ticks( { 0, 10, 20, 40 } );
+   const auto right = ticks( { 5, 10, 10, 22, 30 } );
+
+   CHECK_TRUE( window( left, right, 0, 5 )
+      == indices( { 0, 0, 1, 1, 1, 2, 2, 3 } ) );
+   CHECK_TRUE( window( left, right, 10, 0 )
+      == indices( { 1, 0, 1, 1, 1, 2, 2, 1, 2, 2, 3, 4 } ) );
+   CHECK_TRUE( window( left, right, 10, 0, 3 )
+      == window( left, right, 10, 0 ) );
+   CHECK_TRUE( window( left, {}, 10, 10 ).empty() );
+}
+
+void test_window_unsigned(){
+   // before reaches below the zero moment, and rows on both sides
+   // of a left row: no wrap of the unsigned differences
+   struct u_tag {};
+   using utick = torsor< std::uint32_t, u_tag >;
+   std::vector< utick > left, right;
+   for( std::uint32_t v : { 2, 10 } ){
+      left.push_back( utick() + v );
+   }
+   for( std::uint32_t v : { 0, 1, 3, 8, 12 } ){
+      right.push_back( utick() + v );
+   }
+   std::vector< join_pair > pairs;
+   window_join( left.data(), left.size(), right.data(), right.size(),
+      std::uint32_t( 5 ), std::uint32_t( 1 ), pairs );
+   indices result;
+   for( auto p : pairs ){
+      result.push_back( p.left );
+      result.push_back( p.right );
+   }
+   CHECK_TRUE( result == indices( { 0, 0, 0, 1, 0, 2, 1, 3 } ) );
+}
+
+int main(){
+   test_asof();
+   test_asof_random();
+   test_window();
+   test_window_unsigned();
+
+   return test_end();
+}
@@ -0,0 +1,196 @@
+// ==========================================================================
+//
+// test-merge.cpp
+//
+// torsor-merge tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "torsor-merge.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct tick_tag {};
+using tick = torsor< int64_t, tick_tag >;
+
+std::vector< tick > ticks( std::vector< int64_t > values ){
+   std::vector< tick > result;
+   for( auto v : values ){
+      result.push_back( tick() + v );
+   }
+   return result;
+}
+
+std::vector< merge_range< tick > > ranges(
+   const std::vector< std::vector< tick > > & streams
+){
+   std::vector< merge_range< tick > > result;
+   for( auto & s : streams ){
+      result.push_back( { s.data(), s.data() + s.size() } );
+   }
+   return result;
+}
+
+// a record with a torsor key, and where it came from
+struct event {
+   tick time;
+   int stream;
+   int index;
+};
+
+std::vector< std::vector< event > > random_streams(
+   std::size_t k, std::size_t n, int64_t spread
+){
+   std::vector< std::vector< event > > streams( k );
+   uint64_t random = 12345;
+   for( std::size_t s = 0; s < k; ++s ){
+      tick t;
+      for( std::size_t i = 0; i < n; ++i ){
+         random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+         t += (int64_t) ( ( random >> 33 ) % spread );
+         streams[ s ].push_back( event{ t, (int) s, (int) i } );
+      }
+   }
+   return streams;
+}
+
+// the events, stable sorted on time
+std::vector< event > reference(
+   const std::vector< std::vector< event > > & streams
+){
+   std::vector< event > all;
+   for( auto & s : streams ){
+      all.insert( all.end(), s.begin(), s.end() );
+   }
+   std::stable_sort( all.begin(), all.end(),
+      []( const event & a, const event & b ){ return a.time < b.time; } );
+   return all;
+}
+
+bool same( const std::vector< event > & a, const std::vector< event > & b ){
+   if( a.size() != b.size() ){
+      return false;
+   }
+   for( std::size_t i = 0; i < a.size(); ++i ){
+      if( a[ i ].time != b[ i ].time || a[ i ].stream != b[ i ].stream
+         || a[ i ].index != b[ i ].index
+      ){
+         return false;
+      }
+   }
+   return true;
+}
+
+auto event_time = []( const event & e ){ return e.time; };
+
+// merge_sorted of the streams of events
+std::vector< event > merged(
+   const std::vector< std::vector< event > > & streams, unsigned threads
+){
+   std::vector< merge_range< event > > r;
+   for( auto & s : streams ){
+      r.push_back( { s.data(), s.data() + s.size() } );
+   }
+   std::vector< event > out( reference( streams ).size() );
+   const std::size_t n = merge_sorted(
+      r.data(), r.size(), out.data(), threads, event_time );
+   out.resize( n );
+   return out;
+}
+
+void test_tree(){
+   const std::vector< std::vector< tick > > streams = {
+      ticks( { 1, 4, 7 } ), ticks( {} ), ticks( { 2, 4, 9, 10 } ),
+      ticks( { 0 } ), ticks( { 4 } ) };
+   const auto r = ranges( streams );
+   loser_tree< tick > tree( r.data(), r.size() );
+
+   // one at a time: equal keys in the order of the ranges
+   std::vector< int64_t > values;
+   std::vector< std::size_t > sources;
+   while( ! tree.empty() ){
+      values.push_back( tree.top() - tick() );
+      sources.push_back( tree.source() );
+      tree.pop();
+   }
+   CHECK_TRUE( values
+      == std::vector< int64_t >( { 0, 1, 2, 4, 4, 4, 7, 9, 10 } ) );
+   CHECK_TRUE( sources
+      == std::vector< std::size_t >( { 3, 0, 2, 0, 2, 4, 0, 2, 2 } ) );
+
+   // in batches
+   loser_tree< tick > batched( r.data(), r.size() );
+   std::vector< tick > out( 9 );
+   const std::size_t n1 = batched.next( out.data(), 4 );
+   const std::size_t n2 = batched.next( out.data() + 4, 100 );
+   CHECK_EQUAL( n1, 4u );
+   CHECK_EQUAL( n2, 5u );
+   CHECK_TRUE( batched.empty() );
+   CHECK_TRUE( out == ticks( { 0, 1, 2, 4, 4, 4, 7, 9, 10 } ) );
+
+   // no ranges, only empty ranges, one range
+   loser_tree< tick > none( r.data(), 0 );
+   CHECK_TRUE( none.empty() );
+   loser_tree< tick > empty( r.data() + 1, 1 );
+   CHECK_TRUE( empty.empty() );
+   loser_tree< tick > one( r.data() + 2, 1 );
+   const std::size_t n3 = one.next( out.data(), 100 );
+   CHECK_EQUAL( n3, 4u );
+   CHECK_TRUE( out[ 3 ] == tick() + 10 );
+}
+
+void test_merge(){
+   // few and many streams, with many equal keys and with few
+   for( std::size_t k : { 1, 2, 3, 17, 300 } ){
+      const auto streams = random_streams( k, 200, ( k < 10 ) ? 3 : 50 );
+      const auto expected = reference( streams );
+      CHECK_TRUE( same( merged( streams, 1 ), expected ) );
+   }
+}
+
+void test_parallel(){
+   // the same result as with one thread
+   for( unsigned threads : { 2, 3, 8 } ){
+      for( std::size_t k : { 1, 5, 64 } ){
+         const auto streams = random_streams( k, 500, 4 );
+         CHECK_TRUE( same( merged( streams, threads ), reference( streams ) ) );
+      }
+   }
+
+   // too few records for the threads
+   const auto streams = random_streams( 3, 1, 10 );
+   CHECK_TRUE( same( merged( streams, 4 ), reference( streams ) ) );
+
+   // all keys equal: a single part
+   std::vector< std::vector< event > > equal( 4 );
+   for( int s = 0; s < 4; ++s ){
+      for( int i = 0; i < 100; ++i ){
+         equal[ s ].push_back( event{ tick() + 7, s, i } );
+      }
+   }
+   CHECK_TRUE( same( merged( equal, 4 ), reference( equal ) ) );
+}
+
+int main(){
+   test_tree();
+   test_merge();
+   test_parallel();
+
+   return test_end();
+}
@@ -0,0 +1,183 @@
+// ==========================================================================
+//
+// test-offset.cpp
+//
+// torsor-offset tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "torsor-offset.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+static_assert( sizeof( offset_ptr< int > ) == sizeof( std::ptrdiff_t ) );
+static_assert( sizeof( based_ptr< int > ) == 4 );
+static_assert( std::is_trivially_copyable_v< based_ptr< int > > );
+static_assert( ! std::is_trivially_copyable_v< offset_ptr< int > > );
+
+// a block of memory, aligned for any of the objects
+struct block {
+   std::vector< std::uint64_t > memory;
+   block( std::size_t bytes ): memory( ( bytes + 7 ) / 8 ){}
+   void * data(){ return memory.data(); }
+   std::size_t size() const { return 8 * memory.size(); }
+};
+
+void test_offset_ptr(){
+   int a[ 2 ] = { 1, 2 };
+   offset_ptr< int > p;
+   CHECK_FALSE( bool( p ) );
+   CHECK_TRUE( p.get() == nullptr );
+   p = a;
+   CHECK_TRUE( bool( p ) );
+   CHECK_EQUAL( *p, 1 );
+   CHECK_TRUE( p.get() == a );
+
+   // a copy points to the same object, with a different offset
+   offset_ptr< int > q( p );
+   CHECK_TRUE( q == p );
+   CHECK_TRUE( q.offset() != p.offset() );
+   q = a + 1;
+   CHECK_TRUE( q != p );
+   CHECK_EQUAL( *q, 2 );
+
+   // to const
+   offset_ptr< const int > c( q );
+   CHECK_EQUAL( *c, 2 );
+
+   // a pointer to itself
+   struct self {
+      offset_ptr< self > next;
+   } s;
+   s.next = & s;
+   CHECK_EQUAL( s.next.offset(), 0 );
+   CHECK_TRUE( s.next.get() == & s );
+}
+
+struct node {
+   offset_ptr< node > next;
+   based_ptr< node > other;
+   int value;
+};
+
+void test_relocate(){
+   block m1( 1024 ), m2( 1024 );
+   offset_region r = offset_region::create( m1.data(), m1.size() );
+   CHECK_TRUE( r.valid() );
+   node * a = r.make< node >();
+   node * b = r.make< node >();
+   a->next = b;
+   a->other = based_ptr< node >( b, r.base() );
+   a->value = 1;
+   b->next = a;
+   b->value = 2;
+   r.set_root( a );
+
+   // copy the memory: at another address, all links are still valid
+   std::memcpy( m2.data(), m1.data(), m1.size() );
+   std::memset( m1.data(), 0, m1.size() );
+   offset_region r2( m2.data(), m2.size() );
+   CHECK_TRUE( r2.valid() );
+   node * a2 = r2.root< node >();
+   CHECK_TRUE( a2 != nullptr );
+   CHECK_EQUAL( a2->value, 1 );
+   CHECK_EQUAL( a2->next->value, 2 );
+   CHECK_EQUAL( a2->next->next->value, 1 );
+   CHECK_EQUAL( a2->other.get( r2.base() )->value, 2 );
+   CHECK_TRUE( a2->next.get() == a2->other.get( r2.base() ) );
+
+   // not a region (it was erased), or too small
+   CHECK_FALSE( offset_region( m1.data(), m1.size() ).valid() );
+   CHECK_FALSE( offset_region( m2.data(), 100 ).valid() );
+   CHECK_FALSE( offset_region::create( m2.data(), 8 ).valid() );
+}
+
+void test_allocate(){
+   block m( 256 );
+   offset_region r = offset_region::create( m.data(), m.size() );
+   const std::size_t start = r.used();
+   char * c = static_cast< char * >( r.allocate( 1, 1 ) );
+   void * d = r.allocate( 8, 8 );
+   CHECK_EQUAL( address_of( d ) - address_of( c ), 8u );
+   CHECK_EQUAL( r.used(), start + 16 );
+   CHECK_TRUE( r.allocate( 1000, 8 ) == nullptr );
+   CHECK_EQUAL( r.used(), start + 16 );
+}
+
+void test_list(){
+   block m1( 4096 ), m2( 4096 );
+   offset_region r = offset_region::create( m1.data(), m1.size() );
+   auto list = r.make< offset_list< int > >();
+   for( int i = 0; i < 10; ++i ){
+      list->push_front( r, i );
+   }
+   r.set_root( list );
+   std::memcpy( m2.data(), m1.data(), m1.size() );
+
+   offset_region r2( m2.data(), m2.size() );
+   const auto & list2 = *r2.root< offset_list< int > >();
+   CHECK_EQUAL( list2.size(), 10u );
+   std::vector< int > values( list2.begin(), list2.end() );
+   CHECK_TRUE( values == std::vector< int >( { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 } ) );
+
+   // full
+   int n = 0;
+   while( list->push_front( r, n ) ){
+      ++n;
+   }
+   CHECK_EQUAL( list->size(), 10u + n );
+   list->pop_front();
+   CHECK_EQUAL( list->front(), n - 2 );
+}
+
+void test_hash_map(){
+   block m1( 1 << 16 ), m2( 1 << 16 );
+   offset_region r = offset_region::create( m1.data(), m1.size() );
+   using map = offset_hash_map< std::int64_t, std::int64_t >;
+   auto h = r.make< map >( r, 100 );
+   CHECK_EQUAL( h->bucket_count(), 128u );
+   bool ok = true;
+   for( std::int64_t i = 0; i < 1000; ++i ){
+      ok = ok && h->insert( r, i * 7, i );
+   }
+   CHECK_TRUE( ok );
+   h->insert( r, 7, -1 );
+   CHECK_EQUAL( h->size(), 1000u );
+   r.set_root( h );
+   std::memcpy( m2.data(), m1.data(), m1.size() );
+
+   offset_region r2( m2.data(), m2.size() );
+   const map & h2 = *r2.root< map >();
+   for( std::int64_t i = 2; i < 1000; ++i ){
+      ok = ok && ( h2.find( i * 7 ) != nullptr ) && ( *h2.find( i * 7 ) == i );
+   }
+   CHECK_TRUE( ok );
+   CHECK_EQUAL( *h2.find( 7 ), -1 );
+   CHECK_TRUE( h2.find( 8 ) == nullptr );
+}
+
+int main(){
+   test_offset_ptr();
+   test_relocate();
+   test_allocate();
+   test_list();
+   test_hash_map();
+
+   return test_end();
+}
@@ -0,0 +1,143 @@
+// ==========================================================================
+//
+// test-ranges.cpp
+//
+// torsor-ranges tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <chrono>
+#include <cstdint>
+#include <forward_list>
+#include <vector>
+#include "torsor-ranges.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct tick_tag {};
+using tick = torsor< int64_t, tick_tag >;
+
+template< typename R >
+std::vector< int64_t > values( R && r ){
+   std::vector< int64_t > result;
+   for( const auto & x : r ){
+      if constexpr ( torsor_concepts::is_torsor<
+         std::remove_cvref_t< decltype( x ) > >
+      ){
+         result.push_back( x - tick() );
+      } else {
+         result.push_back( x );
+      }
+   }
+   return result;
+}
+
+const std::vector< tick > ticks = {
+   tick() + 10, tick() + 13, tick() + 20, tick() + 20, tick() + 35 };
+
+// the rules are checked when an adaptor is applied
+template< typename R, typename A >
+constexpr bool can_pipe = requires( R r, A a ){ r | a; };
+
+static_assert( can_pipe< std::vector< tick > &,
+   decltype( torsor_views::deltas ) > );
+static_assert( ! can_pipe< std::vector< int64_t > &,
+   decltype( torsor_views::deltas ) > );
+static_assert( can_pipe< std::vector< int64_t > &,
+   decltype( torsor_views::anchor( tick() ) ) > );
+static_assert( ! can_pipe< std::vector< tick > &,
+   decltype( torsor_views::anchor( tick() ) ) > );
+static_assert( ! can_pipe< std::vector< tick > &,
+   decltype( torsor_views::offset( tick() ) ) > );
+
+// the views are views, and the deltas of a vector have a size
+static_assert( std::ranges::view<
+   decltype( ticks | torsor_views::deltas | torsor_views::anchor( tick() ) )
+> );
+static_assert( std::ranges::sized_range<
+   decltype( ticks | torsor_views::deltas ) > );
+
+// the views are in the namespace torsor_views
+static_assert( std::is_same_v<
+   decltype( ticks | torsor_views::deltas ),
+   torsor_views::deltas_view< std::views::all_t< const std::vector< tick > & > > > );
+static_assert( std::is_same_v<
+   decltype( ticks | torsor_views::deltas | torsor_views::anchor( tick() ) ),
+   torsor_views::anchor_view< torsor_views::deltas_view<
+      std::views::all_t< const std::vector< tick > & > >, int64_t, tick_tag > > );
+
+void test_deltas(){
+   CHECK_TRUE( values( ticks | torsor_views::deltas )
+      == std::vector< int64_t >( { 3, 7, 0, 15 } ) );
+   CHECK_EQUAL( ( ticks | torsor_views::deltas ).size(), 4u );
+
+   const std::vector< tick > empty, one = { tick() };
+   CHECK_TRUE( ( empty | torsor_views::deltas ).empty() );
+   CHECK_TRUE( ( one | torsor_views::deltas ).empty() );
+
+   // a forward range is enough
+   std::forward_list< tick > list( ticks.begin(), ticks.end() );
+   CHECK_TRUE( values( list | torsor_views::deltas )
+      == std::vector< int64_t >( { 3, 7, 0, 15 } ) );
+}
+
+void test_anchor(){
+   const std::vector< int64_t > ds = { 3, 7, 0, 15 };
+   CHECK_TRUE( values( ds | torsor_views::anchor( tick() + 10 ) )
+      == std::vector< int64_t >( { 13, 20, 20, 35 } ) );
+
+   // anchor undoes deltas
+   CHECK_TRUE( values( ticks | torsor_views::deltas
+      | torsor_views::anchor( ticks[ 0 ] ) )
+      == values( ticks | std::views::drop( 1 ) ) );
+
+   // and composes with the std adaptors
+   CHECK_TRUE( values( ticks | torsor_views::deltas
+      | std::views::filter( []( int64_t d ){ return d > 0; } )
+      | torsor_views::anchor( tick() ) )
+      == std::vector< int64_t >( { 3, 10, 25 } ) );
+}
+
+void test_offset_bucket(){
+   CHECK_TRUE( values( ticks | torsor_views::offset( -10 ) )
+      == std::vector< int64_t >( { 0, 3, 10, 10, 25 } ) );
+
+   CHECK_TRUE( values( ticks | torsor_views::bucket( 10 ) )
+      == std::vector< int64_t >( { 1, 1, 2, 2, 3 } ) );
+   CHECK_TRUE( values( ticks | torsor_views::bucket( 10, tick() + 15 ) )
+      == std::vector< int64_t >( { -1, -1, 0, 0, 2 } ) );
+
+   // floating point and std::chrono base types
+   struct s_tag {};
+   using seconds = torsor< double, s_tag >;
+   const std::vector< seconds > ss = { seconds() - 0.5, seconds() + 2.5 };
+   CHECK_TRUE( values( ss | torsor_views::bucket( 2.0 ) )
+      == std::vector< int64_t >( { -1, 1 } ) );
+
+   using ms = std::chrono::milliseconds;
+   using clock = torsor< ms, tick_tag >;
+   const std::vector< clock > cs = { clock() + ms( 1500 ), clock() - ms( 1 ) };
+   CHECK_TRUE( values( cs | torsor_views::bucket( ms( 1000 ) ) )
+      == std::vector< int64_t >( { 1, -1 } ) );
+}
+
+int main(){
+   test_deltas();
+   test_anchor();
+   test_offset_bucket();
+
+   return test_end();
+}
@@ -1,6 +1,6 @@
 // ==========================================================================
 //
-// test-runtime.hpp
+// test-runtime.cpp
 //
 // torsor runtime tests
 //
@@ -16,73 +16,10 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <type_traits>
+#include <vector>
 #include "torsor.hpp"
-
-
-// ==========================================================================
-//
-// simple test framework
-//
-// ==========================================================================
-
-int tests_total = 0;
-int tests_failed = 0;
-
-template< typename A, typename B >
-void test_ok( 
-   bool ok,                          // Test OK?
-   const char *name,                 // name of the test
-   const char * f, int n,            // file name and line number
-   const char * ta, const char *tb,  // arguments, stringified
-   const A & a, const B & b          // arguments, as-is
-){
-   ++tests_total;	
-   if( ! ok ){
-      ++tests_failed;
-      std::cout 
-         << f << ":" << std::dec << n 
-         << " check failed \n" 
-         << "   " << name << "( " 
-         << ta;
-      if( tb != 0){         
-         std::cout << " , " << tb;
-      }         
-      std::cout << " )\n"
-         << "   left  \"" << ta << "\" = " << a << "\n";
-      if( tb != 0 ){   
-         std::cout << "   right \"" << tb << "\" = " << b << "\n";
-      }         
-      std::cout << "\n";
-   }
-}
-
-#define CHECK_EQUAL( a, b ) \
-   test_ok( (a) == (b), "CHECK_EQUAL",  __FILE__, __LINE__, #a, #b, a, b );   
-
-#define CHECK_NOT_EQUAL( a, b ) \
-   test_ok( (a) != (b), "CHECK_NOT_EQUAL", __FILE__, __LINE__, #a, #b, a, b );   
-
-#define CHECK_TRUE( a ) \
-   test_ok( (a), "CHECK_TRUE", __FILE__, __LINE__, #a, 0, a, 0 );   
-
-#define CHECK_FALSE( a ) \
-   test_ok( !(a), "CHECK_TRUE", __FILE__, __LINE__, #a, 0, a, 0 );   
-
-int test_end(){
-   if( tests_failed == 0 ){
-      std::cout 
-	     << "\nRuntime test success: " 
-		 << std::dec << tests_total
-		 << " test(s) were successfull\n";
-      return 0;
-   } else {	   
-      std::cout 
-	     << "\nRUNTIME TEST FAILURE: " 
-		 << std::dec << tests_failed
-		 << " test(s) were NOT successfull\n";
-      return -1;
-   }
-}
+#include "test-runtime.hpp"
 
 
 // ==========================================================================
@@ -193,6 +130,86 @@ void test_print(){
 
 }
 
+struct preserving {};
+
+template<>
+constexpr bool torsor_preserves_storage< preserving > = true;
+
+void test_storage_preserving(){
+   torsor< uint8_t > a;
+   torsor< uint8_t, preserving > b;
+
+   // by default the result is widened
+   CHECK_TRUE(  ( std::is_same_v< decltype( a + 1 ), torsor< int > > ) );
+   CHECK_TRUE(  ( std::is_same_v< decltype( 1 + a ), torsor< int > > ) );
+   CHECK_EQUAL( ( a - 1 ) - torsor< int >(), -1 );
+
+   // when preserving, the result stays a torsor< uint8_t >
+   using t = torsor< uint8_t, preserving >;
+   CHECK_TRUE(  ( std::is_same_v< decltype( b + 1 ), t > ) );
+   CHECK_TRUE(  ( std::is_same_v< decltype( 1 + b ), t > ) );
+   CHECK_TRUE(  ( std::is_same_v< decltype( b - 1 ), t > ) );
+   CHECK_TRUE(  ( std::is_same_v< decltype( + b ), t > ) );
+
+   // and narrows just like -= does
+   t c = b;
+   c -= 1;
+   CHECK_EQUAL( b - 1, c );
+   CHECK_EQUAL( ( b - 1 ) - b, 255 );
+   CHECK_EQUAL( ( b + 300 ) - b, 44 );
+}
+
+void test_checked_narrowing(){
+   using t = torsor< uint8_t, preserving >;
+   using s = torsor< int8_t, preserving >;
+   const t b = t() + 200;
+
+   // the result is stored only when it fits
+   // (the results are stored first: a CHECK evaluates its arguments twice)
+   t r;
+   const bool ok1 = torsor_checked_add( b, 55, r );
+   CHECK_TRUE( ok1 );
+   CHECK_EQUAL( r - t(), 255 );
+   const bool ok2 = torsor_checked_add( b, 300, r );
+   CHECK_FALSE( ok2 );
+   CHECK_EQUAL( r - t(), 255 );
+   const bool ok3 = torsor_checked_subtract( b, 201, r );
+   CHECK_FALSE( ok3 );
+   const bool ok4 = torsor_checked_subtract( b, 200, r );
+   CHECK_TRUE( ok4 );
+   CHECK_EQUAL( r, t() );
+
+   // signed, and a right operand that is wider and unsigned
+   s q;
+   const bool ok5 = torsor_checked_add( s() + 100, 27, q );
+   const bool ok6 = torsor_checked_add( s() + 100, 28, q );
+   const bool ok7 = torsor_checked_subtract( s() - 100, 28, q );
+   const bool ok8 = torsor_checked_subtract( s() - 100, 29, q );
+   CHECK_TRUE( ok5 );
+   CHECK_FALSE( ok6 );
+   CHECK_TRUE( ok7 );
+   CHECK_FALSE( ok8 );
+   torsor< int64_t, preserving > w;
+   const bool ok9 = torsor_checked_add( w, uint64_t( 1 ) << 63, w );
+   CHECK_FALSE( ok9 );
+
+   // usable at compile time
+   static_assert( ! torsor_narrowing_fits< uint8_t >( 256 ) );
+   static_assert( torsor_narrowing_fits< uint8_t >( 255 ) );
+   static_assert( ! torsor_narrowing_fits< uint32_t >( -1 ) );
+   static_assert( ! torsor_narrowing_fits< int64_t >( ~uint64_t( 0 ) ) );
+}
+
+// a torsor in the template arguments of an iterator must not
+// take part in ( iterator + offset )
+void test_iterator_arithmetic(){
+   std::vector< torsor< long > > v( 3 );
+   v[ 2 ] = v[ 2 ] + 7;
+   CHECK_EQUAL( *( v.begin() + 2 ) - v[ 0 ], 7 );
+   CHECK_EQUAL( *( 2 + v.begin() ) - v[ 0 ], 7 );
+   CHECK_EQUAL( ( 5 + torsor< long >() ) - torsor< long >(), 5 );
+}
+
 int main(){
    test_constructor();
    test_addition();
@@ -201,6 +218,9 @@ int main(){
    test_larger();  
    test_smaller();  
    test_print();  
+   test_storage_preserving();  
+   test_checked_narrowing();  
+   test_iterator_arithmetic();  
 
    return test_end();
 }
\ No newline at end of file
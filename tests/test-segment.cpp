@@ -0,0 +1,229 @@
+// ==========================================================================
+//
+// test-segment.cpp
+//
+// torsor-segment runtime tests
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "torsor-segment.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests 
+//
+// ==========================================================================
+
+struct ns_tag {};
+using stamp = torsor< int64_t, ns_tag >;
+using layout = segment_layout< int32_t, ns_tag >;
+
+void test_write_read(){
+   std::vector< char > memory( layout::bytes( 8 ) );
+   segment_writer< int32_t, ns_tag > w( memory.data(), 8 );
+
+   // (the CHECK macros evaluate their argument twice)
+   CHECK_EQUAL( w.size(), 0 );
+   bool a1 = w.append( stamp() + 10, 1 );
+   bool a2 = w.append( stamp() + 20, 2 );
+   bool a3 = w.append( stamp() + 20, 3 );
+   bool a4 = w.append( stamp() + 15, 4 );
+   bool a5 = w.append( stamp() + 30, 5 );
+   CHECK_TRUE(  a1 && a2 && a3 && a5 );
+   CHECK_FALSE( a4 );
+   CHECK_EQUAL( w.size(), 4 );
+
+   // a copy at another address reads the same
+   std::vector< char > copy( memory );
+   segment_reader< int32_t, ns_tag > r( copy.data(), copy.size() );
+   CHECK_TRUE(  r.valid() );
+   CHECK_EQUAL( r.size(), 4 );
+   CHECK_EQUAL( r.min(), stamp() + 10 );
+   CHECK_EQUAL( r.max(), stamp() + 30 );
+   CHECK_EQUAL( r.keys()[ 3 ], stamp() + 30 );
+   CHECK_EQUAL( r.payloads()[ 2 ], 3 );
+}
+
+void test_full(){
+   std::vector< char > memory( layout::bytes( 2 ) );
+   segment_writer< int32_t, ns_tag > w( memory.data(), 2 );
+   bool a1 = w.append( stamp() + 1, 1 );
+   CHECK_FALSE( w.full() );
+   bool a2 = w.append( stamp() + 2, 2 );
+   CHECK_TRUE(  w.full() );
+   bool a3 = w.append( stamp() + 3, 3 );
+   CHECK_TRUE(  a1 && a2 );
+   CHECK_FALSE( a3 );
+}
+
+void test_invalid(){
+   std::vector< char > memory( layout::bytes( 4 ) );
+   segment_writer< int32_t, ns_tag > w( memory.data(), 4 );
+
+   // too small
+   segment_reader< int32_t, ns_tag > r1( memory.data(), 16 );
+   CHECK_FALSE( r1.valid() );
+
+   // other payload size
+   segment_reader< int64_t, ns_tag > r2( memory.data(), memory.size() );
+   CHECK_FALSE( r2.valid() );
+   CHECK_EQUAL( r2.size(), 0 );
+}
+
+void test_range(){
+   std::vector< char > memory( layout::bytes( 100 ) );
+   segment_writer< int32_t, ns_tag > w( memory.data(), 100 );
+   for( int i = 0; i < 100; ++i ){
+      w.append( stamp() + 10 * i, i );
+   }
+   segment_reader< int32_t, ns_tag > r( memory.data(), memory.size() );
+
+   auto a = r.range( stamp() + 25, stamp() + 55 );
+   CHECK_EQUAL( a.first, 3 );
+   CHECK_EQUAL( a.last, 6 );
+
+   auto b = r.range( stamp() - 100, stamp() + 10 );
+   CHECK_EQUAL( b.first, 0 );
+   CHECK_EQUAL( b.last, 1 );
+
+   auto c = r.range( stamp() + 980, stamp() + 10'000 );
+   CHECK_EQUAL( c.first, 98 );
+   CHECK_EQUAL( c.last, 100 );
+
+   CHECK_FALSE( r.overlaps( stamp() + 1000, stamp() + 2000 ) );
+   CHECK_EQUAL( r.range( stamp() + 1000, stamp() + 2000 ).size(), 0 );
+   CHECK_EQUAL( r.range( stamp() - 20, stamp() ).size(), 0 );
+}
+
+void test_store(){
+   memory_segment_storage storage;
+   {
+      // rollover to a new segment after each 8 records,
+      // a flush after 5 records or a key span of 100
+      segment_store< int32_t, ns_tag, memory_segment_storage > s(
+         storage, 8, segment_flush_policy{ 5, 100 } );
+      CHECK_TRUE( s.valid() );
+      for( int i = 0; i < 10; ++i ){
+         bool a = s.append( stamp() + 10 * i, i );
+         CHECK_TRUE( a );
+      }
+      bool a = s.append( stamp() + 5, 99 );
+      CHECK_FALSE( a );
+      CHECK_EQUAL( s.segments(), 2 );
+      CHECK_EQUAL( s.size(), 10 );
+
+      // a flush (3 syncs) after 5 records, and at the rollover,
+      // 2 records of the last segment are pending
+      CHECK_EQUAL( storage.syncs(), 2 * 3 );
+      CHECK_EQUAL( s.pending(), 2 );
+
+      // a flush by key span
+      bool b = s.append( stamp() + 250, 10 );
+      CHECK_TRUE( b );
+      CHECK_EQUAL( s.pending(), 0 );
+      CHECK_EQUAL( storage.syncs(), 3 * 3 );
+
+      // scan across segments
+      int sum = 0;
+      std::size_t calls = 0;
+      s.scan( stamp() + 55, stamp() + 95, [ & ](
+         const stamp * keys, const int32_t * payloads, std::size_t n
+      ){
+         ++calls;
+         for( std::size_t i = 0; i < n; ++i ){
+            sum += payloads[ i ];
+            CHECK_TRUE( keys[ i ] - stamp() == 10 * payloads[ i ] );
+         }
+      } );
+      CHECK_EQUAL( calls, 2 );
+      CHECK_EQUAL( sum, 6 + 7 + 8 + 9 );
+      s.append( stamp() + 260, 11 );
+   }
+
+   // re-open: the store has flushed on destruction, new records
+   // go to a new segment, and must not be before the last key
+   CHECK_EQUAL( storage.syncs(), 4 * 3 );
+   segment_store< int32_t, ns_tag, memory_segment_storage > s( storage, 8 );
+   CHECK_TRUE( s.valid() );
+   CHECK_EQUAL( s.segments(), 2 );
+   CHECK_EQUAL( s.size(), 12 );
+   bool a1 = s.append( stamp() + 200, 12 );
+   bool a2 = s.append( stamp() + 300, 12 );
+   CHECK_FALSE( a1 );
+   CHECK_TRUE( a2 );
+   CHECK_EQUAL( s.segments(), 3 );
+   CHECK_EQUAL( s.segment_at( 2 ).min(), stamp() + 300 );
+}
+
+void test_store_invalid(){
+   memory_segment_storage storage;
+   std::size_t bytes = 0;
+   storage.create( 0, layout::bytes( 4 ) );
+   segment_store< int32_t, ns_tag, memory_segment_storage > s( storage, 4 );
+   CHECK_FALSE( s.valid() );
+   bool a = s.append( stamp(), 1 );
+   CHECK_FALSE( a );
+   CHECK_TRUE( storage.open( 0, bytes ) != nullptr );
+   CHECK_EQUAL( bytes, layout::bytes( 4 ) );
+}
+
+#ifdef TORSOR_SEGMENT_POSIX
+void test_files(){
+   const std::string prefix =
+      "/tmp/torsor-test-segment-" + std::to_string( ::getpid() ) + "-";
+   posix_segment_files files( prefix );
+   files.remove();
+   {
+      segment_store< int32_t, ns_tag, posix_segment_files > s(
+         files, 100, segment_flush_policy{ 10, 0 } );
+      CHECK_TRUE( s.valid() );
+      for( int i = 0; i < 250; ++i ){
+         s.append( stamp() + i, i );
+      }
+      CHECK_EQUAL( s.pending(), 0 );
+   }
+   CHECK_EQUAL( files.count(), 3 );
+   {
+      segment_store< int32_t, ns_tag, posix_segment_files > s( files, 100 );
+      CHECK_TRUE( s.valid() );
+      CHECK_EQUAL( s.size(), 250 );
+      long long sum = 0;
+      s.scan( stamp() + 50, stamp() + 150, [ & ](
+         const stamp *, const int32_t * payloads, std::size_t n
+      ){
+         for( std::size_t i = 0; i < n; ++i ){
+            sum += payloads[ i ];
+         }
+      } );
+      CHECK_EQUAL( sum, ( 50 + 149 ) * 100 / 2 );
+   }
+   files.remove();
+   CHECK_EQUAL( files.count(), 0 );
+}
+#endif
+
+int main(){
+   test_write_read();
+   test_full();
+   test_invalid();
+   test_range();
+   test_store();
+   test_store_invalid();
+#ifdef TORSOR_SEGMENT_POSIX
+   test_files();
+#endif
+
+   return test_end();
+}
@@ -0,0 +1,173 @@
+// ==========================================================================
+//
+// test-simulation.cpp
+//
+// torsor-simulation tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "torsor-simulation.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+using namespace std::chrono_literals;
+using sim = simulator<>;
+using moment = sim::moment;
+
+struct tick_tag {};
+using tick_sim = simulator< std::int64_t, tick_tag >;
+using tick = tick_sim::moment;
+
+void test_order(){
+   sim s( moment() + 1h );
+   std::string log;
+   s.schedule( 30ms, [ & ]{ log += 'c'; } );
+   s.schedule( 10ms, [ & ]{ log += 'a'; } );
+   s.schedule( s.now() + 20ms, [ & ]{ log += 'b'; } );
+
+   // the same moment: in the order of scheduling
+   s.schedule( 20ms, [ & ]{ log += 'B'; } );
+
+   // an action schedules more events, also at now
+   s.schedule( 10ms, [ & ]{
+      log += 'A';
+      s.schedule( 0ms, [ & ]{ log += '0'; } );
+      s.schedule( 1ms, [ & ]{ log += '1'; } );
+   } );
+
+   // a moment in the past is taken as now
+   s.schedule( moment(), [ & ]{ log += 'p'; } );
+
+   CHECK_EQUAL( s.pending(), 6u );
+   CHECK_TRUE( s.next() == moment() + 1h );
+   const auto n = s.run();
+   CHECK_EQUAL( n, 8u );
+   CHECK_EQUAL( log, "paA01bBc" );
+   CHECK_TRUE( s.now() == moment() + 1h + 30ms );
+   CHECK_EQUAL( s.pending(), 0u );
+   CHECK_EQUAL( s.processed(), 8u );
+   const bool b = s.step();
+   CHECK_FALSE( b );
+}
+
+void test_run_until(){
+   tick_sim s;
+   std::vector< std::int64_t > at;
+   for( std::int64_t t : { 5, 10, 15, 20 } ){
+      s.schedule( tick() + t, [ & ]{ at.push_back( s.now() - tick() ); } );
+   }
+
+   // up to and including the moment, then now is the moment
+   const auto n1 = s.run_until( tick() + 10 );
+   CHECK_EQUAL( n1, 2u );
+   CHECK_TRUE( s.now() == tick() + 10 );
+   const auto n2 = s.run_for( 3 );
+   CHECK_EQUAL( n2, 0u );
+   CHECK_TRUE( s.now() == tick() + 13 );
+
+   // an event before the next one, after the now was advanced
+   s.schedule( 1, [ & ]{ at.push_back( s.now() - tick() ); } );
+   s.wait( tick() + 100 );
+   CHECK_TRUE( at == std::vector< std::int64_t >( { 5, 10, 14, 15, 20 } ) );
+   CHECK_TRUE( s.now() == tick() + 100 );
+
+   // stop
+   s.schedule( 1, [ & ]{ s.stop(); } );
+   s.schedule( 2, []{} );
+   const auto n3 = s.run_until( tick() + 1000 );
+   CHECK_EQUAL( n3, 1u );
+   CHECK_TRUE( s.now() == tick() + 101 );
+   CHECK_EQUAL( s.pending(), 1u );
+}
+
+void test_many(){
+   // many events (which resize the calendar), with random delays,
+   // each event schedules the next one: in order of the moments
+   tick_sim s;
+   std::uint64_t random = 12345;
+   bool in_order = true;
+   tick last;
+   int left = 100'000;
+   std::function< void() > hold = [ & ]{
+      in_order = in_order && ! ( s.now() < last );
+      last = s.now();
+      if( --left > 0 ){
+         random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+         s.schedule( std::int64_t( ( random >> 33 ) % 1'000 ), hold );
+      }
+   };
+   for( int i = 0; i < 5'000; ++i ){
+      random = random * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+      s.schedule( std::int64_t( ( random >> 33 ) % 1'000'000 ), hold );
+   }
+   CHECK_EQUAL( s.pending(), 5'000u );
+   const auto n = s.run();
+   CHECK_EQUAL( n, 100'000u + 4'999u );
+   CHECK_TRUE( in_order );
+
+   // far apart events (beyond a year of the calendar)
+   std::vector< std::int64_t > at;
+   for( std::int64_t t : { 1'000'000'000, 7, 3'000'000, 7'000 } ){
+      s.schedule( t, [ & ]{ at.push_back( s.now() - last ); } );
+   }
+   s.run();
+   CHECK_TRUE( at == std::vector< std::int64_t >(
+      { 7, 7'000, 3'000'000, 1'000'000'000 } ) );
+}
+
+// the timing code of the readme example, on a clock C
+template< typename C, typename F >
+typename C::duration time_to_run( F work ){
+   auto start = C::now();
+   work();
+   auto stop = C::now();
+   return stop - start;
+}
+
+void test_clock(){
+   using clock = simulation_clock<>;
+   sim s;
+   clock::use( s );
+
+   // a periodic event in the background
+   int ticks = 0;
+   std::function< void() > periodic = [ & ]{
+      ++ticks;
+      s.schedule( 1ms, periodic );
+   };
+   s.schedule( 1ms, periodic );
+
+   const auto d = time_to_run< clock >( []{
+      clock::wait( 5ms );
+      clock::wait( clock::now() + 1s );
+   } );
+   CHECK_TRUE( d == 1005ms );
+   CHECK_EQUAL( ticks, 1005 );
+   CHECK_TRUE( & clock::sim() == & s );
+}
+
+int main(){
+   test_order();
+   test_run_until();
+   test_many();
+   test_clock();
+
+   return test_end();
+}
@@ -0,0 +1,159 @@
+// ==========================================================================
+//
+// test-split.cpp
+//
+// torsor-split tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <vector>
+#include "torsor-split.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct ns_tag {};
+using ns = split< int64_t, float >;
+using moment = torsor< ns, ns_tag >;
+
+const int64_t since_1970 = 1'700'000'000'000'000'000;
+
+static_assert( ns::limit == 65536.0f );
+static_assert( split< int64_t, double >::limit == (double)( 1LL << 45 ) );
+
+// a split is the anchor plus the offset
+static_assert( ns( 5, 0.5f ) == ns( 4, 1.5f ) );
+static_assert( ns( 5, 0.5f ) < ns( 6, -0.25f ) );
+static_assert( ns( since_1970, 0.5f ) > ns( since_1970, 0.25f ) );
+static_assert( ns( 10, 0.5f ).rounded() == 11 );
+static_assert( ns( 10, -0.5f ).rounded() == 9 );
+static_assert( ns( 10, -0.4f ).rounded() == 10 );
+
+// an unsigned anchor: the difference of the anchors doesn't wrap
+using uns = split< uint64_t, float >;
+static_assert( uns( 5 ) < uns( 10 ) );
+static_assert( ! ( uns( 10 ) < uns( 5 ) ) );
+static_assert( uns( 10 ) > uns( 5 ) );
+static_assert( uns( 10, -0.5f ) < uns( 10 ) );
+static_assert( uns( 5, 10.0f ) > uns( 10 ) );
+static_assert( uns( 5, 5.0f ) == uns( 10 ) );
+static_assert( uns( 0 ) < uns( 0xFFFF'FFFF'FFFF'FFFF ) );
+static_assert( split< uint16_t, float >( 1 ) < split< uint16_t, float >( 2 ) );
+
+// offsets that are not small (the split is not normalized)
+static_assert( ns( 5, 100'000.0f ) > ns( 100'000 ) );
+static_assert( ns( since_1970, -2.0f ) < ns( since_1970 - 1 ) );
+
+void test_arithmetic(){
+   moment t = moment() + since_1970;
+   CHECK_EQUAL( ( t - moment() ).anchor(), since_1970 );
+
+   // a floating point value changes only the offset
+   t += 0.25f;
+   auto d = t - moment();
+   CHECK_EQUAL( d.anchor(), since_1970 );
+   CHECK_EQUAL( d.offset(), 0.25f );
+   CHECK_TRUE( t > moment() + since_1970 );
+   CHECK_TRUE( t < moment() + since_1970 + 0.5f );
+
+   // an integer only the anchor
+   d = ( t + 3 ) - moment();
+   CHECK_EQUAL( d.anchor(), since_1970 + 3 );
+   CHECK_EQUAL( d.offset(), 0.25f );
+
+   // a large floating point value both
+   d = ( t + 1e12 ) - t;
+   CHECK_EQUAL( d.anchor(), 1'000'000'000'000 );
+   CHECK_EQUAL( d.offset(), 0.0f );
+
+   // += renormalizes when the offset reaches the limit
+   t -= 0.75f;
+   CHECK_EQUAL( ( t - moment() ).offset(), -0.5f );
+   t += 70'000.5f;
+   d = t - moment();
+   CHECK_EQUAL( d.anchor(), since_1970 + 70'000 );
+   CHECK_EQUAL( d.offset(), 0.0f );
+
+   // an unsigned value is subtracted, not negated (which would wrap)
+   CHECK_EQUAL( ( ns( 100 ) - 5u ).anchor(), 95 );
+   CHECK_EQUAL( ( ns( 100 ) - std::uint64_t( 5 ) ).anchor(), 95 );
+   ns u( 100, 0.5f );
+   u -= 7u;
+   CHECK_EQUAL( u.anchor(), 93 );
+   CHECK_EQUAL( u.offset(), 0.5f );
+   d = ( t - 1e12 ) - t;
+   CHECK_EQUAL( d.anchor(), - 1'000'000'000'000 );
+   CHECK_EQUAL( d.offset(), 0.0f );
+
+   // a torsor of the anchor type converts
+   moment m = torsor< int64_t, ns_tag >() + 42;
+   CHECK_EQUAL( ( m - moment() ).anchor(), 42 );
+}
+
+void test_precision(){
+   // a million sub-nanosecond steps, far from the anchor
+   const moment start = moment() + since_1970;
+   moment t = start;
+   for( int i = 0; i < 1'000'000; ++i ){
+      t += 0.125f;
+   }
+   CHECK_EQUAL( ( t - start ).rounded(), 125'000 );
+   CHECK_EQUAL( (double) ( t - start ), 125'000.0 );
+
+   // which a double loses completely
+   torsor< double, ns_tag > dt = torsor< double, ns_tag >() + (double) since_1970;
+   const auto dstart = dt;
+   for( int i = 0; i < 1'000; ++i ){
+      dt += 0.125;
+   }
+   CHECK_EQUAL( dt - dstart, 0.0 );
+}
+
+void test_kernels(){
+   const torsor< int64_t, ns_tag > anchor = torsor< int64_t, ns_tag >() + since_1970;
+   std::vector< moment > in( 1000 ), back( 1000 );
+   for( int i = 0; i < 1000; ++i ){
+      in[ i ] = moment( anchor ) + i * 10.25f;
+   }
+
+   std::vector< float > offsets( 1000 ), deltas( 999 );
+   CHECK_TRUE( split_narrow( anchor, in.data(), offsets.data(), 1000 ) );
+   CHECK_EQUAL( offsets[ 0 ], 0.0f );
+   CHECK_EQUAL( offsets[ 999 ], 10'239.75f );
+
+   split_deltas( offsets.data(), deltas.data(), 1000 );
+   bool all = true;
+   for( float x : deltas ){
+      all = all && ( x == 10.25f );
+   }
+   CHECK_TRUE( all );
+
+   split_shift( offsets.data(), 1000, 0.5f );
+   split_widen( anchor, offsets.data(), back.data(), 1000 );
+   CHECK_TRUE( back[ 0 ] == in[ 0 ] + 0.5f );
+   CHECK_TRUE( back[ 999 ] == in[ 999 ] + 0.5f );
+
+   // too far from the anchor for the resolution
+   CHECK_FALSE( split_narrow( anchor - 100'000, in.data(), offsets.data(), 1000 ) );
+}
+
+int main(){
+   test_arithmetic();
+   test_precision();
+   test_kernels();
+
+   return test_end();
+}
@@ -0,0 +1,133 @@
+// ==========================================================================
+//
+// test-sync.cpp
+//
+// torsor-sync runtime tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include <vector>
+#include "torsor-sync.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct device_tag {};
+struct host_tag {};
+using device = torsor< int64_t, device_tag >;
+using host = torsor< int64_t, host_tag >;
+using sync = clock_sync< int64_t, device_tag, host_tag >;
+using mapping = sync::mapping;
+
+// the tags can't be mixed: only a mapping goes from one to the other
+template< typename F, typename X >
+constexpr bool can_call = requires( F f, X x ){ f( x ); };
+
+static_assert( can_call< mapping, device > );
+static_assert( ! can_call< mapping, host > );
+
+// the true relation: the host clock runs 50 ppm faster
+host truth( device t ){
+   const int64_t d = t - device();
+   return host() + ( 1'000'000'000 + d + d / 20'000 );
+}
+
+// deterministic jitter in [ -20, 20 ]
+int64_t jitter( uint32_t & seed ){
+   seed = seed * 1664525 + 1013904223;
+   return (int64_t) ( seed >> 16 ) % 41 - 20;
+}
+
+void test_mapping(){
+   const mapping m( device() + 100, host() + 1'000, 0.001 );
+   CHECK_EQUAL( m( device() + 100 ) - host(), 1'000 );
+   CHECK_EQUAL( m( device() + 1'100 ) - host(), 2'001 );
+   CHECK_EQUAL( m( device() - 900 ) - host(), -1 );
+
+   // convert() gives the same results as operator()
+   std::vector< device > in;
+   for( int64_t i = 0; i < 1000; ++i ){
+      in.push_back( device() + i * 7'777'777 - 3'000'000'000 );
+   }
+   std::vector< host > out( in.size() );
+   m.convert( in.data(), out.data(), in.size() );
+   bool same = true;
+   for( std::size_t i = 0; i < in.size(); ++i ){
+      same = same && ( out[ i ] == m( in[ i ] ) );
+   }
+   CHECK_TRUE( same );
+}
+
+void test_estimate(){
+   sync s;
+   uint32_t seed = 1;
+   const device start = device() + 1'700'000'000'000'000'000;
+
+   // a sample every ms for a second, with jitter,
+   // and each 100th sample delayed by 5 us
+   int accepted = 0;
+   for( int64_t i = 0; i < 1000; ++i ){
+      const device t = start + i * 1'000'000;
+      const int64_t delay = ( i % 100 == 50 ) ? 5'000 : 0;
+      if( s.add( t, truth( t ) + ( jitter( seed ) + delay ) ) ){
+         ++accepted;
+      }
+   }
+   CHECK_EQUAL( accepted, 990 );
+   CHECK_EQUAL( s.rejected(), 10 );
+   CHECK_TRUE( s.drift() > 49e-6 );
+   CHECK_TRUE( s.drift() < 51e-6 );
+
+   // the mapping is accurate within the jitter, also beyond the samples
+   const mapping m = s.get();
+   int64_t worst = 0;
+   for( int64_t i = -500; i < 1500; i += 7 ){
+      const device t = start + i * 1'000'000;
+      const int64_t e = m( t ) - truth( t );
+      worst = ( e < 0 ? -e : e ) > worst ? ( e < 0 ? -e : e ) : worst;
+   }
+   CHECK_TRUE( worst < 20 );
+}
+
+void test_step(){
+   sync s;
+   uint32_t seed = 2;
+   const device start = device() + 1'000'000'000;
+   int64_t i = 0;
+   for( ; i < 100; ++i ){
+      const device t = start + i * 1'000'000;
+      s.add( t, truth( t ) + jitter( seed ) );
+   }
+
+   // the host clock steps 1 ms: after 16 rejects the estimator restarts
+   for( ; i < 200; ++i ){
+      const device t = start + i * 1'000'000;
+      s.add( t, truth( t ) + ( 1'000'000 + jitter( seed ) ) );
+   }
+   CHECK_EQUAL( s.rejected(), 16 );
+   CHECK_EQUAL( s.samples(), 84 );
+   const device t = start + i * 1'000'000;
+   const int64_t e = s.get()( t ) - ( truth( t ) + 1'000'000 );
+   CHECK_TRUE( ( e > -50 ) && ( e < 50 ) );
+}
+
+int main(){
+   test_mapping();
+   test_estimate();
+   test_step();
+
+   return test_end();
+}
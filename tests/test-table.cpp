@@ -0,0 +1,84 @@
+// ==========================================================================
+//
+// test-table.cpp
+//
+// torsor-table tests: the static_asserts are the compile-time tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include "torsor-table.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct ms_tag {};
+using ms = torsor< int32_t, ms_tag >;
+
+// all torsor operations are constexpr
+constexpr ms assigned(){
+   ms a;
+   torsor< int16_t, ms_tag > b;
+   b += 7;
+   a = b;
+   a += 10;
+   a -= 3;
+   return a;
+}
+static_assert( assigned() - ms() == 14 );
+static_assert( + assigned() == assigned() );
+static_assert( 1 + assigned() > assigned() );
+
+static constexpr auto ticks = torsor_progression< 5 >( ms() + 100, 20 );
+static_assert( ticks[ 0 ] - ms() == 100 );
+static_assert( ticks[ 4 ] - ms() == 180 );
+
+static constexpr auto schedule = torsor_schedule( 
+   ms() + 1'000, std::array< int32_t, 3 >{ 10, 250, 40 } );
+static_assert( schedule.size() == 4 );
+static_assert( schedule[ 0 ] - ms() == 1'000 );
+static_assert( schedule[ 2 ] - ms() == 1'260 );
+static_assert( schedule[ 3 ] - schedule[ 0 ] == 300 );
+
+static constexpr auto points = torsor_offsets( 
+   ms() + 50, std::array< int32_t, 3 >{ -50, 0, 50 } );
+static_assert( points[ 0 ] == ms() );
+static_assert( points[ 2 ] - points[ 0 ] == 100 );
+
+static_assert( torsor_lookup( schedule, ms() + 999 ) == schedule.size() );
+static_assert( torsor_lookup( schedule, ms() + 1'000 ) == 0 );
+static_assert( torsor_lookup( schedule, ms() + 1'259 ) == 1 );
+static_assert( torsor_lookup( schedule, ms() + 1'260 ) == 2 );
+static_assert( torsor_lookup( schedule, ms() + 5'000 ) == 3 );
+
+// narrowed like +=
+static constexpr auto wrap = torsor_progression< 3 >( 
+   torsor< uint8_t >( torsor< uint8_t >() + 250 ), 5 );
+static_assert( wrap[ 2 ] - torsor< uint8_t >() == 4 );
+
+void test_runtime_lookup(){
+   // the same functions at run time
+   for( int i = 0; i < 5; ++i ){
+      CHECK_EQUAL( 
+         torsor_lookup( ticks, ms() + ( 100 + 20 * i ) ), (std::size_t) i );
+   }
+   CHECK_EQUAL( torsor_lookup( ticks, ms() + 99 ), ticks.size() );
+}
+
+int main(){
+   test_runtime_lookup();
+
+   return test_end();
+}
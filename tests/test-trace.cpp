@@ -0,0 +1,134 @@
+// ==========================================================================
+//
+// test-trace.cpp
+//
+// torsor-trace runtime tests
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <sstream>
+#include <thread>
+#include "torsor-trace.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests 
+//
+// ==========================================================================
+
+using trace = tracer< steady_clock_source, 16 >;
+using event = trace::event;
+
+void test_record(){
+   const auto work = trace::id( "work" );
+   const auto tick = trace::id( "tick" );
+   CHECK_EQUAL( trace::id( "work" ), work );
+   CHECK_EQUAL( trace::name( tick ), "tick" );
+   {
+      trace::scope s( work );
+      trace::instant( tick );
+   }
+   std::vector< event > events;
+   trace::collect( events );
+
+   CHECK_EQUAL( events.size(), 3 );
+   CHECK_TRUE( events[ 0 ].kind == event::kinds::begin );
+   CHECK_TRUE( events[ 1 ].kind == event::kinds::instant );
+   CHECK_TRUE( events[ 2 ].kind == event::kinds::end );
+   CHECK_EQUAL( events[ 1 ].name, tick );
+   CHECK_TRUE( events[ 0 ].moment <= events[ 2 ].moment );
+
+   // collected events are gone
+   events.clear();
+   trace::collect( events );
+   CHECK_EQUAL( events.size(), 0 );
+}
+
+void test_dropped(){
+   const auto d0 = trace::dropped();
+   const auto tick = trace::id( "tick" );
+   for( int i = 0; i < 20; ++i ){
+      trace::instant( tick );
+   }
+   std::vector< event > events;
+   trace::collect( events );
+   CHECK_EQUAL( events.size(), 16 );
+   CHECK_EQUAL( trace::dropped() - d0, 4 );
+}
+
+void test_threads(){
+   const auto tick = trace::id( "tick" );
+   std::thread a( [ & ]{ for( int i = 0; i < 8; ++i ) trace::instant( tick ); } );
+   std::thread b( [ & ]{ for( int i = 0; i < 8; ++i ) trace::instant( tick ); } );
+   a.join();
+   b.join();
+   trace::instant( tick );
+
+   std::vector< event > events;
+   trace::collect( events );
+   CHECK_EQUAL( events.size(), 17 );
+   bool ordered = true;
+   for( std::size_t i = 1; i < events.size(); ++i ){
+      ordered = ordered && ( events[ i - 1 ].moment <= events[ i ].moment );
+   }
+   CHECK_TRUE( ordered );
+   CHECK_NOT_EQUAL( events[ 0 ].thread, events[ 16 ].thread );
+}
+
+void test_reuse(){
+   // the buffer of a thread that has ended (and of which all events
+   // have been collected) is reused by a new thread
+   const auto tick = trace::id( "tick" );
+   std::vector< event > events;
+   for( int i = 0; i < 100; ++i ){
+      std::thread t( [ & ]{ trace::instant( tick ); } );
+      t.join();
+      trace::collect( events );
+   }
+   CHECK_EQUAL( events.size(), 100 );
+   bool reused = true;
+   for( auto & e : events ){
+      reused = reused && ( e.thread == events[ 0 ].thread );
+   }
+   CHECK_TRUE( reused );
+}
+
+void test_json(){
+   using moment = steady_clock_source::moment;
+   using namespace std::chrono_literals;
+   const moment t = steady_clock_source::now();
+   std::vector< event > events = {
+      { t,            trace::id( "a\"b" ), 1, event::kinds::begin },
+      { t + 1500ns,   trace::id( "a\"b" ), 1, event::kinds::end },
+      { t + 2us,      trace::id( "x" ),    2, event::kinds::instant },
+      { t + 3us,      trace::id( "c\n\t\x01" ), 2, event::kinds::instant },
+   };
+   std::stringstream s;
+   trace::write_json( s, events );
+   CHECK_EQUAL( s.str(), 
+      "{\"traceEvents\":[\n"
+      "{\"name\":\"a\\\"b\",\"ph\":\"B\",\"ts\":0.000,\"pid\":1,\"tid\":1},\n"
+      "{\"name\":\"a\\\"b\",\"ph\":\"E\",\"ts\":1.500,\"pid\":1,\"tid\":1},\n"
+      "{\"name\":\"x\",\"ph\":\"i\",\"ts\":2.000,\"pid\":1,\"tid\":2,\"s\":\"t\"},\n"
+      "{\"name\":\"c\\n\\t\\u0001\",\"ph\":\"i\",\"ts\":3.000,\"pid\":1,\"tid\":2,\"s\":\"t\"}\n"
+      "]}\n" );
+}
+
+int main(){
+   test_record();
+   test_dropped();
+   test_threads();
+   test_reuse();
+   test_json();
+
+   return test_end();
+}
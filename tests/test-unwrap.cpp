@@ -0,0 +1,133 @@
+// ==========================================================================
+//
+// test-unwrap.cpp
+//
+// torsor-unwrap tests
+//
+// https://www.github.com/wovo/torsor
+//
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "torsor-unwrap.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests
+//
+// ==========================================================================
+
+struct tick_tag {};
+using moment = torsor< std::int64_t, tick_tag >;
+
+uint64_t seed = 42;
+uint64_t next(){
+   seed = seed * 6'364'136'223'846'793'005 + 1'442'695'040'888'963'407;
+   return seed >> 16;
+}
+
+void test_update(){
+   counter_unwrapper< std::uint16_t, tick_tag > u;
+   CHECK_EQUAL( u.update( 100 ) - moment(), 100 );
+   CHECK_EQUAL( u.update( 65'000 ) - moment(), 65'000 );
+   CHECK_EQUAL( u.update( 5 ) - moment(), 65'536 + 5 );
+   CHECK_EQUAL( u.update( 5 ) - moment(), 65'536 + 5 );
+   CHECK_EQUAL( u.update( 4 ) - moment(), 2 * 65'536 + 4 );
+   CHECK_EQUAL( u.last() - moment(), 2 * 65'536 + 4 );
+
+   // a 24-bit counter in an uint32_t, from a start
+   counter_unwrapper< std::uint32_t, tick_tag, 24 > v( moment() + 1'000 );
+   CHECK_EQUAL( v.update( 999 ) - moment(), ( 1 << 24 ) + 999 );
+   CHECK_EQUAL( v.update( 0 ) - moment(), ( 2 << 24 ) );
+   static_assert( counter_unwrapper< std::uint32_t, tick_tag, 24 >::period
+      == ( 1 << 24 ) );
+}
+
+template< typename C, int N >
+bool batch_is_scalar( std::size_t n, std::uint64_t max_step ){
+
+   // readings of a counter with random steps (so with wraps)
+   std::vector< C > in( n );
+   std::int64_t t = 123;
+   for( auto & x : in ){
+      t += next() % ( max_step + 1 );
+      x = static_cast< C >( t & ( ( std::int64_t( 1 ) << N ) - 1 ) );
+   }
+
+   counter_unwrapper< C, tick_tag, N > a, b;
+   std::vector< moment > batch( n );
+   a.update( in.data(), batch.data(), n / 3 );
+   a.update( in.data() + n / 3, batch.data() + n / 3, n - n / 3 );
+   bool same = ( a.last() - moment() ) == t;
+   for( std::size_t i = 0; i < n; ++i ){
+      same = same && ( batch[ i ] == b.update( in[ i ] ) );
+   }
+   return same;
+}
+
+void test_batch(){
+   CHECK_TRUE( ( batch_is_scalar< std::uint16_t, 16 >( 100'000, 100 ) ) );
+   CHECK_TRUE( ( batch_is_scalar< std::uint16_t, 16 >( 100'000, 60'000 ) ) );
+   CHECK_TRUE( ( batch_is_scalar< std::uint32_t, 32 >( 100'000, 100'000 ) ) );
+   CHECK_TRUE( ( batch_is_scalar< std::uint32_t, 32 >( 100'000, 4'000'000'000 ) ) );
+   CHECK_TRUE( ( batch_is_scalar< std::uint32_t, 24 >( 100'000, 1'000'000 ) ) );
+   CHECK_TRUE( ( batch_is_scalar< std::uint8_t, 8 >( 1'000, 200 ) ) );
+   CHECK_TRUE( ( batch_is_scalar< std::uint32_t, 32 >( 7, 10 ) ) );
+}
+
+void test_atomic(){
+   atomic_counter_unwrapper< std::uint16_t, tick_tag > u;
+   CHECK_EQUAL( u.update( 30'000 ) - moment(), 30'000 );
+   CHECK_EQUAL( u.update( 60'000 ) - moment(), 60'000 );
+   CHECK_EQUAL( u.update( 100 ) - moment(), 65'536 + 100 );
+
+   // an older reading: before the last one, which stays
+   CHECK_EQUAL( u.update( 65'000 ) - moment(), 65'000 );
+   CHECK_EQUAL( u.last() - moment(), 65'536 + 100 );
+}
+
+void test_threads(){
+   // a wide counter, of which the threads read the low 32 bits,
+   // which wrap during the test (a thread can be suspended between
+   // its reading and its update, but not for half a period)
+   const std::int64_t start = ( std::int64_t( 1 ) << 32 ) - 1'000'000;
+   std::atomic< std::int64_t > counter( start );
+   atomic_counter_unwrapper< std::uint32_t, tick_tag > u( moment() + start );
+   std::atomic< bool > ok( true );
+   std::vector< std::thread > threads;
+   for( int n = 0; n < 4; ++n ){
+      threads.emplace_back( [ & ]{
+         for( int i = 0; i < 100'000; ++i ){
+            const std::int64_t c = counter.fetch_add( 7 ) + 7;
+            const moment t = u.update( static_cast< std::uint32_t >( c ) );
+            if( t - moment() != c ){
+               ok = false;
+            }
+         }
+      } );
+   }
+   for( auto & t : threads ){
+      t.join();
+   }
+   CHECK_TRUE( ok );
+   CHECK_EQUAL( u.last() - moment(), counter.load() );
+}
+
+int main(){
+   test_update();
+   test_batch();
+   test_atomic();
+   test_threads();
+
+   return test_end();
+}
@@ -0,0 +1,151 @@
+// ==========================================================================
+//
+// test-window.cpp
+//
+// torsor-window runtime tests
+//
+// https://www.github.com/wovo/torsor
+// 
+// Copyright Wouter van Ooijen - 2019
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+// https://www.boost.org/LICENSE_1_0.txt)
+//
+// ==========================================================================
+
+#include <cstdint>
+#include "torsor-window.hpp"
+#include "test-runtime.hpp"
+
+
+// ==========================================================================
+//
+// the tests 
+//
+// ==========================================================================
+
+struct ms_tag {};
+using moment = torsor< int64_t, ms_tag >;
+
+void test_exact(){
+   sliding_window< int, 8, int64_t, ms_tag > w( 100 );
+   const moment t0 = moment() + 1000;
+
+   w.add( t0,       5 );
+   w.add( t0 + 10,  3 );
+   w.add( t0 + 20,  9 );
+   w.add( t0 + 50,  4 );
+   CHECK_EQUAL( w.count(), 4 );
+   CHECK_EQUAL( w.sum(), 21 );
+   CHECK_EQUAL( w.min(), 3 );
+   CHECK_EQUAL( w.max(), 9 );
+
+   // t0 drops out: the window is ( t - 100, t ]
+   w.advance( t0 + 100 );
+   CHECK_EQUAL( w.count(), 3 );
+   CHECK_EQUAL( w.sum(), 16 );
+   CHECK_EQUAL( w.min(), 3 );
+
+   // t0 + 10 drops out
+   w.add( t0 + 115, 6 );
+   CHECK_EQUAL( w.count(), 3 );
+   CHECK_EQUAL( w.min(), 4 );
+   CHECK_EQUAL( w.max(), 9 );
+
+   // t0 + 20 drops out
+   w.advance( t0 + 125 );
+   CHECK_EQUAL( w.max(), 6 );
+
+   // all drop out
+   w.advance( t0 + 1000 );
+   CHECK_EQUAL( w.count(), 0 );
+   CHECK_EQUAL( w.sum(), 0 );
+}
+
+void test_exact_full(){
+   sliding_window< int, 2, int64_t, ms_tag > w( 100 );
+   bool a1 = w.add( moment() + 1, 1 );
+   bool a2 = w.add( moment() + 2, 2 );
+   bool a3 = w.add( moment() + 3, 3 );
+   CHECK_TRUE(  a1 && a2 );
+   CHECK_FALSE( a3 );
+   bool a4 = w.add( moment() + 101, 4 );
+   CHECK_TRUE(  a4 );
+   CHECK_EQUAL( w.count(), 2 );
+   CHECK_EQUAL( w.min(), 2 );
+}
+
+void test_exact_long(){
+   // compare with brute force over a long run
+   sliding_window< int, 64, int64_t, ms_tag > w( 50 );
+   int values[ 1000 ];
+   bool ok = true;
+   for( int i = 0; i < 1000; ++i ){
+      values[ i ] = ( i * 7919 ) % 101;
+      w.add( moment() + 3 * i, values[ i ] );
+      int count = 0, sum = 0, min = 1000, max = -1;
+      for( int j = 0; j <= i; ++j ){
+         if( 3 * j > 3 * i - 50 ){
+            ++count;
+            sum += values[ j ];
+            min = values[ j ] < min ? values[ j ] : min;
+            max = values[ j ] > max ? values[ j ] : max;
+         }
+      }
+      ok = ok && ( (int) w.count() == count ) && ( w.sum() == sum )
+         && ( w.min() == min ) && ( w.max() == max );
+   }
+   CHECK_TRUE( ok );
+}
+
+void test_bucketed(){
+   bucketed_window< int, 4, int64_t, ms_tag > w( 100 );
+
+   w.add( moment() + 10, 5 );
+   w.add( moment() + 30, 7 );
+   w.add( moment() + 60, 2 );
+   CHECK_EQUAL( w.count(), 3 );
+   CHECK_EQUAL( w.sum(), 14 );
+   CHECK_EQUAL( w.min(), 2 );
+   CHECK_EQUAL( w.max(), 7 );
+
+   // bucket [ 0, 25 ) drops out
+   w.advance( moment() + 100 );
+   CHECK_EQUAL( w.count(), 2 );
+   CHECK_EQUAL( w.sum(), 9 );
+   CHECK_EQUAL( w.max(), 7 );
+
+   // bucket [ 25, 50 ) drops out
+   w.add( moment() + 125, 1 );
+   CHECK_EQUAL( w.count(), 2 );
+   CHECK_EQUAL( w.min(), 1 );
+   CHECK_EQUAL( w.max(), 2 );
+
+   // everything drops out
+   w.advance( moment() + 10'000 );
+   CHECK_EQUAL( w.count(), 0 );
+   CHECK_EQUAL( w.sum(), 0 );
+}
+
+void test_bucketed_narrow(){
+   // a width below the number of buckets: buckets of width 1,
+   // so the window is [ 5, 15 ) after the last add
+   bucketed_window< int, 10, int64_t, ms_tag > w( 5 );
+   w.add( moment() + 0, 1 );
+   w.add( moment() + 3, 2 );
+   w.add( moment() + 9, 3 );
+   CHECK_EQUAL( w.count(), 3 );
+   w.add( moment() + 14, 4 );
+   CHECK_EQUAL( w.count(), 2 );
+   CHECK_EQUAL( w.sum(), 7 );
+}
+
+int main(){
+   test_exact();
+   test_exact_full();
+   test_exact_long();
+   test_bucketed();
+   test_bucketed_narrow();
+
+   return test_end();
+}